@@ -36,12 +36,25 @@ QT += multimedia
 HEADERS += \
     $$PWD/src/Core/NetConsole.h \
     $$PWD/src/Core/Protocol.h \
+    $$PWD/src/Core/ProtocolBase.h \
+    $$PWD/src/Core/Scheduler.h \
     $$PWD/src/Core/Sockets.h \
     $$PWD/src/Core/Watchdog.h \
+    $$PWD/src/Core/WatchdogManager.h \
     $$PWD/src/Protocols/FRC_2014.h \
     $$PWD/src/Protocols/FRC_2015.h \
     $$PWD/src/Protocols/FRC_2016.h \
     $$PWD/src/Utilities/CRC32.h \
+    $$PWD/src/Utilities/LinkStatistics.h \
+    $$PWD/src/Utilities/LogCompactor.h \
+    $$PWD/src/Utilities/LogReader.h \
+    $$PWD/src/Utilities/LogWriter.h \
+    $$PWD/src/Utilities/MPSCQueue.h \
+    $$PWD/src/Utilities/PacketWriter.h \
+    $$PWD/src/Utilities/SeqLock.h \
+    $$PWD/src/Utilities/TimeSeries.h \
+    $$PWD/src/Utilities/TripleBuffer.h \
+    $$PWD/src/Utilities/VoltageCodec.h \
     $$PWD/src/DriverStation.h \
     $$PWD/src/Core/DS_Base.h \
     $$PWD/src/Core/DS_Config.h \
@@ -51,12 +64,21 @@ HEADERS += \
 
 SOURCES += \
     $$PWD/src/Core/NetConsole.cpp \
+    $$PWD/src/Core/Scheduler.cpp \
     $$PWD/src/Core/Sockets.cpp \
     $$PWD/src/Core/Watchdog.cpp \
+    $$PWD/src/Core/WatchdogManager.cpp \
     $$PWD/src/Protocols/FRC_2014.cpp \
     $$PWD/src/Protocols/FRC_2015.cpp \
     $$PWD/src/Protocols/FRC_2016.cpp \
     $$PWD/src/Utilities/CRC32.cpp \
+    $$PWD/src/Utilities/LinkStatistics.cpp \
+    $$PWD/src/Utilities/LogCompactor.cpp \
+    $$PWD/src/Utilities/LogReader.cpp \
+    $$PWD/src/Utilities/LogWriter.cpp \
+    $$PWD/src/Utilities/PacketWriter.cpp \
+    $$PWD/src/Utilities/TimeSeries.cpp \
+    $$PWD/src/Utilities/VoltageCodec.cpp \
     $$PWD/src/DriverStation.cpp \
     $$PWD/src/Core/DS_Config.cpp \
     $$PWD/src/Core/Logger.cpp \
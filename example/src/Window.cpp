@@ -71,6 +71,12 @@ Window::Window (QWidget* parent) : QMainWindow (parent) {
     connect (m_ui->TeamStation, SIGNAL (currentIndexChanged (int)),
              m_driverStation,     SLOT (setTeamStation      (int)));
 
+    /* Keep the control loop away from the UI thread */
+    m_driverStation->setNetworkThreadEnabled (true);
+
+    /* Skip the route lookup of every packet once the robot is found */
+    m_driverStation->setConnectedSocketsEnabled (true);
+
     /* Initialize protocol & DS */
     m_driverStation->init();
     m_driverStation->setProtocolType (m_ui->Protocols->currentIndex());
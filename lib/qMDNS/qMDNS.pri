@@ -4,7 +4,9 @@ QT += network
 INCLUDEPATH += $$PWD/src
 
 HEADERS += \
-    $$PWD/src/qMDNS.h
+    $$PWD/src/qMDNS.h \
+    $$PWD/src/DNSMessage.h
 
 SOURCES += \
-    $$PWD/src/qMDNS.cpp
+    $$PWD/src/qMDNS.cpp \
+    $$PWD/src/DNSMessage.cpp
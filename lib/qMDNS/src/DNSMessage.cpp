@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of qMDNS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "DNSMessage.h"
+
+#include <string.h>
+
+/*
+ * Label definitions
+ */
+const quint8 kPointerMask = 0xc0;
+const int MAX_LABEL_LENGTH = 63;
+
+/**
+ * Returns the lower-case form of the given ASCII \a character
+ */
+static inline uchar TO_LOWER (uchar character) {
+    if (character >= 'A' && character <= 'Z')
+        return character + ('a' - 'A');
+
+    return character;
+}
+
+/**
+ * Walks the given DNS message \a data (of the given \a size) and registers
+ * the offsets of its questions and resource records
+ */
+DNSView::DNSView (const char* data, int size) {
+    m_count = 0;
+    m_valid = false;
+    m_size = data ? qMax (size, 0) : 0;
+    m_data = reinterpret_cast<const uchar*> (data);
+
+    if (m_size < HEADER_SIZE)
+        return;
+
+    int offset = HEADER_SIZE;
+    for (int section = kQuestion; section <= kAdditional; ++section) {
+        int records = read16 (4 + section * 2);
+
+        for (int i = 0; i < records; ++i) {
+            /* Only the first entries are kept, the rest is ignored */
+            if (m_count >= MAX_ENTRIES) {
+                m_valid = true;
+                return;
+            }
+
+            Entry& entry = m_entries [m_count];
+            entry.section = section;
+            entry.name = offset;
+            entry.ttl = 0;
+            entry.data = 0;
+            entry.length = 0;
+
+            offset = skipName (offset);
+            if (offset < 0 || offset + 4 > m_size)
+                return;
+
+            entry.type = read16 (offset);
+            entry.klass = read16 (offset + 2);
+            offset += 4;
+
+            /* Resource records have a TTL and data */
+            if (section != kQuestion) {
+                if (offset + 6 > m_size)
+                    return;
+
+                entry.ttl = read32 (offset);
+                entry.length = read16 (offset + 4);
+                entry.data = offset + 6;
+                offset = entry.data + entry.length;
+
+                if (offset > m_size)
+                    return;
+            }
+
+            ++m_count;
+        }
+    }
+
+    m_valid = true;
+}
+
+/**
+ * Returns \c true if the header and every registered entry of the message
+ * are within the bounds of the message data
+ */
+bool DNSView::isValid() const {
+    return m_valid;
+}
+
+/**
+ * Returns \c true if the message is a query
+ */
+bool DNSView::isQuery() const {
+    return isValid() && (flags() & 0x8000) == 0;
+}
+
+/**
+ * Returns \c true if the message is a response
+ */
+bool DNSView::isResponse() const {
+    return isValid() && (flags() & 0x8000) != 0;
+}
+
+/**
+ * Returns the ID of the message
+ */
+quint16 DNSView::id() const {
+    return read16 (0);
+}
+
+/**
+ * Returns the flags of the message
+ */
+quint16 DNSView::flags() const {
+    return read16 (2);
+}
+
+/**
+ * Returns the number of questions and records registered by the view
+ */
+int DNSView::count() const {
+    return m_count;
+}
+
+/**
+ * Returns the question or record with the given \a index
+ */
+const DNSView::Entry& DNSView::entry (int index) const {
+    Q_ASSERT (index >= 0 && index < m_count);
+    return m_entries [index];
+}
+
+/**
+ * Returns a pointer to the message data at the given \a offset, or \c NULL
+ * if the offset is out of bounds
+ */
+const uchar* DNSView::data (int offset) const {
+    if (offset < 0 || offset >= m_size)
+        return Q_NULLPTR;
+
+    return m_data + offset;
+}
+
+/**
+ * Returns the big-endian 16-bit number at the given \a offset (or 0 if the
+ * number is out of bounds)
+ */
+quint16 DNSView::read16 (int offset) const {
+    if (offset < 0 || offset + 2 > m_size)
+        return 0;
+
+    return (quint16) ((m_data [offset] << 8) | m_data [offset + 1]);
+}
+
+/**
+ * Returns the big-endian 32-bit number at the given \a offset (or 0 if the
+ * number is out of bounds)
+ */
+quint32 DNSView::read32 (int offset) const {
+    if (offset < 0 || offset + 4 > m_size)
+        return 0;
+
+    return ((quint32) m_data [offset + 0] << 24) |
+           ((quint32) m_data [offset + 1] << 16) |
+           ((quint32) m_data [offset + 2] <<  8) |
+           ((quint32) m_data [offset + 3]);
+}
+
+/**
+ * Returns \c true if the (compressed) name at the given \a offset is equal
+ * to the given dotted \a name (e.g. "host.local") of the given \a length.
+ * The comparison is case-insensitive, as required by the DNS.
+ */
+bool DNSView::nameEquals (int offset, const char* name, int length) const {
+    if (!name || length < 0)
+        return false;
+
+    /* Ignore the trailing dot of fully qualified names */
+    if (length > 0 && name [length - 1] == '.')
+        --length;
+
+    int position = 0;
+    int limit = offset;
+    const uchar* string = reinterpret_cast<const uchar*> (name);
+
+    int label;
+    while ((label = nextLabel (&offset, &limit)) > 0) {
+        if (position > 0) {
+            if (position >= length || string [position] != '.')
+                return false;
+
+            ++position;
+        }
+
+        if (position + label > length)
+            return false;
+
+        for (int i = 0; i < label; ++i) {
+            if (TO_LOWER (m_data [offset + 1 + i])
+                    != TO_LOWER (string [position + i]))
+                return false;
+        }
+
+        position += label;
+        offset += label + 1;
+    }
+
+    return label == 0 && position == length;
+}
+
+/**
+ * Returns \c true if the (compressed) names at the \a first and \a second
+ * offsets are equal (ignoring case)
+ */
+bool DNSView::namesEqual (int first, int second) const {
+    int firstLimit = first;
+    int secondLimit = second;
+
+    while (true) {
+        int a = nextLabel (&first, &firstLimit);
+        int b = nextLabel (&second, &secondLimit);
+
+        if (a < 0 || b < 0 || a != b)
+            return false;
+
+        if (a == 0)
+            return true;
+
+        for (int i = 1; i <= a; ++i) {
+            if (TO_LOWER (m_data [first + i])
+                    != TO_LOWER (m_data [second + i]))
+                return false;
+        }
+
+        first += a + 1;
+        second += b + 1;
+    }
+}
+
+/**
+ * Decompresses the name at the given \a offset into the given \a buffer as
+ * a dotted name (without the trailing dot). Returns the length of the name,
+ * or -1 if the name is invalid or does not fit in the buffer.
+ */
+int DNSView::readName (int offset, char* buffer, int capacity) const {
+    if (!buffer || capacity <= 0)
+        return -1;
+
+    int length = 0;
+    int limit = offset;
+
+    int label;
+    while ((label = nextLabel (&offset, &limit)) > 0) {
+        if (length > 0) {
+            if (length >= capacity)
+                return -1;
+
+            buffer [length++] = '.';
+        }
+
+        if (length + label > qMin (capacity, MAX_NAME_LENGTH))
+            return -1;
+
+        memcpy (buffer + length, m_data + offset + 1, label);
+        length += label;
+        offset += label + 1;
+    }
+
+    return (label == 0) ? length : -1;
+}
+
+/**
+ * Returns the offset that follows the name that begins at the given
+ * \a offset (without following compression pointers), or -1 if the name
+ * goes beyond the message data
+ */
+int DNSView::skipName (int offset) const {
+    while (offset >= 0 && offset < m_size) {
+        quint8 length = m_data [offset];
+
+        if (length == 0)
+            return offset + 1;
+
+        if ((length & kPointerMask) == kPointerMask)
+            return (offset + 2 <= m_size) ? offset + 2 : -1;
+
+        if (length & kPointerMask)
+            return -1;
+
+        offset += length + 1;
+    }
+
+    return -1;
+}
+
+/**
+ * Moves the given \a offset to the next label of a name (following any
+ * compression pointer) and returns the length of the label, 0 at the end of
+ * the name or -1 if the name is invalid.
+ *
+ * Each pointer must point before the previous one (tracked with \a limit),
+ * so that hostile messages cannot make us loop forever.
+ */
+int DNSView::nextLabel (int* offset, int* limit) const {
+    while (*offset >= 0 && *offset < m_size) {
+        quint8 length = m_data [*offset];
+
+        /* Follow compression pointers */
+        if ((length & kPointerMask) == kPointerMask) {
+            if (*offset + 2 > m_size)
+                return -1;
+
+            int target = ((length & ~kPointerMask) << 8)
+                         | m_data [*offset + 1];
+            if (target >= *limit)
+                return -1;
+
+            *limit = target;
+            *offset = target;
+            continue;
+        }
+
+        /* Reserved label types */
+        if (length & kPointerMask)
+            return -1;
+
+        if (*offset + 1 + length > m_size)
+            return -1;
+
+        return length;
+    }
+
+    return -1;
+}
+
+/**
+ * Prepares the builder to write a message into the given \a buffer, which
+ * can hold up to \a capacity bytes
+ */
+DNSBuilder::DNSBuilder (char* buffer, int capacity) {
+    m_size = 0;
+    m_capacity = buffer ? qMax (capacity, 0) : 0;
+    m_buffer = reinterpret_cast<uchar*> (buffer);
+    m_valid = (m_buffer != Q_NULLPTR);
+}
+
+/**
+ * Returns \c true if every write fit in the buffer
+ */
+bool DNSBuilder::isValid() const {
+    return m_valid;
+}
+
+/**
+ * Returns the number of bytes written so far
+ */
+int DNSBuilder::size() const {
+    return m_size;
+}
+
+/**
+ * Writes the message header with the given \a id, \a flags and record
+ * counts of each section
+ */
+void DNSBuilder::header (quint16 id, quint16 flags,
+                         quint16 questions, quint16 answers,
+                         quint16 authorities, quint16 additionals) {
+    write16 (id);
+    write16 (flags);
+    write16 (questions);
+    write16 (answers);
+    write16 (authorities);
+    write16 (additionals);
+}
+
+/**
+ * Writes the given dotted \a name (e.g. "host.local") of the given
+ * \a length as a sequence of labels
+ */
+void DNSBuilder::name (const char* name, int length) {
+    if (!name || length < 0 || length > DNSView::MAX_NAME_LENGTH) {
+        m_valid = false;
+        return;
+    }
+
+    /* Ignore the trailing dot of fully qualified names */
+    if (length > 0 && name [length - 1] == '.')
+        --length;
+
+    int start = 0;
+    while (start < length) {
+        const char* dot = static_cast<const char*> (
+                              memchr (name + start, '.', length - start));
+        int end = dot ? (int) (dot - name) : length;
+        int label = end - start;
+
+        if (label <= 0 || label > MAX_LABEL_LENGTH) {
+            m_valid = false;
+            return;
+        }
+
+        write8 (label);
+        write (name + start, label);
+        start = end + 1;
+    }
+
+    write8 (0);
+}
+
+/**
+ * Writes a compression pointer to the name at the given \a offset
+ */
+void DNSBuilder::pointer (int offset) {
+    if (offset < 0 || offset >= m_size || offset > 0x3fff) {
+        m_valid = false;
+        return;
+    }
+
+    write16 (0xc000 | offset);
+}
+
+/**
+ * Writes the given 8-bit \a value
+ */
+void DNSBuilder::write8 (quint8 value) {
+    if (reserve (1))
+        m_buffer [m_size++] = value;
+}
+
+/**
+ * Writes the given 16-bit \a value (in big-endian order)
+ */
+void DNSBuilder::write16 (quint16 value) {
+    if (reserve (2)) {
+        m_buffer [m_size++] = (value >> 8) & 0xff;
+        m_buffer [m_size++] = value & 0xff;
+    }
+}
+
+/**
+ * Writes the given 32-bit \a value (in big-endian order)
+ */
+void DNSBuilder::write32 (quint32 value) {
+    if (reserve (4)) {
+        m_buffer [m_size++] = (value >> 24) & 0xff;
+        m_buffer [m_size++] = (value >> 16) & 0xff;
+        m_buffer [m_size++] = (value >>  8) & 0xff;
+        m_buffer [m_size++] = value & 0xff;
+    }
+}
+
+/**
+ * Writes the given \a length bytes of \a data
+ */
+void DNSBuilder::write (const void* data, int length) {
+    if (length > 0 && data && reserve (length)) {
+        memcpy (m_buffer + m_size, data, length);
+        m_size += length;
+    }
+}
+
+/**
+ * Returns \c true if there is room for \a length more bytes, otherwise the
+ * builder is marked as invalid
+ */
+bool DNSBuilder::reserve (int length) {
+    if (m_valid && length >= 0 && m_size + length <= m_capacity)
+        return true;
+
+    m_valid = false;
+    return false;
+}
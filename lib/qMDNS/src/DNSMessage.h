@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of qMDNS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _QMDNS_DNS_MESSAGE_H
+#define _QMDNS_DNS_MESSAGE_H
+
+#include <QtGlobal>
+
+/**
+ * \brief Bounds-checked, read-only view of a DNS message
+ *
+ * The view does not copy the message and does not allocate memory: the
+ * constructor walks the message once and stores the offsets of each
+ * question and resource record in a fixed-size table. Names are compared
+ * or decompressed directly from the message data when needed.
+ *
+ * Every offset is checked against the size of the message, and compression
+ * pointers must point backwards, so that malformed (or hostile) messages
+ * simply result in an invalid view.
+ */
+class DNSView {
+  public:
+    enum Section {
+        kQuestion   = 0,
+        kAnswer     = 1,
+        kAuthority  = 2,
+        kAdditional = 3,
+    };
+
+    /**
+     * \brief Question or resource record of a DNS message
+     *
+     * Questions only have a valid \c name, \c type and \c klass.
+     */
+    struct Entry {
+        int section;     /**< Section of the message */
+        int name;        /**< Offset of the (compressed) name */
+        quint16 type;    /**< Record type */
+        quint16 klass;   /**< Record class (with the cache-flush bit) */
+        quint32 ttl;     /**< Time to live of the record (in seconds) */
+        int data;        /**< Offset of the record data */
+        int length;      /**< Length of the record data */
+    };
+
+    static const int HEADER_SIZE = 12;
+    static const int MAX_ENTRIES = 32;
+    static const int MAX_NAME_LENGTH = 255;
+
+    DNSView (const char* data, int size);
+
+    bool isValid() const;
+    bool isQuery() const;
+    bool isResponse() const;
+
+    quint16 id() const;
+    quint16 flags() const;
+    int count() const;
+    const Entry& entry (int index) const;
+    const uchar* data (int offset) const;
+
+    quint16 read16 (int offset) const;
+    quint32 read32 (int offset) const;
+
+    bool nameEquals (int offset, const char* name, int length) const;
+    bool namesEqual (int first, int second) const;
+    int readName (int offset, char* buffer, int capacity) const;
+
+  private:
+    int skipName (int offset) const;
+    int nextLabel (int* offset, int* jumps) const;
+
+  private:
+    bool m_valid;
+    int m_size;
+    int m_count;
+    const uchar* m_data;
+    Entry m_entries [MAX_ENTRIES];
+};
+
+/**
+ * \brief Writes DNS messages into a caller-provided buffer
+ *
+ * The builder never allocates memory. If the message does not fit in the
+ * buffer, the builder is marked as invalid and ignores further writes.
+ */
+class DNSBuilder {
+  public:
+    DNSBuilder (char* buffer, int capacity);
+
+    bool isValid() const;
+    int size() const;
+
+    void header (quint16 id, quint16 flags,
+                 quint16 questions, quint16 answers,
+                 quint16 authorities, quint16 additionals);
+
+    void name (const char* name, int length);
+    void pointer (int offset);
+    void write8 (quint8 value);
+    void write16 (quint16 value);
+    void write32 (quint32 value);
+    void write (const void* data, int length);
+
+  private:
+    bool reserve (int length);
+
+  private:
+    bool m_valid;
+    int m_size;
+    int m_capacity;
+    uchar* m_buffer;
+};
+
+#endif
@@ -7,6 +7,7 @@
  */
 
 #include "qMDNS.h"
+#include "DNSMessage.h"
 
 #include <QHostInfo>
 #include <QUdpSocket>
@@ -32,60 +33,34 @@ const quint16 kQR_Response    = 0x8000;
 const quint16 kRecordA        = 0x0001;
 const quint16 kRecordAAAA     = 0x001C;
 const quint16 kNsecType       = 0x002F;
-const quint16 kFQDN_Separator = 0x0000;
-const quint16 kFQDN_Length    = 0xC00C;
 const quint16 kIN_BitFlush    = 0x8001;
 const quint16 kIN_Normal      = 0x0001;
+const quint16 kCacheFlush     = 0x8000;
 
-/*
- * DNS query properties
- */
-const quint16 kQuery_QDCOUNT = 0x02;
-const quint16 kQuery_ANCOUNT = 0x00;
-const quint16 kQuery_NSCOUNT = 0x00;
-const quint16 kQuery_ARCOUNT = 0x00;
+/* Packet constants */
+const int MAX_PACKET_SIZE = 512;
+const int MAX_DATAGRAM_SIZE = 9000;
 
-/*
- * DNS response properties
- */
-const quint16 kResponse_QDCOUNT = 0x00;
-const quint16 kResponse_ANCOUNT = 0x01;
-const quint16 kResponse_NSCOUNT = 0x00;
-const quint16 kResponse_ARCOUNT = 0x02;
+/* TTL assumed for the hosts resolved with the system DNS resolver */
+const quint32 DNS_TTL = 60;
 
-/* Packet constants */
-const int MIN_LENGTH = 13;
-const int IPI_LENGTH = 10;
-const int IP4_LENGTH = IPI_LENGTH + 4;
-const int IP6_LENGTH = IPI_LENGTH + 16;
+/* Record cache definitions */
+const int MAX_CACHE_SIZE = 256;
+const qint64 QUERY_INTERVAL = 1000;
 
 /**
- * Encondes the 16-bit \a number as two 8-bit numbers in a byte array
+ * Returns \c true if the given \a record is an A or AAAA record of the
+ * Internet class
  */
-QByteArray ENCODE_16_BIT (quint16 number) {
-    QByteArray data;
-    data.append ((number & 0xff00) >> 8);
-    data.append ((number & 0xff));
-    return data;
-}
+static bool IS_ADDRESS_RECORD (const DNSView::Entry& record) {
+    if (record.section == DNSView::kQuestion)
+        return false;
 
-/**
- * Encodes the 32-bit \a number as four 8-bit numbers
- */
-QByteArray ENCODE_32_BIT (quint32 number) {
-    QByteArray data;
-    data.append ((number & 0xff000000UL) >> 24);
-    data.append ((number & 0x00ff0000UL) >> 16);
-    data.append ((number & 0x0000ff00UL) >>  8);
-    data.append ((number & 0x000000ffUL));
-    return data;
-}
+    if ((record.klass & ~kCacheFlush) != kIN_Normal)
+        return false;
 
-/**
- * Obtains the 16-bit number stored in the \a upper and \a lower 8-bit numbers
- */
-quint16 DECODE_16_BIT (quint8 upper, quint8 lower) {
-    return (quint16) ((upper << 8) | lower);
+    return (record.type == kRecordA && record.length == 4) ||
+           (record.type == kRecordAAAA && record.length == 16);
 }
 
 /**
@@ -121,6 +96,9 @@ qMDNS::qMDNS() {
     /* Set default TTL to 4500 seconds */
     m_ttl = 4500;
 
+    /* Start the clock used by the record cache */
+    m_clock.start();
+
     /* Initialize sockets */
     m_IPv4Socket = new QUdpSocket (this);
     m_IPv6Socket = new QUdpSocket (this);
@@ -180,9 +158,11 @@ void qMDNS::setTTL (const quint32 ttl) {
 
 /**
  * Performs a mDNS lookup to find the given host \a name.
- * If \a preferIPv6 is set to \c true, then this function will generate a
- * packet that requests an AAAA-type Resource Record instead of an A-type
- * Resource Record.
+ *
+ * If the host is in the record cache (which is fed by every response seen
+ * in the mDNS group), the \c hostFound() and \c recordFound() signals are
+ * emitted before this function returns and no query is sent. Queries for
+ * the same host are not sent more than once per second.
  */
 void qMDNS::lookup (const QString& name) {
     /* The host name is empty, abort lookup */
@@ -198,56 +178,45 @@ void qMDNS::lookup (const QString& name) {
 
     /* Check if we are dealing with a normal DNS address */
     if (!address.endsWith (".local", Qt::CaseInsensitive)) {
-        QHostInfo::lookupHost (address, this, SIGNAL (hostFound (QHostInfo)));
+        QHostInfo::lookupHost (address, this,
+                               SLOT (onHostLookupFinished (QHostInfo)));
         return;
     }
 
-    /* Perform a mDNS lookup */
-    else {
-        QByteArray data;
+    /* Answer the lookup with the record cache */
+    else if (answerFromCache (address))
+        return;
 
-        /* Get the host name and domain */
-        QString host = address.split (".").first();
-        QString domain = address.split (".").last();
+    /* Perform a mDNS lookup (unless we just did it) */
+    else {
+        /* Do not flood the network with queries for the same host */
+        QString key = address.toLower();
+        qint64 now = m_clock.elapsed();
+        if (m_queries.contains (key)
+                && now - m_queries.value (key) < QUERY_INTERVAL)
+            return;
 
-        /* Check that domain length is valid */
-        if (host.length() > 255) {
-            qWarning() << Q_FUNC_INFO << host << "is too long!";
+        /* Ask for the IPv4 and IPv6 records of the host */
+        QByteArray fqdn = address.toUtf8();
+        char buffer [MAX_PACKET_SIZE];
+        DNSBuilder packet (buffer, sizeof (buffer));
+        packet.header (0, kQR_Query, 2, 0, 0, 0);
+        packet.name (fqdn.constData(), fqdn.length());
+        packet.write16 (kRecordA);
+        packet.write16 (kIN_Normal);
+        packet.pointer (DNSView::HEADER_SIZE);
+        packet.write16 (kRecordAAAA);
+        packet.write16 (kIN_Normal);
+
+        /* Check that the host name is valid */
+        if (!packet.isValid()) {
+            qWarning() << Q_FUNC_INFO << address << "is not a valid name!";
             return;
         }
 
-        /* Create header & flags */
-        data.append (ENCODE_16_BIT (0));
-        data.append (ENCODE_16_BIT (kQR_Query));
-        data.append (ENCODE_16_BIT (kQuery_QDCOUNT));
-        data.append (ENCODE_16_BIT (kQuery_ANCOUNT));
-        data.append (ENCODE_16_BIT (kQuery_NSCOUNT));
-        data.append (ENCODE_16_BIT (kQuery_ARCOUNT));
-
-        /* Add name data */
-        data.append (host.length());
-        data.append (host.toUtf8());
-
-        /* Add domain data */
-        data.append (domain.length());
-        data.append (domain.toUtf8());
-
-        /* Add FQDN/TLD separator */
-        data.append ((char) kFQDN_Separator);
-
-        /* Add IPv4 record type */
-        data.append (ENCODE_16_BIT (kRecordA));
-        data.append (ENCODE_16_BIT (kIN_Normal));
-
-        /* Add FQDN length */
-        data.append (ENCODE_16_BIT (kFQDN_Length));
-
-        /* Add IPv6 record type */
-        data.append (ENCODE_16_BIT (kRecordAAAA));
-        data.append (ENCODE_16_BIT (kIN_Normal));
-
         /* Send the datagram */
-        sendPacket (data);
+        m_queries.insert (key, now);
+        sendPacket (buffer, packet.size());
     }
 }
 
@@ -261,120 +230,70 @@ void qMDNS::setHostName (const QString& name) {
     }
 
     m_hostName = getAddress (name);
+    m_hostNameData = m_hostName.toUtf8();
 }
 
 /**
  * Called when we receive data from a mDNS client on the network.
+ * Every datagram is interpreted in place, without copying it.
  */
 void qMDNS::onReadyRead() {
-    QByteArray data;
     QUdpSocket* socket = qobject_cast<QUdpSocket*> (sender());
+    if (!socket)
+        return;
 
-    /* Read data from the socket */
-    if (socket) {
-        while (socket->hasPendingDatagrams()) {
-            data.resize (socket->pendingDatagramSize());
-            socket->readDatagram (data.data(), data.size());
-        }
-    }
-
-    /* Packet is a valid mDNS datagram */
-    if (data.length() > MIN_LENGTH) {
-        quint16 flag = DECODE_16_BIT (data.at (2), data.at (3));
-
-        if (flag == kQR_Query)
-            readQuery (data);
+    char buffer [MAX_DATAGRAM_SIZE];
+    while (socket->hasPendingDatagrams()) {
+        qint64 length = socket->readDatagram (buffer, sizeof (buffer));
+        if (length < 0)
+            break;
 
-        else if (flag >= kQR_Response)
-            readResponse (data);
+        DNSView view (buffer, (int) length);
+        if (view.isQuery())
+            interpretQuery (view);
+        else if (view.isResponse())
+            interpretResponse (view);
     }
 }
 
 /**
- * Reads the given query \a data and instructs the class to send a response
- * packet if the query is looking for the host name assigned to this computer.
+ * Called when the system DNS resolver finishes a lookup. The resolver does
+ * not report the TTL of the records, so a fixed TTL is assumed.
  */
-void qMDNS::readQuery (const QByteArray& data) {
-    /* Query packet is invalid */
-    if (data.length() < MIN_LENGTH)
-        return;
-
-    /* Get the lengths of the host name and domain */
-    int n = 12;
-    int hostLength = data.at (n);
-    int domainLength = data.at (n + hostLength + 1);
-
-    /* Read the host name until we stumble with the domain length character */
-    QString name;
-    int h = n + 1;
-    while (data.at (h) != (char) domainLength) {
-        name.append (data.at (h));
-        ++h;
-    }
-
-    /* Read domain length until we stumble with the FQDN/TLD separator */
-    QString domain;
-    int d = n + hostLength + 2;
-    while (data.at (d) != kFQDN_Separator) {
-        domain.append (data.at (d));
-        ++d;
-    }
-
-    /* Construct the full host name (name + domain) */
-    QString host = getAddress (name + "." + domain);
-
-    /* The query packet wants to know more about us */
-    if (host.toLower() == hostName().toLower())
-        sendResponse (DECODE_16_BIT (data.at (0), data.at (1)));
+void qMDNS::onHostLookupFinished (const QHostInfo& info) {
+    emit hostFound (info);
+    emit recordFound (info, DNS_TTL);
 }
 
 /**
- * Sends the given \a data to both the IPv4 and IPv6 mDNS multicast groups
+ * Reads the given query \a data and instructs the class to send a response
+ * packet if the query is looking for the host name assigned to this computer.
  */
-void qMDNS::sendPacket (const QByteArray& data) {
-    if (!data.isEmpty()) {
-        m_IPv4Socket->writeDatagram (data, IPV4_ADDRESS, MDNS_PORT);
-        m_IPv6Socket->writeDatagram (data, IPV6_ADDRESS, MDNS_PORT);
-    }
+void qMDNS::readQuery (const QByteArray& data) {
+    DNSView view (data.constData(), data.length());
+    if (view.isQuery())
+        interpretQuery (view);
 }
 
 /**
- * Reads the given \a data of a response packet and obtains:
- * - The remote host name
- * - The remote IPv4
- * - The remote IPv6
+ * Reads the given \a data of a response packet and registers the addresses
+ * of the remote host that it describes
  */
 void qMDNS::readResponse (const QByteArray& data) {
-    if (data.length() < MIN_LENGTH)
-        return;
-
-    QString host = getHostNameFromResponse (data);
-    QList<QHostAddress> addresses = getAddressesFromResponse (data, host);
-
-    if (!host.isEmpty() && !addresses.isEmpty()) {
-        QHostInfo info;
-        info.setHostName (host);
-        info.setAddresses (addresses);
-        info.setError (QHostInfo::NoError);
-
-        emit hostFound (info);
-    }
+    DNSView view (data.constData(), data.length());
+    if (view.isResponse())
+        interpretResponse (view);
 }
 
 /**
  * Sends a response packet with:
  * - Our mDNS host name
  * - Our IPv4 address
- * - Our IPv6 address
+ * - Our IPv6 addresses
+ * - A NSEC record, which tells that we have no other records
  */
 void qMDNS::sendResponse (const quint16 query_id) {
     if (!hostName().isEmpty() && hostName().endsWith (".local")) {
-        QByteArray data;
-
-        /* Get the host name and domain */
-        QString host = hostName().split (".").first();
-        QString domain = hostName().split (".").last();
-
         /* Get local IPs */
         quint32 ipv4 = 0;
         QList<QIPv6Address> ipv6;
@@ -388,271 +307,243 @@ void qMDNS::sendResponse (const quint16 query_id) {
             }
         }
 
-        /* Check that domain length is valid */
-        if (host.length() > 255) {
-            qWarning() << Q_FUNC_INFO << host << "is too long!";
-            return;
-        }
-
-        /* Create header and flags */
-        data.append (ENCODE_16_BIT (query_id));
-        data.append (ENCODE_16_BIT (kQR_Response));
-        data.append (ENCODE_16_BIT (kResponse_QDCOUNT));
-        data.append (ENCODE_16_BIT (kResponse_ANCOUNT));
-        data.append (ENCODE_16_BIT (kResponse_NSCOUNT));
-        data.append (ENCODE_16_BIT (kResponse_ARCOUNT));
-
-        /* Add name data */
-        data.append (host.length());
-        data.append (host.toUtf8());
+        char buffer [MAX_PACKET_SIZE];
+        DNSBuilder packet (buffer, sizeof (buffer));
 
-        /* Add domain data and FQDN/TLD separator */
-        data.append (domain.length());
-        data.append (domain.toUtf8());
-        data.append ((char) kFQDN_Separator);
+        /* Create header, the NSEC record goes with the IPv6 records */
+        packet.header (query_id, kQR_Response, 0, 1, 0, ipv6.count() + 1);
 
-        /* Add IPv4 address header */
-        data.append (ENCODE_16_BIT (kRecordA));
-        data.append (ENCODE_16_BIT (kIN_BitFlush));
-        data.append (ENCODE_32_BIT (m_ttl));
-        data.append (ENCODE_16_BIT (sizeof (ipv4)));
+        /* Add the IPv4 record */
+        packet.name (m_hostNameData.constData(), m_hostNameData.length());
+        packet.write16 (kRecordA);
+        packet.write16 (kIN_BitFlush);
+        packet.write32 (m_ttl);
+        packet.write16 (sizeof (ipv4));
+        packet.write32 (ipv4);
 
-        /* Add IPv4 bytes */
-        data.append (ENCODE_32_BIT (ipv4));
-
-        /* Add FQDN offset */
-        data.append (ENCODE_16_BIT (kFQDN_Length));
-
-        /* Add IPv6 addresses */
+        /* Add the IPv6 records */
         foreach (QIPv6Address ip, ipv6) {
-            data.append (ENCODE_16_BIT (kRecordAAAA));
-            data.append (ENCODE_16_BIT (kIN_BitFlush));
-            data.append (ENCODE_32_BIT (m_ttl));
-            data.append (ENCODE_16_BIT (sizeof (ip.c)));
-
-            /* Add IPv6 bytes */
-            for (unsigned long i = 0; i < sizeof (ip.c); ++i)
-                data.append (ip.c [i]);
-
-            /* Add FQDN offset */
-            data.append (ENCODE_16_BIT (kFQDN_Length));
+            packet.pointer (DNSView::HEADER_SIZE);
+            packet.write16 (kRecordAAAA);
+            packet.write16 (kIN_BitFlush);
+            packet.write32 (m_ttl);
+            packet.write16 (sizeof (ip.c));
+            packet.write (ip.c, sizeof (ip.c));
         }
 
-        /* TODO: Generate NSEC code block */
-        int nsec_length = 0;
-
-        /* Add NSEC data */
-        data.append (ENCODE_16_BIT (kNsecType));
-        data.append (ENCODE_16_BIT (kIN_BitFlush));
-        data.append (ENCODE_32_BIT (m_ttl));
-        data.append (ENCODE_16_BIT (nsec_length));
+        /* Add the NSEC record (bitmap window 0, with the A and AAAA bits) */
+        packet.pointer (DNSView::HEADER_SIZE);
+        packet.write16 (kNsecType);
+        packet.write16 (kIN_BitFlush);
+        packet.write32 (m_ttl);
+        packet.write16 (8);
+        packet.pointer (DNSView::HEADER_SIZE);
+        packet.write8 (0);
+        packet.write8 (4);
+        packet.write32 (0x40000008);
 
         /* Send the response */
-        sendPacket (data);
+        if (packet.isValid())
+            sendPacket (buffer, packet.size());
+        else
+            qWarning() << Q_FUNC_INFO << "Cannot generate response packet";
     }
 }
 
 /**
- * Extracts the host name from the \a data received from the mDNS network.
- * The host name begins at byte #12 (when the header and flags end) and ends
- * with a mandatory NUL character after the domain.
- *
- * The host name is constructed in the following way (without spaces):
- * \c NAME_LENGTH + \c NAME + \c DOMAIN_LENGTH + \c DOMAIN + \c NUL
- *
- * For example, appletv.local would be formatted as:
- * \c 0x07 + \c appletv + \c 0x05 + \c local + \c 0x00
- *
- * Or, if you prefer hex data:
- * \c { 07 61 70 70 6c 65 74 76 05 6c 6f 63 61 6c 00 }
- * \c {  7 a  p  p  l  e  t  v   5 l  o  c  a  l   0 }
- *
- * In order to obtain the full host name (and its mDNS domain), we construct
- * the string backwards. When the code notices that the current character is
- * the same as the domain length, we know that the domain name has been
- * extracted, and thus we can replace the domain length with a dot (.) and
- * begin extracting the host name.
+ * Sends the given \a data to both the IPv4 and IPv6 mDNS multicast groups
  */
-QString qMDNS::getHostNameFromResponse (const QByteArray& data) {
-    QList<char> list;
-    QString address = "";
+void qMDNS::sendPacket (const char* data, const int size) {
+    if (data && size > 0) {
+        m_IPv4Socket->writeDatagram (data, size, IPV4_ADDRESS, MDNS_PORT);
+        m_IPv6Socket->writeDatagram (data, size, IPV6_ADDRESS, MDNS_PORT);
+    }
+}
 
-    /* Begin reading host name at byte 13 (byte 12 is the host name length) */
-    int n = 13;
+/**
+ * Sends a response if any question of the given query \a view asks for the
+ * host name assigned to this computer. Queries for other hosts are rejected
+ * without allocating any memory.
+ */
+void qMDNS::interpretQuery (const DNSView& view) {
+    if (m_hostNameData.isEmpty())
+        return;
 
-    /* Read the host name until we stumble with the FQDN/TLD separator */
-    while (data.at (n) != kFQDN_Separator) {
-        list.append (data.at (n));
-        ++n;
-    }
+    for (int i = 0; i < view.count(); ++i) {
+        const DNSView::Entry& question = view.entry (i);
+        if (question.section != DNSView::kQuestion)
+            break;
 
-    /* Construct the string backwards (to replace domain length with a dot) */
-    for (int i = 0; i < list.count(); ++i) {
-        char character = list.at (list.count() - i - 1);
+        if (view.nameEquals (question.name,
+                             m_hostNameData.constData(),
+                             m_hostNameData.length())) {
+            if (!isKnownAnswer (view))
+                sendResponse (view.id());
 
-        if (character == (char) address.length())
-            address.prepend (".");
-        else
-            address.prepend (character);
+            return;
+        }
     }
-
-    return address;
 }
 
 /**
- * Extracts the IPv4 from the \a data received from the mDNS network.
- * The IPv4 data begins when the host name data ends.
+ * Obtains the host name and addresses from the A and AAAA records of the
+ * given response \a view, registers them in the record cache and emits the
+ * \c hostFound() and \c recordFound() signals.
  *
- * For the packet to contain IPv4 information, the DNS Record Type code must
- * be "A" (IPv4) and the DNS Class code should correspond to "IN" (Internet).
- *
- * Here is the layout of the IPv4 section of the packet:
- *
- * - DNS Record Type
- * - DNS Class Code
- * - TTL
- * - IP length
- * - IP address bytes
- *
- * This is an example IPv4 section:
- * \c {00 01 80 01 00 00 78 00 00 04 99 6d 07 5a}
- *
- * Data in example section:
- * - \c {00 01} Type Codes
- * - \c {80 01} Class Codes
- * - \c {00 00 78 00} IP TTL
- * - \c {00 04} Number of address bytes (length in layman's terms)
- * - \c {99 6d 07 5a} IPv4 Address bytes (153, 109, 7, 90)
+ * Only the host of the first address record is considered. Responses that
+ * do not contain any address record (e.g. service announcements, which are
+ * most of the mDNS traffic) are rejected without allocating any memory.
  */
-QString qMDNS::getIPv4FromResponse (const QByteArray& data,
-                                    const QString& host) {
-    QString ip = "";
+void qMDNS::interpretResponse (const DNSView& view) {
+    /* Find the first address record */
+    int first = 0;
+    while (first < view.count() && !IS_ADDRESS_RECORD (view.entry (first)))
+        ++first;
 
-    /* n stands for the byte index in which the host name data ends */
-    int n = MIN_LENGTH + host.length();
+    if (first >= view.count())
+        return;
 
-    /* Packet is too small */
-    if (data.length() < n + IP4_LENGTH)
-        return ip;
+    /* Get the host name */
+    const DNSView::Entry& record = view.entry (first);
+    char name [DNSView::MAX_NAME_LENGTH + 1];
+    int length = view.readName (record.name, name, sizeof (name));
+    if (length <= 0)
+        return;
 
-    /* Get the IP type and class codes */
-    quint16 typeCode  = DECODE_16_BIT (data.at (n + 1), data.at (n + 2));
-    quint16 classCode = DECODE_16_BIT (data.at (n + 3), data.at (n + 4));
+    /* Get the addresses of the host */
+    QList<QHostAddress> addresses;
+    for (int i = first; i < view.count(); ++i) {
+        const DNSView::Entry& entry = view.entry (i);
+        if (!IS_ADDRESS_RECORD (entry) || !view.namesEqual (entry.name,
+                                                            record.name))
+            continue;
+
+        QHostAddress address;
+        if (entry.type == kRecordA)
+            address = QHostAddress (view.read32 (entry.data));
+        else
+            address = QHostAddress (view.data (entry.data));
 
-    /* Check if type and class codes are good */
-    if (typeCode != kRecordA || classCode != kIN_BitFlush)
-        return ip;
+        if (!address.isNull() && !addresses.contains (address))
+            addresses.append (address);
+    }
+
+    if (addresses.isEmpty())
+        return;
 
-    /* Skip TTL indicator and obtain the number of address bytes */
-    quint8 length = data.at (n + IPI_LENGTH);
+    /* Update the cache and notify the application */
+    QString host = QString::fromUtf8 (name, length);
+    updateCache (host, addresses, record.ttl, record.klass & kCacheFlush);
 
-    /* Append each IPv4 address byte (and decimal dots) to the IP string */
-    for (int i = 1; i < length + 1; ++i) {
-        ip += QString::number ((quint8) data.at (n + IPI_LENGTH + i));
-        ip += (i < length) ? "." : "";
-    }
+    QHostInfo info;
+    info.setHostName (host);
+    info.setAddresses (addresses);
+    info.setError (QHostInfo::NoError);
 
-    return ip;
+    emit hostFound (info);
+    emit recordFound (info, record.ttl);
 }
 
 /**
- * Extracts the IPv6 from the \a data received from the mDNS network.
- * The IPv6 data begins when the host name data ends.
- *
- * For the packet to contain IPv6 information, the DNS Record Type code must
- * be "AAAA" (IPv6) and the DNS Class code should correspond to "IN" (Internet).
- *
- * Here is the layout of the IPv4 section of the packet:
- *
- * - DNS Record Type
- * - DNS Class Code
- * - TTL
- * - IP length
- * - IP address bytes
- *
- * This is an example IPv6 section:
- * \c { 00 1c 80 01 00 00 78 00 00 10 fe 80 00 00 00 00 00 00 02 23 32 ff fe b1 21 52 }
- *
- * Data in example section:
- * - \c {00 1c} Type Codes
- * - \c {80 01} Class Codes
- * - \c {00 00 78 00} IP TTL
- * - \c {00 10} Number of address bytes (length in layman's terms)
- * - \c {fe 80 00 00 ... 52} IPv6 Address bytes (there are 16 of them)
+ * Emits the \c hostFound() and \c recordFound() signals with the cached
+ * record of the given host \a name. Returns \c false if the host is not
+ * cached or if its record has expired.
  */
-QStringList qMDNS::getIPv6FromResponse (const QByteArray& data,
-                                        const QString& host) {
-    QStringList list;
-
-    /* Skip the FQDN and IPv4 section */
-    int n = MIN_LENGTH + IP4_LENGTH + host.length();
+bool qMDNS::answerFromCache (const QString& name) {
+    QString key = name.toLower();
+    if (!m_cache.contains (key))
+        return false;
 
-    /* Get the IPv6 list */
-    bool isIPv6 = true;
-    while (isIPv6) {
-        /* Skip FQDN bytes */
-        n += 2;
+    const Record& record = m_cache [key];
+    qint64 remaining = record.expiry - m_clock.elapsed();
+    if (remaining <= 0) {
+        m_cache.remove (key);
+        return false;
+    }
 
-        /* Packet is invalid */
-        if (data.length() < n + IP6_LENGTH)
-            break;
+    QHostInfo info;
+    info.setHostName (name);
+    info.setAddresses (record.addresses);
+    info.setError (QHostInfo::NoError);
 
-        /* Get the IP type and class codes */
-        quint16 typeCode  = DECODE_16_BIT (data.at (n + 1), data.at (n + 2));
-        quint16 classCode = DECODE_16_BIT (data.at (n + 3), data.at (n + 4));
-        isIPv6 = (typeCode == kRecordAAAA && classCode == kIN_BitFlush);
-
-        /* IP type and class codes are OK, extract IP */
-        if (isIPv6) {
-            /* Skip TTL indicator and obtain the number of address bytes */
-            quint8 length = data.at (n + IPI_LENGTH);
-
-            /* Append each IPv6 address byte (encoded as hex) to the IP string */
-            QString ip = "";
-            for (int i = 1; i < length + 1; ++i) {
-                /* Get the hexadecimal representation of the byte */
-                QString byte;
-                byte.setNum ((quint8) data.at (n + i + IPI_LENGTH), 16);
-
-                /* Add the obtained string */
-                ip += byte;
-
-                /* Append colons after even indexes (except in the last byte) */
-                if ((i & 1) == 0 && (i < length))
-                    ip += ":";
-            }
+    emit hostFound (info);
+    emit recordFound (info, (quint32) (remaining / 1000));
 
-            /* Increase the counter to 'jump' to the next section */
-            n += 26;
+    return true;
+}
 
-            /* Append the obtained IP to the list */
-            if (!list.contains (ip))
-                list.append (ip);
-        }
+/**
+ * Returns \c true if the given query \a view already includes one of our
+ * IPv4 addresses as a known answer, with at least half of our TTL left.
+ * In that case, the querier already knows about us and we do not need to
+ * send a response (known-answer suppression, see RFC 6762, section 7.1).
+ */
+bool qMDNS::isKnownAnswer (const DNSView& view) {
+    QList<QHostAddress> local;
+
+    for (int i = 0; i < view.count(); ++i) {
+        const DNSView::Entry& answer = view.entry (i);
+        if (answer.section != DNSView::kAnswer
+                || answer.type != kRecordA
+                || answer.length != 4
+                || answer.ttl < m_ttl / 2)
+            continue;
+
+        if (local.isEmpty())
+            local = QNetworkInterface::allAddresses();
+
+        if (local.contains (QHostAddress (view.read32 (answer.data))))
+            return true;
     }
 
-    return list;
+    return false;
 }
 
 /**
- * Obtains the IPv4 and IPv6 addresses from the received data.
- * \note This function will only generate a list with the valid IP addresses.
+ * Registers the given \a addresses of the given \a host in the record
+ * cache, which is valid for the given \a ttl (in seconds).
+ *
+ * If \a flush is set to \c true, the addresses replace the cached ones,
+ * otherwise, they are added to them. A \a ttl of zero (a "goodbye" packet)
+ * removes the host from the cache.
  */
-QList<QHostAddress> qMDNS::getAddressesFromResponse (const QByteArray& data,
-        const QString& host) {
-    QList<QHostAddress> list;
-
-    /* Add IPv4 address */
-    QHostAddress IPv4Address = QHostAddress (getIPv4FromResponse (data, host));
-    if (!IPv4Address.isNull())
-        list.append (IPv4Address);
-
-    /* Add IPv6 addresses */
-    foreach (QString ip, getIPv6FromResponse (data, host)) {
-        QHostAddress address = QHostAddress (ip);
-        if (!address.isNull())
-            list.append (address);
+void qMDNS::updateCache (const QString& host,
+                         const QList<QHostAddress>& addresses,
+                         const quint32 ttl,
+                         const bool flush) {
+    QString key = host.toLower();
+    qint64 now = m_clock.elapsed();
+
+    /* The host is leaving the network */
+    if (ttl == 0) {
+        m_cache.remove (key);
+        return;
+    }
+
+    /* Remove expired records before the cache grows too much */
+    if (!m_cache.contains (key) && m_cache.count() >= MAX_CACHE_SIZE) {
+        QHash<QString, Record>::iterator i = m_cache.begin();
+        while (i != m_cache.end()) {
+            if (i.value().expiry <= now)
+                i = m_cache.erase (i);
+            else
+                ++i;
+        }
+
+        if (m_cache.count() >= MAX_CACHE_SIZE)
+            return;
+    }
+
+    /* Update the record */
+    Record& record = m_cache [key];
+    if (flush || record.expiry <= now)
+        record.addresses.clear();
+
+    foreach (const QHostAddress& address, addresses) {
+        if (!record.addresses.contains (address))
+            record.addresses.append (address);
     }
 
-    return list;
+    record.expiry = now + (qint64) ttl * 1000;
+    m_queries.remove (key);
 }
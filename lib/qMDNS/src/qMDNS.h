@@ -6,11 +6,14 @@
  * of this project.
  */
 
+#include <QHash>
 #include <QObject>
+#include <QHostAddress>
+#include <QElapsedTimer>
 
+class DNSView;
 class QHostInfo;
 class QUdpSocket;
-class QHostAddress;
 
 /**
  * \brief Implements a simple mDNS responder using Qt
@@ -21,17 +24,22 @@ class QHostAddress;
  * You can obtain the IP of an mDNS device using the \c lookup() function,
  * the \c hostFound() signal will be emitted whenever this class interprets
  * a mDNS response packet and obtains valid information about a remote host.
+ * The \c recordFound() signal is emitted at the same time, and also reports
+ * for how long (in seconds) the obtained information is valid.
+ *
+ * Every response seen in the mDNS group is kept in a record cache (honoring
+ * the TTL and cache-flush bit of the records), so that most lookups can be
+ * answered without sending a query.
  *
  * You can change the name that the local computer uses to identify itself
  * in the mDNS network using the \c setHostName() function.
- *
- * \todo Implement NSEC block code generation in the \c sendResponse() packet
  */
 class qMDNS : public QObject {
     Q_OBJECT
 
   signals:
     void hostFound (const QHostInfo& info);
+    void recordFound (const QHostInfo& info, quint32 ttl);
 
   public:
     static qMDNS* getInstance();
@@ -50,21 +58,37 @@ class qMDNS : public QObject {
 
   private slots:
     void onReadyRead();
+    void onHostLookupFinished (const QHostInfo& info);
     void readQuery (const QByteArray& data);
-    void sendPacket (const QByteArray& data);
     void readResponse (const QByteArray& data);
     void sendResponse (const quint16 query_id);
 
   private:
-    QString getHostNameFromResponse (const QByteArray& data);
-    QString getIPv4FromResponse (const QByteArray& data, const QString& host);
-    QStringList getIPv6FromResponse (const QByteArray& data, const QString& host);
-    QList<QHostAddress> getAddressesFromResponse (const QByteArray& data,
-                                                  const QString& host);
+    bool answerFromCache (const QString& name);
+    bool isKnownAnswer (const DNSView& view);
+    void interpretQuery (const DNSView& view);
+    void interpretResponse (const DNSView& view);
+    void sendPacket (const char* data, const int size);
+    void updateCache (const QString& host,
+                      const QList<QHostAddress>& addresses,
+                      const quint32 ttl,
+                      const bool flush);
 
   private:
+    /**
+     * Cached addresses of a remote host
+     */
+    struct Record {
+        qint64 expiry = 0;
+        QList<QHostAddress> addresses;
+    };
+
     quint32 m_ttl;
     QString m_hostName;
+    QByteArray m_hostNameData;
+    QElapsedTimer m_clock;
+    QHash<QString, Record> m_cache;
+    QHash<QString, qint64> m_queries;
     QUdpSocket* m_IPv4Socket;
     QUdpSocket* m_IPv6Socket;
 };
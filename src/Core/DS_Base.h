@@ -43,6 +43,14 @@ class DS_Base : public DS {
      */
     void statusChanged (const QString& status);
 
+    /**
+     * Emitted once after the values of the robot or DS are changed. The
+     * \a changes are a combination of \c StateChange flags. All the changes
+     * caused by the same packet are reported together, after every value has
+     * been updated.
+     */
+    void stateChanged (const int changes);
+
     /**
      * Emitted when protocol knows if the target robot is simulated or not
      */
@@ -163,6 +171,12 @@ class DS_Base : public DS {
      * robot controller.
      */
     void diskUsageChanged (const int usage);
+
+    /**
+     * Emitted when the robot reports a change in the utilization of its
+     * CAN bus.
+     */
+    void canUsageChanged (const int usage);
 };
 
 
@@ -52,6 +52,11 @@
 //------------------------------------------------------------------------------
 
 const int DS_DISABLED_PORT = -1;
+
+const int DS_MAX_POVS = 12;
+const int DS_MAX_AXES = 12;
+const int DS_MAX_BUTTONS = 24;
+const int DS_MAX_JOYSTICKS = 6;
 const QAbstractSocket::BindMode DS_BIND_MODE = \
                                                QAbstractSocket::ShareAddress |
                                                QAbstractSocket::ReuseAddressHint;
@@ -151,6 +156,35 @@ class DS : public QObject {
     };
     SMART_ENUM (VoltageStatus)
 
+    /**
+     * \brief Identifies the values that changed in a \c stateChanged() signal
+     *
+     * The values are flags, several changes are reported together when they
+     * were caused by the same packet.
+     */
+    enum StateChange {
+        kTeamChanged            = 0x00001, /**< Team number */
+        kAllianceChanged        = 0x00002, /**< Team alliance */
+        kPositionChanged        = 0x00004, /**< Team position */
+        kVoltageChanged         = 0x00008, /**< Robot voltage */
+        kSimulatedChanged       = 0x00010, /**< Robot simulation status */
+        kCpuUsageChanged        = 0x00020, /**< Robot CPU usage */
+        kRamUsageChanged        = 0x00040, /**< Robot RAM usage */
+        kDiskUsageChanged       = 0x00080, /**< Robot disk usage */
+        kLibVersionChanged      = 0x00100, /**< Robot library version */
+        kPcmVersionChanged      = 0x00200, /**< PCM firmware version */
+        kPdpVersionChanged      = 0x00400, /**< PDP firmware version */
+        kCodeStatusChanged      = 0x00800, /**< Robot code status */
+        kControlModeChanged     = 0x01000, /**< Robot control mode */
+        kEnableStatusChanged    = 0x02000, /**< Robot enabled status */
+        kVoltageStatusChanged   = 0x04000, /**< Robot brownout status */
+        kOperationStatusChanged = 0x08000, /**< Robot e-stop status */
+        kFMSCommStatusChanged   = 0x10000, /**< FMS communications */
+        kRadioCommStatusChanged = 0x20000, /**< Radio communications */
+        kRobotCommStatusChanged = 0x40000, /**< Robot communications */
+        kCanUsageChanged        = 0x80000, /**< Robot CAN bus usage */
+    };
+
     /**
      * \brief Represents the socket types that can be used by the DS modules
      */
@@ -162,11 +196,11 @@ class DS : public QObject {
 
     /**
      * \brief Represents a joystick and its respective properties
+     *
+     * The values of the joystick are stored in the joystick table of the
+     * \c DriverStation (see \c JoystickFrame)
      */
     struct Joystick {
-        int* povs;              /**< Holds the POV angles array */
-        qreal* axes;            /**< Holds the axis values array */
-        bool* buttons;          /**< Holds the button states array */
         int numAxes = 0;        /**< Holds the number of axes used by the DS */
         int numPOVs = 0;        /**< Holds the number of POVs used by the DS */
         int numButtons = 0;     /**< Holds the number of buttons used by the DS */
@@ -175,6 +209,37 @@ class DS : public QObject {
         int realNumButtons = 0; /**< Holds the number of buttons of the joystick */
     };
 
+    /**
+     * \brief Holds the values of a joystick at a given moment
+     *
+     * The values are stored in the form used by the protocols: axes are
+     * quantized to signed bytes and the buttons are packed in a bitmask (the
+     * first button is the least significant bit). Unused values are always
+     * neutral, so that they can be copied to a packet as-is.
+     *
+     * Each state is padded to the size of a cache line.
+     */
+    struct JoystickState {
+        quint32 buttons;                /**< Button states bitmask */
+        qint16 povs [DS_MAX_POVS];      /**< POV angles (-1 if not pressed) */
+        DS_SByte axes [DS_MAX_AXES];    /**< Axis values (-127 to 127) */
+        DS_UByte numAxes;               /**< Number of axes used by the DS */
+        DS_UByte numPOVs;               /**< Number of POVs used by the DS */
+        DS_UByte numButtons;            /**< Number of buttons used by the DS */
+        DS_UByte reserved [21];         /**< Padding up to 64 bytes */
+    };
+
+    /**
+     * \brief Contiguous table with the state of every registered joystick
+     *
+     * The states come first, so that each of them fills a whole cache line
+     * when the frame is aligned.
+     */
+    struct JoystickFrame {
+        JoystickState joysticks [DS_MAX_JOYSTICKS];   /**< Joystick states */
+        int count = 0;                                /**< Joystick count */
+    };
+
     /**
      * \brief Returns a calculated IP address based on the team address.
      *
@@ -293,16 +358,19 @@ class DS : public QObject {
     }
 
     /**
-     * \brief Reads the datagrams received by the given UDP \a socket
+     * \brief Reads the next datagram received by the given UDP \a socket
+     *
+     * Only one datagram is read, so that separate messages are not merged.
+     * Call this function while the socket has pending datagrams to read
+     * all of them.
      */
     static inline QByteArray readSocket (QUdpSocket* socket) {
         QByteArray data;
 
-        if (socket) {
-            while (socket->hasPendingDatagrams()) {
-                data.resize (socket->pendingDatagramSize());
-                socket->readDatagram (data.data(), data.size());
-            }
+        if (socket && socket->hasPendingDatagrams()) {
+            data.resize (socket->pendingDatagramSize());
+            int length = socket->readDatagram (data.data(), data.size());
+            data.resize (qMax (length, 0));
         }
 
         return data;
@@ -319,6 +387,10 @@ class DS : public QObject {
     }
 };
 
+Q_STATIC_ASSERT (sizeof (DS::JoystickState) == 64);
+Q_STATIC_ASSERT (offsetof (DS::JoystickFrame, joysticks) % 64 == 0);
+Q_STATIC_ASSERT (DS_MAX_BUTTONS <= 32);
+
 Q_DECLARE_METATYPE (DS::Alliance)
 Q_DECLARE_METATYPE (DS::Position)
 Q_DECLARE_METATYPE (DS::SocketType)
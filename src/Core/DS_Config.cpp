@@ -13,6 +13,17 @@
 #include <QElapsedTimer>
 #include <Core/Logger.h>
 
+/*
+ * Changes that modify the general status string of the DS
+ */
+const int STATUS_CHANGES = DS::kCodeStatusChanged |
+                           DS::kControlModeChanged |
+                           DS::kEnableStatusChanged |
+                           DS::kVoltageStatusChanged |
+                           DS::kOperationStatusChanged |
+                           DS::kFMSCommStatusChanged |
+                           DS::kRobotCommStatusChanged;
+
 DS_Config::DS_Config() {
     m_timer = new QElapsedTimer;
     m_logger = new Logger;
@@ -22,6 +33,7 @@ DS_Config::DS_Config() {
     m_cpuUsage = 0;
     m_ramUsage = 0;
     m_diskUsage = 0;
+    m_canUsage = 0;
     m_libVersion = "";
     m_pcmVersion = "";
     m_pdpVersion = "";
@@ -38,6 +50,11 @@ DS_Config::DS_Config() {
     m_robotCommStatus = kCommsFailing;
     m_controlMode = kControlTeleoperated;
 
+    m_changes = 0;
+    m_batchDepth = 0;
+    m_batchThread.store (Q_NULLPTR);
+    publish();
+
     /* Move the robot logger to another thread */
     QThread* thread = new QThread (this);
     m_logger->moveToThread (thread);
@@ -62,6 +79,15 @@ DS_Config* DS_Config::getInstance() {
     return &instance;
 }
 
+/**
+ * Returns a consistent copy of the current values, which can be called from
+ * any thread without locking. The snapshot is updated after every change,
+ * or after every batch of changes (see \c beginBatch()).
+ */
+DS_Config::State DS_Config::state() const {
+    return m_state.load();
+}
+
 /**
  * Returns the current team number
  */
@@ -90,6 +116,13 @@ int DS_Config::diskUsage() const {
     return m_diskUsage;
 }
 
+/**
+ * Returns the current utilization of the robot CAN bus (0 - 100)
+ */
+int DS_Config::canUsage() const {
+    return m_canUsage;
+}
+
 /**
  * Returns the current voltage of the robot
  */
@@ -250,13 +283,54 @@ DS::OperationStatus DS_Config::operationStatus() const {
     return m_operationStatus;
 }
 
+/**
+ * Begins a batch of changes in the current thread. The signals of the values
+ * changed by the current thread are not emitted until the matching call to
+ * \c endBatch(). Batches can be nested.
+ *
+ * Only one thread can batch changes at a time, if another thread is in a
+ * batch, this function waits until that batch ends. The changes made by the
+ * other threads during a batch are reported immediately.
+ */
+void DS_Config::beginBatch() {
+    if (!batching()) {
+        m_batchMutex.lock();
+        m_batchThread.storeRelease (QThread::currentThread());
+    }
+
+    ++m_batchDepth;
+}
+
+/**
+ * Ends a batch of changes. When the outermost batch ends, each value that
+ * changed during the batch emits its signal once, followed by a single
+ * \c stateChanged() signal with every change.
+ */
+void DS_Config::endBatch() {
+    Q_ASSERT (batching());
+
+    if (--m_batchDepth > 0)
+        return;
+
+    int changes = m_changes;
+    m_changes = 0;
+
+    m_batchThread.storeRelease (Q_NULLPTR);
+    m_batchMutex.unlock();
+
+    if (changes != 0)
+        publish();
+
+    emitSignals (changes, changes);
+}
+
 /**
  * Changes the \a team number and fires the appropriate signals if required
  */
 void DS_Config::updateTeam (int team) {
     if (m_team != team) {
         m_team = team;
-        emit teamChanged (m_team);
+        notify (kTeamChanged, true);
 
         qDebug() << "Team number set to" << team;
     }
@@ -287,24 +361,36 @@ void DS_Config::setEnabled (bool enabled) {
  * Changes the CPU \a usage and fires the appropriate signals if required
  */
 void DS_Config::updateCpuUsage (int usage) {
-    m_cpuUsage = 0;
-    emit cpuUsageChanged (usage);
+    bool modified = (m_cpuUsage != usage);
+    m_cpuUsage = usage;
+    notify (kCpuUsageChanged, modified);
 }
 
 /**
  * Changes the RAM \a usage and fires the appropriate signals if required
  */
 void DS_Config::updateRamUsage (int usage) {
-    m_ramUsage = 0;
-    emit ramUsageChanged (usage);
+    bool modified = (m_ramUsage != usage);
+    m_ramUsage = usage;
+    notify (kRamUsageChanged, modified);
 }
 
 /**
  * Changes the disk \a usage and fires the appropriate signals if required
  */
 void DS_Config::updateDiskUsage (int usage) {
-    m_diskUsage = 0;
-    emit diskUsageChanged (usage);
+    bool modified = (m_diskUsage != usage);
+    m_diskUsage = usage;
+    notify (kDiskUsageChanged, modified);
+}
+
+/**
+ * Changes the CAN bus \a usage and fires the appropriate signals if required
+ */
+void DS_Config::updateCanUsage (int usage) {
+    bool modified = (m_canUsage != usage);
+    m_canUsage = usage;
+    notify (kCanUsageChanged, modified);
 }
 
 /**
@@ -332,6 +418,8 @@ void DS_Config::setEmergencyStop (bool estop) {
  * Changes the robot \a voltage and fires the appropriate signals if required
  */
 void DS_Config::updateVoltage (qreal voltage) {
+    qreal previous = m_voltage;
+
     /* Round voltage to two decimal places */
     m_voltage = roundf (voltage * 100) / 100;
 
@@ -339,21 +427,8 @@ void DS_Config::updateVoltage (qreal voltage) {
     if (m_voltage > DriverStation::getInstance()->maxBatteryVoltage())
         m_voltage = DriverStation::getInstance()->maxBatteryVoltage();
 
-    /* Separate voltage into natural and decimal numbers */
-    int integer = static_cast<int> (m_voltage);
-    int decimal = static_cast<qreal> (m_voltage - integer) * 100;
-
-    /* Convert the obtained numbers into strings */
-    QString integer_str = QString::number (integer);
-    QString decimal_str = QString::number (decimal);
-
-    /* Prepend a 0 to the decimal numbers if required */
-    if (decimal < 10)
-        decimal_str.prepend ("0");
-
-    /* Emit signals */
-    emit voltageChanged (m_voltage);
-    emit voltageChanged (integer_str + "." + decimal_str + " V");
+    /* Emit signals (the voltage string is updated periodically) */
+    notify (kVoltageChanged, m_voltage != previous);
 
     /* Log robot voltage */
     m_logger->registerVoltage (m_voltage);
@@ -364,32 +439,35 @@ void DS_Config::updateVoltage (qreal voltage) {
  * required
  */
 void DS_Config::updateSimulated (bool simulated) {
+    bool modified = (m_simulated != simulated);
     m_simulated = simulated;
-    emit simulatedChanged (simulated);
+    notify (kSimulatedChanged, modified);
 }
 
 /**
  * Changes the \a alliance and fires the appropriate signals if required
  */
 void DS_Config::updateAlliance (Alliance alliance) {
-    if (m_alliance != alliance) {
+    bool modified = (m_alliance != alliance);
+    if (modified) {
         m_alliance = alliance;
         m_logger->registerAlliance (alliance);
     }
 
-    emit allianceChanged (m_alliance);
+    notify (kAllianceChanged, modified);
 }
 
 /**
  * Changes the \a position and fires the appropriate signals if required
  */
 void DS_Config::updatePosition (Position position) {
-    if (m_position != position) {
+    bool modified = (m_position != position);
+    if (modified) {
         m_position = position;
         m_logger->registerPosition (position);
     }
 
-    emit positionChanged (m_position);
+    notify (kPositionChanged, modified);
 }
 
 /**
@@ -397,13 +475,13 @@ void DS_Config::updatePosition (Position position) {
  * required
  */
 void DS_Config::updateRobotCodeStatus (CodeStatus status) {
-    if (m_codeStatus != status) {
+    bool modified = (m_codeStatus != status);
+    if (modified) {
         m_codeStatus = status;
         m_logger->registerCodeStatus (status);
     }
 
-    emit codeStatusChanged (m_codeStatus);
-    emit statusChanged (DriverStation::getInstance()->generalStatus());
+    notify (kCodeStatusChanged, modified);
 }
 
 /**
@@ -411,13 +489,13 @@ void DS_Config::updateRobotCodeStatus (CodeStatus status) {
  * required
  */
 void DS_Config::updateControlMode (ControlMode mode) {
-    if (m_controlMode != mode) {
+    bool modified = (m_controlMode != mode);
+    if (modified) {
         m_controlMode = mode;
         m_logger->registerControlMode (mode);
     }
 
-    emit controlModeChanged (m_controlMode);
-    emit statusChanged (DriverStation::getInstance()->generalStatus());
+    notify (kControlModeChanged, modified);
 }
 
 /**
@@ -425,43 +503,47 @@ void DS_Config::updateControlMode (ControlMode mode) {
  * required
  */
 void DS_Config::updateLibVersion (const QString& version) {
-    if (m_libVersion != version) {
+    bool modified = (m_libVersion != version);
+    if (modified) {
         m_libVersion = version;
         qDebug() << "LIB version set to" << version;
     }
 
-    emit libVersionChanged (m_libVersion);
+    notify (kLibVersionChanged, modified);
 }
 
 /**
  * Changes the PCM \a version and fires the appropriate signals if required
  */
 void DS_Config::updatePcmVersion (const QString& version) {
-    if (m_pcmVersion != version) {
+    bool modified = (m_pcmVersion != version);
+    if (modified) {
         m_pcmVersion = version;
         qDebug() << "PCM version set to" << version;
     }
 
-    emit pcmVersionChanged (m_pcmVersion);
+    notify (kPcmVersionChanged, modified);
 }
 
 /**
  * Changes the PDP/PDB \a version and fires the appropriate signals if required
  */
 void DS_Config::updatePdpVersion (const QString& version) {
-    if (m_pdpVersion != version) {
+    bool modified = (m_pdpVersion != version);
+    if (modified) {
         m_pdpVersion = version;
         qDebug() << "PDP version set to" << version;
     }
 
-    emit pdpVersionChanged (m_pdpVersion);
+    notify (kPdpVersionChanged, modified);
 }
 
 /**
  * Changes the enabled \a status and fires the appropriate signals if required
  */
 void DS_Config::updateEnabled (EnableStatus status) {
-    if (m_enableStatus != status) {
+    bool modified = (m_enableStatus != status);
+    if (modified) {
         m_enableStatus = status;
 
         if (status == DS::kEnabled) {
@@ -475,8 +557,7 @@ void DS_Config::updateEnabled (EnableStatus status) {
         m_logger->registerEnableStatus (status);
     }
 
-    emit enabledChanged (m_enableStatus);
-    emit statusChanged (DriverStation::getInstance()->generalStatus());
+    notify (kEnableStatusChanged, modified);
 }
 
 /**
@@ -484,13 +565,13 @@ void DS_Config::updateEnabled (EnableStatus status) {
  * if required
  */
 void DS_Config::updateFMSCommStatus (CommStatus status) {
-    if (m_fmsCommStatus != status) {
+    bool modified = (m_fmsCommStatus != status);
+    if (modified) {
         m_fmsCommStatus = status;
         qDebug() << "FMS comm. status set to" << status;
     }
 
-    emit fmsCommStatusChanged (m_fmsCommStatus);
-    emit statusChanged (DriverStation::getInstance()->generalStatus());
+    notify (kFMSCommStatusChanged, modified);
 }
 
 /**
@@ -498,12 +579,13 @@ void DS_Config::updateFMSCommStatus (CommStatus status) {
  * if required
  */
 void DS_Config::updateRadioCommStatus (CommStatus status) {
-    if (m_radioCommStatus != status) {
+    bool modified = (m_radioCommStatus != status);
+    if (modified) {
         m_radioCommStatus = status;
         m_logger->registerRadioCommStatus (status);
     }
 
-    emit radioCommStatusChanged (m_radioCommStatus);
+    notify (kRadioCommStatusChanged, modified);
 }
 
 /**
@@ -511,13 +593,13 @@ void DS_Config::updateRadioCommStatus (CommStatus status) {
  * if required
  */
 void DS_Config::updateRobotCommStatus (CommStatus status) {
-    if (m_robotCommStatus != status) {
+    bool modified = (m_robotCommStatus != status);
+    if (modified) {
         m_robotCommStatus = status;
         m_logger->registerRobotCommStatus (status);
     }
 
-    emit robotCommStatusChanged (m_robotCommStatus);
-    emit statusChanged (DriverStation::getInstance()->generalStatus());
+    notify (kRobotCommStatusChanged, modified);
 }
 
 /**
@@ -525,14 +607,13 @@ void DS_Config::updateRobotCommStatus (CommStatus status) {
  * if required
  */
 void DS_Config::updateVoltageStatus (VoltageStatus status) {
-    if (m_voltageStatus != status) {
+    bool modified = (m_voltageStatus != status);
+    if (modified) {
         m_voltageStatus = status;
         m_logger->registerVoltageStatus (status);
     }
 
-    emit voltageStatusChanged (m_voltageStatus);
-    emit statusChanged (DriverStation::getInstance()->generalStatus());
-
+    notify (kVoltageStatusChanged, modified);
 }
 
 /**
@@ -540,14 +621,146 @@ void DS_Config::updateVoltageStatus (VoltageStatus status) {
  * if required
  */
 void DS_Config::updateOperationStatus (OperationStatus status) {
-    if (m_operationStatus != status) {
+    bool modified = (m_operationStatus != status);
+    if (modified) {
         m_operationStatus = status;
         updateEnabled (DS::kDisabled);
         m_logger->registerOperationStatus (status);
     }
 
-    emit operationStatusChanged (m_operationStatus);
-    emit statusChanged (DriverStation::getInstance()->generalStatus());
+    notify (kOperationStatusChanged, modified);
+}
+
+/**
+ * Emits the voltage string if the robot voltage changed since the last time
+ * that the string was emitted. This function is called every 100 milliseconds
+ * with the elapsed time, so that the UI is not flooded with voltage strings
+ * (the robot reports its voltage in every packet).
+ */
+void DS_Config::updateVoltageString() {
+    /* Separate voltage into natural and decimal numbers (the voltage is
+     * written by the network thread, so read it from the snapshot) */
+    qreal voltage = state().voltage;
+    int integer = static_cast<int> (voltage);
+    int decimal = qRound ((voltage - integer) * 100);
+
+    /* Convert the obtained numbers into strings */
+    QString string = QString ("%1.%2 V")
+                     .arg (integer)
+                     .arg (decimal, 2, 10, QLatin1Char ('0'));
+
+    if (m_voltageString != string) {
+        m_voltageString = string;
+        emit voltageChanged (m_voltageString);
+    }
+}
+
+/**
+ * Returns \c true if a batch of changes is in progress in the current thread
+ */
+bool DS_Config::batching() const {
+    return m_batchThread.loadAcquire() == QThread::currentThread();
+}
+
+/**
+ * Registers the given \a change. If a batch is in progress, the signals are
+ * emitted when the batch ends (and only if the value was \a modified).
+ * Otherwise, the signals of the value are emitted immediately.
+ */
+void DS_Config::notify (int change, bool modified) {
+    if (batching()) {
+        if (modified)
+            m_changes |= change;
+    }
+
+    else {
+        if (modified)
+            publish();
+
+        emitSignals (change, modified ? change : 0);
+    }
+}
+
+/**
+ * Publishes a new snapshot of the current values (see \c state())
+ */
+void DS_Config::publish() {
+    QMutexLocker locker (&m_stateMutex);
+
+    State state;
+    state.version = m_state.version() + 1;
+    state.team = m_team;
+    state.cpuUsage = m_cpuUsage;
+    state.ramUsage = m_ramUsage;
+    state.diskUsage = m_diskUsage;
+    state.canUsage = m_canUsage;
+    state.voltage = m_voltage;
+    state.simulated = m_simulated;
+    state.alliance = m_alliance;
+    state.position = m_position;
+    state.codeStatus = m_codeStatus;
+    state.controlMode = m_controlMode;
+    state.enableStatus = m_enableStatus;
+    state.voltageStatus = m_voltageStatus;
+    state.operationStatus = m_operationStatus;
+    state.fmsCommStatus = m_fmsCommStatus;
+    state.radioCommStatus = m_radioCommStatus;
+    state.robotCommStatus = m_robotCommStatus;
+
+    m_state.store (state);
+}
+
+/**
+ * Emits the signals of the given \a values (a combination of \c StateChange
+ * flags), followed by a \c stateChanged() signal with the given \a changes
+ */
+void DS_Config::emitSignals (int values, int changes) {
+    if (values & kTeamChanged)
+        emit teamChanged (m_team);
+    if (values & kAllianceChanged)
+        emit allianceChanged (m_alliance);
+    if (values & kPositionChanged)
+        emit positionChanged (m_position);
+    if (values & kVoltageChanged)
+        emit voltageChanged (m_voltage);
+    if (values & kSimulatedChanged)
+        emit simulatedChanged (m_simulated);
+    if (values & kCpuUsageChanged)
+        emit cpuUsageChanged (m_cpuUsage);
+    if (values & kRamUsageChanged)
+        emit ramUsageChanged (m_ramUsage);
+    if (values & kDiskUsageChanged)
+        emit diskUsageChanged (m_diskUsage);
+    if (values & kCanUsageChanged)
+        emit canUsageChanged (m_canUsage);
+    if (values & kLibVersionChanged)
+        emit libVersionChanged (m_libVersion);
+    if (values & kPcmVersionChanged)
+        emit pcmVersionChanged (m_pcmVersion);
+    if (values & kPdpVersionChanged)
+        emit pdpVersionChanged (m_pdpVersion);
+    if (values & kCodeStatusChanged)
+        emit codeStatusChanged (m_codeStatus);
+    if (values & kControlModeChanged)
+        emit controlModeChanged (m_controlMode);
+    if (values & kEnableStatusChanged)
+        emit enabledChanged (m_enableStatus);
+    if (values & kVoltageStatusChanged)
+        emit voltageStatusChanged (m_voltageStatus);
+    if (values & kOperationStatusChanged)
+        emit operationStatusChanged (m_operationStatus);
+    if (values & kFMSCommStatusChanged)
+        emit fmsCommStatusChanged (m_fmsCommStatus);
+    if (values & kRadioCommStatusChanged)
+        emit radioCommStatusChanged (m_radioCommStatus);
+    if (values & kRobotCommStatusChanged)
+        emit robotCommStatusChanged (m_robotCommStatus);
+
+    if (values & STATUS_CHANGES)
+        emit statusChanged (DriverStation::getInstance()->generalStatus());
+
+    if (changes != 0)
+        emit stateChanged (changes);
 }
 
 /**
@@ -577,5 +790,6 @@ void DS_Config::updateElapsedTime() {
                                  .arg (QString::number (msec).at (0)));
     }
 
+    updateVoltageString();
     DS_Schedule (100, this, SLOT (updateElapsedTime()));
 }
@@ -9,9 +9,13 @@
 #ifndef _LIB_DS_PRIVATE_CONFIG_H
 #define _LIB_DS_PRIVATE_CONFIG_H
 
+#include <QMutex>
+#include <QAtomicPointer>
 #include <Core/DS_Base.h>
+#include <Utilities/SeqLock.h>
 
 class Logger;
+class QThread;
 class QElapsedTimer;
 
 /**
@@ -24,18 +28,75 @@ class QElapsedTimer;
  * functions directly with each protocol, but this could increase memory usage
  * and - if not managed correctly - cause a lot of issues with the event system
  * of Qt.
+ *
+ * The changes made between a \c beginBatch() and an \c endBatch() call (for
+ * example, while a robot packet is interpreted) are reported together: each
+ * changed value emits its signal once and a single \c stateChanged() signal
+ * is emitted with every change, so that values that did not change do not
+ * generate any signal.
+ *
+ * A copy of every value is published as a \c State snapshot after each
+ * change (or batch of changes), which can be read from any thread without
+ * locks with the \c state() function.
  */
 class DS_Config : public DS_Base {
     Q_OBJECT
     friend class DriverStation;
 
   public:
+    /**
+     * \brief Consistent copy of the values of the DS and the robot
+     */
+    struct State {
+        quint32 version = 0;                          /**< Snapshot number */
+        int team = 0;                                 /**< Team number */
+        int cpuUsage = 0;                             /**< Robot CPU usage */
+        int ramUsage = 0;                             /**< Robot RAM usage */
+        int diskUsage = 0;                            /**< Robot disk usage */
+        int canUsage = 0;                             /**< Robot CAN usage */
+        qreal voltage = 0;                            /**< Robot voltage */
+        bool simulated = false;                       /**< Simulated robot */
+        Alliance alliance = kAllianceRed;             /**< Team alliance */
+        Position position = kPosition1;               /**< Team position */
+        CodeStatus codeStatus = kCodeFailing;         /**< Code status */
+        ControlMode controlMode = kControlTest;       /**< Control mode */
+        EnableStatus enableStatus = kDisabled;        /**< Enabled status */
+        VoltageStatus voltageStatus = kVoltageNormal; /**< Brownout status */
+        OperationStatus operationStatus = kNormal;    /**< E-stop status */
+        CommStatus fmsCommStatus = kCommsFailing;     /**< FMS comms */
+        CommStatus radioCommStatus = kCommsFailing;   /**< Radio comms */
+        CommStatus robotCommStatus = kCommsFailing;   /**< Robot comms */
+
+        bool isEnabled() const {
+            return enableStatus == kEnabled;
+        }
+
+        bool isFMSAttached() const {
+            return fmsCommStatus == kCommsWorking;
+        }
+
+        bool isEmergencyStopped() const {
+            return operationStatus == kEmergencyStop;
+        }
+
+        bool isConnectedToRadio() const {
+            return radioCommStatus == kCommsWorking;
+        }
+
+        bool isConnectedToRobot() const {
+            return robotCommStatus == kCommsWorking;
+        }
+    };
+
     static DS_Config* getInstance();
 
+    State state() const;
+
     int team() const;
     int cpuUsage() const;
     int ramUsage() const;
     int diskUsage() const;
+    int canUsage() const;
     qreal voltage() const;
     bool isEnabled() const;
     bool isSimulated() const;
@@ -58,6 +119,9 @@ class DS_Config : public DS_Base {
     VoltageStatus voltageStatus() const;
     OperationStatus operationStatus() const;
 
+    void beginBatch();
+    void endBatch();
+
   public slots:
     void updateTeam (int team);
     void setRobotCode (bool code);
@@ -65,6 +129,7 @@ class DS_Config : public DS_Base {
     void updateCpuUsage (int usage);
     void updateRamUsage (int usage);
     void updateDiskUsage (int usage);
+    void updateCanUsage (int usage);
     void setBrownout (bool brownout);
     void setEmergencyStop (bool estop);
     void updateVoltage (qreal voltage);
@@ -85,16 +150,24 @@ class DS_Config : public DS_Base {
 
   private slots:
     void updateElapsedTime();
+    void updateVoltageString();
 
   protected:
     DS_Config();
     Logger* logger();
 
+  private:
+    void publish();
+    bool batching() const;
+    void notify (int change, bool modified);
+    void emitSignals (int values, int changes);
+
   private:
     int m_team;
     int m_cpuUsage;
     int m_ramUsage;
     int m_diskUsage;
+    int m_canUsage;
     qreal m_voltage;
 
     Alliance m_alliance;
@@ -114,6 +187,16 @@ class DS_Config : public DS_Base {
     bool m_simulated;
     bool m_timerEnabled;
 
+    /* Only accessed by the thread that owns the batch mutex */
+    int m_changes;
+    int m_batchDepth;
+    QMutex m_batchMutex;
+    QAtomicPointer<QThread> m_batchThread;
+    QString m_voltageString;
+
+    QMutex m_stateMutex;
+    SeqLock<State> m_state;
+
     QElapsedTimer* m_timer;
     Logger* m_logger;
 };
@@ -7,22 +7,64 @@
  */
 
 #include <QDir>
+#include <QSaveFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QApplication>
 #include <QElapsedTimer>
 
 #include "Logger.h"
+#include "Utilities/LogReader.h"
+#include "Utilities/LogCompactor.h"
 
 /* Used for the custom message handler */
 #define PRINT_FMT "%-14s %-13s %-12s\n"
 #define PRINT(string) QString(string).toLocal8Bit().constData()
 #define GET_DATE_TIME(format) QDateTime::currentDateTime().toString(format)
 
-/* JSON logger keys */
+/* Log series IDs (equal to their index in the JSON log documents) */
+enum LogSeries {
+    kElapsedTime     = 0,
+    kCpuUsage        = 1,
+    kRamUsage        = 2,
+    kPacketLoss      = 3,
+    kVoltage         = 4,
+    kCodeStatus      = 5,
+    kControlMode     = 6,
+    kVoltageStatus   = 7,
+    kEnabledStatus   = 8,
+    kOperationStatus = 9,
+    kRadioCommStatus = 10,
+    kRobotCommStatus = 11,
+    kConsoleDump     = 12,
+    kNetConsole      = 13,
+    kRoundTripTime   = 14,
+    kLinkJitter      = 15,
+};
+
+/* History keys */
+const QString MIN = "min";
+const QString MAX = "max";
 const QString TIME = "t";
 const QString DATA = "d";
 
+/* Default log retention policy */
+const int MAX_LOG_AGE = 90;
+const qint64 MAX_LOGS_SIZE = 256 * 1024 * 1024;
+
+/* Manifest keys */
+const QString LOGS = "logs";
+const QString SIZE = "size";
+const QString INVALID = "invalid";
+const QString SUMMARY = "summary";
+const QString MODIFIED = "modified";
+const QString COMPACTED = "compacted";
+
+/* Console output batching policy */
+const int MAX_PENDING = 128;
+const int FLUSH_INTERVAL = 100;
+
 /**
  * Repeats the \a input string \a n times and returns the obtained string
  */
@@ -35,14 +77,86 @@ static QString REPEAT (QString input, int n) {
     return string;
 }
 
+/**
+ * Returns the manifest entry of the log file described by the given \a info
+ */
+static QJsonObject MANIFEST_ENTRY (const QFileInfo& info, bool compacted) {
+    QJsonObject entry;
+    entry.insert (SIZE, (double) info.size());
+    entry.insert (MODIFIED, (double) info.lastModified().toMSecsSinceEpoch());
+    entry.insert (COMPACTED, compacted);
+    return entry;
+}
+
+/**
+ * Generates the console line of the given \a message
+ */
+static QByteArray FORMAT_MESSAGE (qint64 time, QtMsgType type,
+                                  const QString& data) {
+    /* Get elapsed time */
+    qint64 msec = time;
+    qint64 secs = (msec / 1000);
+    qint64 mins = (secs / 60) % 60;
+
+    /* Get the remaining seconds and milliseconds */
+    secs = secs % 60;
+    msec = msec % 1000;
+
+    /* Get warning level */
+    const char* level;
+    switch (type) {
+    case QtDebugMsg:
+        level = "DEBUG";
+        break;
+    case QtWarningMsg:
+        level = "WARNING";
+        break;
+    case QtCriticalMsg:
+        level = "CRITICAL";
+        break;
+    case QtFatalMsg:
+        level = "FATAL";
+        break;
+    default:
+        level = "SYSTEM";
+        break;
+    }
+
+    /* Format elapsed time and level */
+    char elapsed [32];
+    char prefix [64];
+    qsnprintf (elapsed, sizeof (elapsed), "%02d:%02d.%d",
+               (int) mins, (int) secs, (int) (msec / 100));
+    qsnprintf (prefix, sizeof (prefix), "%-14s %-13s ", elapsed, level);
+
+    QByteArray line (prefix);
+    line.append (data.leftJustified (12).toLocal8Bit());
+    line.append ('\n');
+    return line;
+}
+
 Logger::Logger() {
     m_dump = Q_NULLPTR;
+    m_dumpOffset = 0;
     m_timer = new QElapsedTimer;
 
+    /* Only numeric series have a history (not the elapsed time or texts) */
+    for (int i = kCpuUsage; i <= kLinkJitter; ++i) {
+        if (i != kConsoleDump && i != kNetConsole)
+            m_history.insert (i, TimeSeries());
+    }
+
+    m_previousRtt = -1;
+    m_previousJitter = -1;
+
     m_closed = false;
     m_initialized = false;
+    m_manifestLoaded = false;
     m_eventsRegistered = false;
 
+    m_maxLogAge = MAX_LOG_AGE;
+    m_maxLogsSize = MAX_LOGS_SIZE;
+
     m_timer->start();
     m_logFilePath = logsPath() + "/"
                     + GET_DATE_TIME ("yyyy_MM_dd hh_mm_ss ddd")
@@ -72,22 +186,43 @@ QString Logger::extension() const {
 }
 
 /**
- * Returns a list with all the logs that have been created locally
+ * Returns a list with all the logs that have been created locally. The list
+ * is obtained from the log manifest, the logs directory is only scanned once.
  */
-QStringList Logger::availableLogs() const {
-    QString filter = "*." + extension();
-    return QDir (logsPath()).entryList (QStringList (filter));
+QStringList Logger::availableLogs() {
+    QMutexLocker locker (&m_manifestMutex);
+    if (!m_manifestLoaded)
+        loadManifest();
+
+    return m_manifest.keys();
 }
 
 /**
- * Opens the given log \a file and parses its JSON data
+ * Returns the summary of the given log (duration, voltage, packet loss, CPU
+ * and RAM usage statistics), which is generated when the log is compacted
+ */
+QJsonObject Logger::logSummary (const QString& name) {
+    QMutexLocker locker (&m_manifestMutex);
+    if (!m_manifestLoaded)
+        loadManifest();
+
+    return m_manifest.value (name).toObject().value (SUMMARY).toObject();
+}
+
+/**
+ * Opens the given log \a file and parses its data. Both binary logs and the
+ * legacy JSON logs are supported.
  */
 QJsonDocument Logger::openLog (const QString& name) const {
     QFile file (name);
     QJsonDocument document;
 
     if (file.open (QFile::ReadOnly)) {
-        document = QJsonDocument::fromJson (file.readAll());
+        if (LogReader::isBinaryLog (file.peek (LogWriter::MAGIC_SIZE)))
+            document = LogReader::read (name);
+        else
+            document = QJsonDocument::fromJson (file.readAll());
+
         file.close();
     }
 
@@ -95,8 +230,50 @@ QJsonDocument Logger::openLog (const QString& name) const {
 }
 
 /**
- * Writes the message output to the console and to the dump file (which is
- * dumped on the DS log file when the application exits).
+ * Returns the recent history of the given numeric event \a series (the series
+ * are identified by their index in the JSON log documents) with the given
+ * \a resolution (see \c TimeSeries::Resolution). Each element of the list
+ * has the time (t), average value (d), minimum and maximum values. The
+ * elapsed time and the text series have no history.
+ *
+ * The history uses a fixed amount of memory, so the oldest values of each
+ * resolution are discarded as the application runs.
+ */
+QVariantList Logger::history (int series, int resolution) {
+    QVariantList list;
+    if (!m_history.contains (series))
+        return list;
+
+    if (resolution < TimeSeries::kRaw || resolution > TimeSeries::kMinutes)
+        return list;
+
+    QVector<TimeSeries::Bucket> buckets;
+    {
+        QMutexLocker locker (&m_mutex);
+        buckets = m_history.constFind (series)->buckets (
+                      (TimeSeries::Resolution) resolution);
+    }
+
+    foreach (const TimeSeries::Bucket& bucket, buckets) {
+        QVariantMap map;
+        map.insert (TIME, bucket.time);
+        map.insert (DATA, bucket.average());
+        map.insert (MIN, bucket.min);
+        map.insert (MAX, bucket.max);
+        list.append (map);
+    }
+
+    return list;
+}
+
+/**
+ * Queues the message output, which is written to the console and to the dump
+ * file (which is dumped on the DS log file) by the logger thread. Calling
+ * this function only costs a queue push, so that logging in the networking
+ * code does not block on the console or disk.
+ *
+ * \note Fatal messages are written immediately, since the application is
+ *       aborted after this function returns
  */
 void Logger::messageHandler (QtMsgType type,
                              const QMessageLogContext& context,
@@ -107,193 +284,70 @@ void Logger::messageHandler (QtMsgType type,
     if (m_closed) return;
     if (!m_initialized) initializeLogger();
 
-    /* Get elapsed time */
-    quint32 msec = m_timer->elapsed();
-    quint32 secs = (msec / 1000);
-    quint32 mins = (secs / 60) % 60;
-
-    /* Get the remaining seconds and milliseconds */
-    secs = secs % 60;
-    msec = msec % 1000;
-
-    /* Get current time */
-    QString time = (QString ("%1:%2.%3")
-                    .arg (mins, 2, 10, QLatin1Char ('0'))
-                    .arg (secs, 2, 10, QLatin1Char ('0'))
-                    .arg (QString::number (msec).at (0)));
-
-    /* Get warning level */
-    QString level;
-    switch (type) {
-    case QtDebugMsg:
-        level = "DEBUG";
-        break;
-    case QtWarningMsg:
-        level = "WARNING";
-        break;
-    case QtCriticalMsg:
-        level = "CRITICAL";
-        break;
-    case QtFatalMsg:
-        level = "FATAL";
-        break;
-    default:
-        level = "SYSTEM";
-        break;
-    }
-
-    /* Write all logs to the dump file */
-    fprintf (m_dump, PRINT_FMT, PRINT (time), PRINT (level), PRINT (data));
-    fprintf (stderr, PRINT_FMT, PRINT (time), PRINT (level), PRINT (data));
-
-    /* Flush to write "instantly" */
-    fflush (m_dump);
+    /* Queue the message */
+    Message message;
+    message.type = type;
+    message.data = data;
+    message.time = m_timer->elapsed();
+    m_messages.push (message);
+    int pending = m_pendingMessages.fetchAndAddRelaxed (1) + 1;
+
+    /* Application will be aborted, write everything now */
+    if (type == QtFatalMsg)
+        writeMessages();
+
+    /* Too many messages are waiting, do not wait for the next flush */
+    else if (pending == MAX_PENDING)
+        QMetaObject::invokeMethod (this, "writeMessages",
+                                   Qt::QueuedConnection);
 }
 
 /**
- * Saves the robot events and the application logs into a compact JSON file.
+ * Writes the robot events and the application logs registered since the last
+ * call to this function to the log file. Only the new data is written, so
+ * saving the logs takes the same time, no matter how long the log already is.
  * This file can later be used by teams to diagnostic their robots or by the
  * LibDS developers to fix an issue.
  */
 void Logger::saveLogs() {
-    /* Register voltage values */
-    QVariantList voltageList;
-    for (int i = 0; i < m_voltage.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_voltage.at (i).first);
-        map.insert (DATA, m_voltage.at (i).second);
-        voltageList.append (map);
-    }
-
-    /* Register CPU usages */
-    QVariantList cpuList;
-    for (int i = 0; i < m_cpuUsage.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_cpuUsage.at (i).first);
-        map.insert (DATA, m_cpuUsage.at (i).second);
-        cpuList.append (map);
-    }
-
-    /* Register RAM usages */
-    QVariantList ramList;
-    for (int i = 0; i < m_ramUsage.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_ramUsage.at (i).first);
-        map.insert (DATA, m_ramUsage.at (i).second);
-        ramList.append (map);
-    }
+    /* Logs were already closed */
+    if (m_closed)
+        return;
 
-    /* Register packet loss */
-    QVariantList pktList;
-    for (int i = 0; i < m_pktLoss.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_pktLoss.at (i).first);
-        map.insert (DATA, m_pktLoss.at (i).second);
-        pktList.append (map);
-    }
-
-    /* Register code status */
-    QVariantList codeStatusList;
-    for (int i = 0; i < m_codeStatus.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_codeStatus.at (i).first);
-        map.insert (DATA, m_codeStatus.at (i).second);
-        codeStatusList.append (map);
-    }
-
-    /* Register control modes */
-    QVariantList controlModeList;
-    for (int i = 0; i < m_controlMode.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_controlMode.at (i).first);
-        map.insert (DATA, m_controlMode.at (i).second);
-        controlModeList.append (map);
-    }
+    /* Get the new application logs */
+    QByteArray dump;
+    QFile logs (m_dumpFilePath);
+    if (logs.open (QFile::ReadOnly)) {
+        if (logs.size() > m_dumpOffset && logs.seek (m_dumpOffset)) {
+            dump = logs.readAll();
+            m_dumpOffset += dump.size();
+        }
 
-    /* Register voltage status */
-    QVariantList voltageStatusList;
-    for (int i = 0; i < m_voltageStatus.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_voltageStatus.at (i).first);
-        map.insert (DATA, m_voltageStatus.at (i).second);
-        voltageStatusList.append (map);
+        logs.close();
     }
 
-    /* Register enabled status */
-    QVariantList enabledStatusList;
-    for (int i = 0; i < m_enabledStatus.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_enabledStatus.at (i).first);
-        map.insert (DATA, m_enabledStatus.at (i).second);;
-        enabledStatusList.append (map);
-    }
+    /* Append new data to the log file */
+    bool saved = false;
+    {
+        QMutexLocker locker (&m_mutex);
+        qint64 time = m_timer->elapsed();
 
-    /* Register operation status */
-    QVariantList operationStatusList;
-    for (int i = 0; i < m_operationStatus.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_operationStatus.at (i).first);
-        map.insert (DATA, m_operationStatus.at (i).second);
-        operationStatusList.append (map);
-    }
+        if (!dump.isEmpty())
+            m_writer.append (kConsoleDump, time, dump);
 
-    /* Register radio comm. status */
-    QVariantList radioCommStatusList;
-    for (int i = 0; i < m_radioCommStatus.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_radioCommStatus.at (i).first);
-        map.insert (DATA, m_radioCommStatus.at (i).second);
-        radioCommStatusList.append (map);
-    }
+        m_writer.append (kElapsedTime, time, time);
 
-    /* Register robot comm. status */
-    QVariantList robotCommStatusList;
-    for (int i = 0; i < m_robotCommStatus.count(); ++i) {
-        QVariantMap map;
-        map.insert (TIME, m_robotCommStatus.at (i).first);
-        map.insert (DATA, m_robotCommStatus.at (i).second);
-        robotCommStatusList.append (map);
-    }
+        if (!m_writer.isOpen())
+            m_writer.open (m_logFilePath);
 
-    /* Serialize event data */
-    QJsonArray array;
-    QJsonDocument document;
-    array.append (QJsonValue::fromVariant (m_timer->elapsed()));
-    array.append (QJsonValue::fromVariant (cpuList));
-    array.append (QJsonValue::fromVariant (ramList));
-    array.append (QJsonValue::fromVariant (pktList));
-    array.append (QJsonValue::fromVariant (voltageList));
-    array.append (QJsonValue::fromVariant (codeStatusList));
-    array.append (QJsonValue::fromVariant (controlModeList));
-    array.append (QJsonValue::fromVariant (voltageStatusList));
-    array.append (QJsonValue::fromVariant (enabledStatusList));
-    array.append (QJsonValue::fromVariant (operationStatusList));
-    array.append (QJsonValue::fromVariant (radioCommStatusList));
-    array.append (QJsonValue::fromVariant (robotCommStatusList));
-
-    /* Add application logs to JSON */
-    QFile logs (m_dumpFilePath);
-    if (logs.open (QFile::ReadOnly)) {
-        array.append (QJsonValue::fromVariant (logs.readAll()));
-        logs.close();
+        saved = m_writer.flush();
     }
 
-    /* Add NetConsole input to JSON */
-    array.append (QJsonValue::fromVariant (m_netConsole));
-
-    /* Save JSON document to disk */
-    document.setArray (array);
-    QFile file (m_logFilePath);
-    if (file.open (QFile::WriteOnly)) {
-        file.write (document.toJson (QJsonDocument::Compact));
-        file.close();
-
+    if (saved)
         emit logsSaved (m_logFilePath);
-    }
 
-    /* Overwrite log in one second */
-    if (!m_closed)
-        DS_Schedule (1000, this, SLOT (saveLogs()));
+    /* Save new data in one second */
+    DS_Schedule (1000, this, SLOT (saveLogs()));
 }
 
 /**
@@ -303,14 +357,54 @@ void Logger::closeLogs() {
     if (m_dump && m_initialized && !m_closed) {
         qDebug() << "Log buffer closed";
 
+        writeMessages();
         saveLogs();
-        fclose (m_dump);
+
+        {
+            QMutexLocker locker (&m_dumpMutex);
+            if (m_dump != stderr)
+                fclose (m_dump);
+
+            m_dump = Q_NULLPTR;
+        }
+
+        {
+            QMutexLocker locker (&m_mutex);
+            m_writer.close();
+        }
+
+        /* Register the final size of the log */
+        QMutexLocker locker (&m_manifestMutex);
+        if (m_manifestLoaded) {
+            QFileInfo info (m_logFilePath);
+            m_manifest.insert (info.fileName(), MANIFEST_ENTRY (info, false));
+            saveManifest();
+        }
 
         m_closed = true;
         m_initialized = false;
     }
 }
 
+/**
+ * Changes the maximum age (in days) of the saved logs, older logs are removed
+ * by the compaction job. A value of \c 0 disables this limit.
+ */
+void Logger::setMaximumLogAge (int days) {
+    QMutexLocker locker (&m_manifestMutex);
+    m_maxLogAge = qMax (days, 0);
+}
+
+/**
+ * Changes the maximum size (in bytes) of the logs directory, the oldest logs
+ * are removed by the compaction job until the logs fit in the given size.
+ * A value of \c 0 disables this limit.
+ */
+void Logger::setMaximumLogsSize (qint64 bytes) {
+    QMutexLocker locker (&m_manifestMutex);
+    m_maxLogsSize = qMax (bytes, (qint64) 0);
+}
+
 /**
  * Registers the inital robot events in the event lists
  */
@@ -320,6 +414,8 @@ void Logger::registerInitialEvents() {
 
         registerVoltage (0);
         registerPacketLoss (0);
+        registerLinkJitter (0);
+        registerRoundTripTime (0);
         registerRobotRAMUsage (0);
         registerRobotCPUUsage (0);
         registerAlliance (DS::kAllianceRed);
@@ -339,9 +435,13 @@ void Logger::registerInitialEvents() {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerVoltage (qreal voltage) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousVoltage != voltage) {
         m_previousVoltage = voltage;
-        m_voltage.append (qMakePair (m_timer->elapsed(), voltage));
+        qint64 time = m_timer->elapsed();
+
+        m_writer.append (kVoltage, time, voltage);
+        m_history [kVoltage].append (time, voltage);
     }
 }
 
@@ -351,9 +451,10 @@ void Logger::registerVoltage (qreal voltage) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerPacketLoss (int pktLoss) {
+    QMutexLocker locker (&m_mutex);
     if (pktLoss != m_previousLoss) {
         m_previousLoss = pktLoss;
-        m_pktLoss.append (qMakePair (m_timer->elapsed(), pktLoss));
+        appendEvent (kPacketLoss, pktLoss);
     }
 }
 
@@ -363,9 +464,10 @@ void Logger::registerPacketLoss (int pktLoss) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerRobotRAMUsage (int usage) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousRAM != usage) {
         m_previousRAM = usage;
-        m_ramUsage.append (qMakePair (m_timer->elapsed(), usage));
+        appendEvent (kRamUsage, usage);
     }
 }
 
@@ -375,9 +477,44 @@ void Logger::registerRobotRAMUsage (int usage) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerRobotCPUUsage (int usage) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousCPU != usage) {
         m_previousCPU = usage;
-        m_cpuUsage.append (qMakePair (m_timer->elapsed(), usage));
+        appendEvent (kCpuUsage, usage);
+    }
+}
+
+/**
+ * Registers the given robot link \a jitter (in milliseconds) to the robot
+ * events log.
+ * \note This value will only be registered if the given data is different
+ *       from the data registered earlier (to avoid creating huge log files)
+ */
+void Logger::registerLinkJitter (qreal jitter) {
+    QMutexLocker locker (&m_mutex);
+    if (m_previousJitter != jitter) {
+        m_previousJitter = jitter;
+        qint64 time = m_timer->elapsed();
+
+        m_writer.append (kLinkJitter, time, jitter);
+        m_history [kLinkJitter].append (time, jitter);
+    }
+}
+
+/**
+ * Registers the given median round-trip time (in milliseconds) of the robot
+ * link to the robot events log.
+ * \note This value will only be registered if the given data is different
+ *       from the data registered earlier (to avoid creating huge log files)
+ */
+void Logger::registerRoundTripTime (qreal rtt) {
+    QMutexLocker locker (&m_mutex);
+    if (m_previousRtt != rtt) {
+        m_previousRtt = rtt;
+        qint64 time = m_timer->elapsed();
+
+        m_writer.append (kRoundTripTime, time, rtt);
+        m_history [kRoundTripTime].append (time, rtt);
     }
 }
 
@@ -401,9 +538,10 @@ void Logger::registerPosition (DS::Position position) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerControlMode (DS::ControlMode mode) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousControlMode != mode) {
         m_previousControlMode = mode;
-        m_controlMode.append (qMakePair (m_timer->elapsed(), mode));
+        appendEvent (kControlMode, mode);
         qDebug() << "Robot control mode set to" << mode;
     }
 }
@@ -414,9 +552,10 @@ void Logger::registerControlMode (DS::ControlMode mode) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerCodeStatus (DS::CodeStatus status) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousCodeStatus != status) {
         m_previousCodeStatus = status;
-        m_codeStatus.append (qMakePair (m_timer->elapsed(), status));
+        appendEvent (kCodeStatus, status);
         qDebug() << "Robot code status set to" << status;
     }
 }
@@ -427,9 +566,10 @@ void Logger::registerCodeStatus (DS::CodeStatus status) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerEnableStatus (DS::EnableStatus status) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousEnabledStatus != status) {
         m_previousEnabledStatus = status;
-        m_enabledStatus.append (qMakePair (m_timer->elapsed(), status));
+        appendEvent (kEnabledStatus, status);
         qDebug() << "Robot enabled status set to" << status;
     }
 }
@@ -440,9 +580,10 @@ void Logger::registerEnableStatus (DS::EnableStatus status) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerRadioCommStatus (DS::CommStatus status) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousRadioCommStatus != status) {
         m_previousRadioCommStatus = status;
-        m_radioCommStatus.append (qMakePair (m_timer->elapsed(), status));
+        appendEvent (kRadioCommStatus, status);
         qDebug() << "Radio communication status set to" << status;
     }
 }
@@ -453,9 +594,10 @@ void Logger::registerRadioCommStatus (DS::CommStatus status) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerRobotCommStatus (DS::CommStatus status) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousRobotCommStatus != status) {
         m_previousRobotCommStatus = status;
-        m_robotCommStatus.append (qMakePair (m_timer->elapsed(), status));
+        appendEvent (kRobotCommStatus, status);
         qDebug() << "Robot communication status set to" << status;
     }
 }
@@ -466,9 +608,10 @@ void Logger::registerRobotCommStatus (DS::CommStatus status) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerVoltageStatus (DS::VoltageStatus status) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousVoltageStatus != status) {
         m_previousVoltageStatus = status;
-        m_voltageStatus.append (qMakePair (m_timer->elapsed(), status));
+        appendEvent (kVoltageStatus, status);
         qDebug() << "Robot voltage status set to" << status;
     }
 }
@@ -477,7 +620,8 @@ void Logger::registerVoltageStatus (DS::VoltageStatus status) {
  * Appends the given \a message to the NetConsole log
  */
 void Logger::registerNetConsoleMessage (const QString& message) {
-    m_netConsole.append (message);
+    QMutexLocker locker (&m_mutex);
+    m_writer.append (kNetConsole, m_timer->elapsed(), message.toUtf8());
 }
 
 /**
@@ -486,13 +630,216 @@ void Logger::registerNetConsoleMessage (const QString& message) {
  *       from the data registered earlier (to avoid creating huge log files)
  */
 void Logger::registerOperationStatus (DS::OperationStatus status) {
+    QMutexLocker locker (&m_mutex);
     if (m_previousOperationStatus != status) {
         m_previousOperationStatus = status;
-        m_operationStatus.append (qMakePair (m_timer->elapsed(), status));
+        appendEvent (kOperationStatus, status);
         qDebug() << "Radio operation status set to" << status;
     }
 }
 
+/**
+ * Reads the manifest of the logs directory and updates it with the logs that
+ * were created or modified since it was saved. This is the only time in
+ * which the logs directory is scanned.
+ *
+ * \note The manifest mutex must be locked before calling this function
+ */
+void Logger::loadManifest() {
+    QJsonObject saved;
+    QFile file (logsPath() + "/manifest.json");
+    if (file.open (QFile::ReadOnly)) {
+        saved = QJsonDocument::fromJson (file.readAll()).object();
+        saved = saved.value (LOGS).toObject();
+        file.close();
+    }
+
+    /* Register the logs that were not compacted */
+    QDir dir (logsPath());
+    QStringList filter = QStringList ("*." + extension());
+    foreach (const QFileInfo& info, dir.entryInfoList (filter, QDir::Files)) {
+        QJsonObject entry = saved.value (info.fileName()).toObject();
+        if (entry.value (SIZE).toDouble() != info.size())
+            entry = MANIFEST_ENTRY (info, false);
+
+        m_manifest.insert (info.fileName(), entry);
+    }
+
+    /* Register the current log (if it was not created yet) */
+    QString current = QFileInfo (m_logFilePath).fileName();
+    if (!m_manifest.contains (current)) {
+        QJsonObject entry;
+        entry.insert (COMPACTED, false);
+        m_manifest.insert (current, entry);
+    }
+
+    m_manifestLoaded = true;
+}
+
+/**
+ * Writes the manifest of the logs directory to disk
+ *
+ * \note The manifest mutex must be locked before calling this function
+ */
+void Logger::saveManifest() {
+    QJsonObject object;
+    object.insert (LOGS, m_manifest);
+
+    QSaveFile file (logsPath() + "/manifest.json");
+    if (file.open (QFile::WriteOnly)) {
+        file.write (QJsonDocument (object).toJson());
+        file.commit();
+    }
+}
+
+/**
+ * Removes the logs that are older than the maximum log age, and then the
+ * oldest logs until the logs directory fits in the maximum size. The current
+ * log is never removed.
+ *
+ * \note The manifest mutex must be locked before calling this function
+ */
+void Logger::applyRetentionPolicy() {
+    qint64 total = 0;
+    foreach (const QJsonValue& entry, m_manifest)
+        total += (qint64) entry.toObject().value (SIZE).toDouble();
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 maxAge = (qint64) m_maxLogAge * 24 * 60 * 60 * 1000;
+    QString current = QFileInfo (m_logFilePath).fileName();
+
+    /* Log names begin with their date, so the oldest logs are first */
+    foreach (const QString& name, m_manifest.keys()) {
+        if (name == current)
+            continue;
+
+        QJsonObject entry = m_manifest.value (name).toObject();
+        qint64 size = (qint64) entry.value (SIZE).toDouble();
+        qint64 modified = (qint64) entry.value (MODIFIED).toDouble();
+
+        bool expired = m_maxLogAge > 0 && (now - modified) > maxAge;
+        bool overflow = m_maxLogsSize > 0 && total > m_maxLogsSize;
+        if (!expired && !overflow)
+            continue;
+
+        QString path = logsPath() + "/" + name;
+        if (QFile::remove (path) || !QFile::exists (path)) {
+            total -= size;
+            m_manifest.remove (name);
+        }
+    }
+}
+
+/**
+ * Appends the given event \a value to the given log \a series and to its
+ * recent history
+ *
+ * \note The writer mutex must be locked before calling this function
+ */
+void Logger::appendEvent (int series, qint64 value) {
+    qint64 time = m_timer->elapsed();
+    m_writer.append (series, time, value);
+    m_history [series].append (time, value);
+}
+
+/**
+ * Compacts the next finished log (see \c LogCompactor) and registers its
+ * summary in the manifest. Only one log is compacted per call, so that the
+ * logger thread can save the current log between them. When every log is
+ * compacted, the retention policy is applied.
+ */
+void Logger::compactLogs() {
+    QString name;
+    QString current = QFileInfo (m_logFilePath).fileName();
+
+    /* Find the next log to compact */
+    {
+        QMutexLocker locker (&m_manifestMutex);
+        if (!m_manifestLoaded)
+            loadManifest();
+
+        foreach (const QString& log, m_manifest.keys()) {
+            QJsonObject entry = m_manifest.value (log).toObject();
+            if (log != current && !entry.value (COMPACTED).toBool()
+                    && !entry.value (INVALID).toBool()) {
+                name = log;
+                break;
+            }
+        }
+
+        /* Every log is compacted, remove old logs */
+        if (name.isEmpty()) {
+            applyRetentionPolicy();
+            saveManifest();
+            return;
+        }
+    }
+
+    /* Compact the log and register its summary */
+    QString path = logsPath() + "/" + name;
+    QJsonObject summary = LogCompactor::compact (path);
+
+    {
+        QMutexLocker locker (&m_manifestMutex);
+        QFileInfo info (path);
+        QJsonObject entry = MANIFEST_ENTRY (info, !summary.isEmpty());
+        entry.insert (SUMMARY, summary);
+
+        if (summary.isEmpty())
+            entry.insert (INVALID, true);
+
+        if (info.exists())
+            m_manifest.insert (name, entry);
+        else
+            m_manifest.remove (name);
+    }
+
+    DS_Schedule (0, this, SLOT (compactLogs()));
+}
+
+/**
+ * Writes all the queued messages to the console and to the dump file with a
+ * single write call for each one of them.
+ *
+ * \note This function is usually called by the logger thread, but it can be
+ *       called by any thread (e.g. when a fatal message is received)
+ */
+void Logger::writeMessages() {
+    QMutexLocker locker (&m_dumpMutex);
+
+    int count = 0;
+    Message message;
+    QByteArray batch;
+    while (m_messages.pop (&message)) {
+        batch.append (FORMAT_MESSAGE (message.time,
+                                      message.type,
+                                      message.data));
+        ++count;
+    }
+
+    if (count > 0) {
+        m_pendingMessages.fetchAndAddRelaxed (-count);
+
+        if (m_dump) {
+            fwrite (batch.constData(), 1, batch.size(), m_dump);
+            fflush (m_dump);
+        }
+
+        if (m_dump != stderr)
+            fwrite (batch.constData(), 1, batch.size(), stderr);
+    }
+}
+
+/**
+ * Writes the queued messages and schedules the next write
+ */
+void Logger::flushMessages() {
+    writeMessages();
+
+    if (!m_closed)
+        DS_Schedule (FLUSH_INTERVAL, this, SLOT (flushMessages()));
+}
+
 /**
  * Creates the temporary console dump file and sets the file name of the final
  * DS log file.
@@ -550,4 +897,10 @@ void Logger::initializeLogger() {
     fprintf (m_dump, "%s\n", PRINT (REPEAT ("-", 72)));
     fprintf (m_dump, PRINT_FMT, "ELAPSED TIME", "ERROR LEVEL", "MESSAGE");
     fprintf (m_dump, "%s\n", PRINT (REPEAT ("-", 72)));
+
+    /* Write the console output periodically in the logger thread */
+    QMetaObject::invokeMethod (this, "flushMessages", Qt::QueuedConnection);
+
+    /* Compact the logs of previous sessions in the logger thread */
+    QMetaObject::invokeMethod (this, "compactLogs", Qt::QueuedConnection);
 }
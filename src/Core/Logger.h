@@ -9,7 +9,13 @@
 #ifndef _LIB_DS_ROBOT_LOGGER_H
 #define _LIB_DS_ROBOT_LOGGER_H
 
+#include <QMap>
+#include <QMutex>
+#include <QJsonObject>
 #include <Core/DS_Common.h>
+#include <Utilities/LogWriter.h>
+#include <Utilities/MPSCQueue.h>
+#include <Utilities/TimeSeries.h>
 
 class QElapsedTimer;
 
@@ -30,8 +36,10 @@ class Logger : public QObject {
 
     QString logsPath() const;
     QString extension() const;
-    QStringList availableLogs() const;
+    QStringList availableLogs();
+    QJsonObject logSummary (const QString& name);
     QJsonDocument openLog (const QString& name) const;
+    QVariantList history (int series, int resolution);
 
     void messageHandler (QtMsgType type,
                          const QMessageLogContext& context,
@@ -40,11 +48,15 @@ class Logger : public QObject {
   public slots:
     void saveLogs();
     void closeLogs();
+    void setMaximumLogAge (int days);
+    void setMaximumLogsSize (qint64 bytes);
     void registerInitialEvents();
     void registerVoltage (qreal voltage);
     void registerPacketLoss (int pktLoss);
     void registerRobotRAMUsage (int usage);
     void registerRobotCPUUsage (int usage);
+    void registerLinkJitter (qreal jitter);
+    void registerRoundTripTime (qreal rtt);
     void registerAlliance (DS::Alliance alliance);
     void registerPosition (DS::Position position);
     void registerControlMode (DS::ControlMode mode);
@@ -57,24 +69,46 @@ class Logger : public QObject {
     void registerOperationStatus (DS::OperationStatus status);
 
   private slots:
+    void compactLogs();
+    void writeMessages();
+    void flushMessages();
     void initializeLogger();
 
   private:
-    QString m_netConsole;
+    struct Message {
+        qint64 time;
+        QtMsgType type;
+        QString data;
+    };
+
+    void loadManifest();
+    void saveManifest();
+    void applyRetentionPolicy();
+    void appendEvent (int series, qint64 value);
+
+  private:
     QElapsedTimer* m_timer;
     bool m_eventsRegistered;
 
     /* Used for console output (both to stderr and a dump file) */
     FILE* m_dump;
+    QMutex m_dumpMutex;
+    QAtomicInt m_pendingMessages;
+    MPSCQueue<Message> m_messages;
     bool m_closed;
     bool m_initialized;
     QString m_logFilePath;
     QString m_dumpFilePath;
+    qint64 m_dumpOffset;
 
-    /* Registers previous event data (to avoid creating huge logs) */
+    /* Registers previous event data (to avoid creating huge logs), the
+     * register functions are called by several threads, so this data is
+     * guarded by the writer mutex */
     int m_previousRAM;
     int m_previousCPU;
     int m_previousLoss;
+    qreal m_previousRtt;
+    qreal m_previousJitter;
     qreal m_previousVoltage;
     DS::CodeStatus m_previousCodeStatus;
     DS::ControlMode m_previousControlMode;
@@ -84,18 +118,17 @@ class Logger : public QObject {
     DS::VoltageStatus m_previousVoltageStatus;
     DS::OperationStatus m_previousOperationStatus;
 
-    /* These lists hold the information of each event */
-    QList<QPair<qint64, int>> m_pktLoss;
-    QList<QPair<qint64, int>> m_ramUsage;
-    QList<QPair<qint64, int>> m_cpuUsage;
-    QList<QPair<qint64, qreal>> m_voltage;
-    QList<QPair<qint64, DS::CodeStatus>> m_codeStatus;
-    QList<QPair<qint64, DS::ControlMode>> m_controlMode;
-    QList<QPair<qint64, DS::CommStatus>> m_radioCommStatus;
-    QList<QPair<qint64, DS::CommStatus>> m_robotCommStatus;
-    QList<QPair<qint64, DS::EnableStatus>> m_enabledStatus;
-    QList<QPair<qint64, DS::VoltageStatus>> m_voltageStatus;
-    QList<QPair<qint64, DS::OperationStatus>> m_operationStatus;
+    /* Writes the events to the log file, shared with the DS threads */
+    QMutex m_mutex;
+    LogWriter m_writer;
+    QMap<int, TimeSeries> m_history;
+
+    /* Summary of the saved logs, shared with the DS threads */
+    int m_maxLogAge;
+    qint64 m_maxLogsSize;
+    bool m_manifestLoaded;
+    QJsonObject m_manifest;
+    QMutex m_manifestMutex;
 };
 
 #endif
@@ -12,7 +12,10 @@
 NetConsole::NetConsole() {
     m_outputPort = 0;
     connect (&m_inputSocket, &QUdpSocket::readyRead, [ = ]() {
-        emit newMessage (QString::fromUtf8 (DS::readSocket (&m_inputSocket)));
+        while (m_inputSocket.hasPendingDatagrams()) {
+            QByteArray data = DS::readSocket (&m_inputSocket);
+            emit newMessage (QString::fromUtf8 (data));
+        }
     });
 }
 
@@ -10,8 +10,11 @@
 #define _LIB_DS_PROTOCOL_H
 
 #include <QtMath>
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <DriverStation.h>
 #include <Core/DS_Config.h>
+#include <Utilities/LinkStatistics.h>
 
 /**
  * \brief Base class for implementing communication protocols
@@ -22,15 +25,17 @@
 class Protocol {
   public:
     explicit Protocol() {
-        m_sentFmsPackets = 0;
-        m_sentRadioPackets = 0;
-        m_sentRobotPackets = 0;
-        m_receivedFmsPackets = 0;
-        m_receivedRadioPackets = 0;
-        m_receivedRobotPackets = 0;
+        m_sentFmsPackets.store (0);
+        m_sentRadioPackets.store (0);
+        m_sentRobotPackets.store (0);
+        m_receivedFmsPackets.store (0);
+        m_receivedRadioPackets.store (0);
+        m_receivedRobotPackets.store (0);
 
-        m_recvRobotPacketsSinceConnect = 0;
-        m_sentRobotPacketsSinceConnect = 0;
+        m_recvRobotPacketsSinceConnect.store (0);
+        m_sentRobotPacketsSinceConnect.store (0);
+
+        m_clock.start();
     }
 
     /**
@@ -314,7 +319,8 @@ class Protocol {
      * packet using the protocol implementation code.
      */
     QByteArray generateFMSPacket() {
-        ++m_sentFmsPackets;
+        m_sentFmsPackets.ref();
+        m_state = config()->state();
         return getFMSPacket();
     }
 
@@ -323,7 +329,8 @@ class Protocol {
      * packet using the protocol implementation code.
      */
     QByteArray generateRadioPacket() {
-        ++m_sentRadioPackets;
+        m_sentRadioPackets.ref();
+        m_state = config()->state();
         return getRadioPacket();
     }
 
@@ -332,59 +339,79 @@ class Protocol {
      * packet using the protocol implementation code.
      */
     QByteArray generateRobotPacket() {
-        ++m_sentRobotPackets;
-        ++m_sentRobotPacketsSinceConnect;
+        m_sentRobotPackets.ref();
+        m_sentRobotPacketsSinceConnect.ref();
 
+        m_robotLink.registerSent (m_sentRobotPackets.load() & 0xffff,
+                                 timestamp());
+        m_state = config()->state();
         return getRobotPacket();
     }
 
     /**
      * Lets the protocol implementation interpret the given \a data and updates
      * the received FMS packets counter.
+     *
+     * The changes caused by the packet are reported together when the packet
+     * has been interpreted (see \c DS_Config::beginBatch()).
      */
     bool readFMSPacket (const QByteArray& data) {
-        ++m_receivedFmsPackets;
+        m_receivedFmsPackets.ref();
 
-        if (interpretFMSPacket (data)) {
+        config()->beginBatch();
+        bool valid = interpretFMSPacket (data);
+        if (valid)
             config()->updateFMSCommStatus (DS::kCommsWorking);
-            return true;
-        }
 
-        return false;
+        config()->endBatch();
+        return valid;
     }
 
     /**
      * Lets the protocol implementation interpret the given \a data and updates
      * the received radio packets counter.
+     *
+     * The changes caused by the packet are reported together when the packet
+     * has been interpreted (see \c DS_Config::beginBatch()).
      */
     bool readRadioPacket (const QByteArray& data) {
-        ++m_receivedRadioPackets;
+        m_receivedRadioPackets.ref();
 
-        if (interpretRadioPacket (data)) {
+        config()->beginBatch();
+        bool valid = interpretRadioPacket (data);
+        if (valid)
             config()->updateRadioCommStatus (DS::kCommsWorking);
-            return true;
-        }
 
-        return false;
+        config()->endBatch();
+        return valid;
     }
 
     /**
      * Lets the protocol implementation interpret the given \a data and updates
      * the received robot packets counter.
+     *
+     * The changes caused by the packet are reported together when the packet
+     * has been interpreted (see \c DS_Config::beginBatch()).
      */
     bool readRobotPacket (const QByteArray& data) {
-        ++m_receivedRobotPackets;
-        ++m_recvRobotPacketsSinceConnect;
+        m_receivedRobotPackets.ref();
+        m_recvRobotPacketsSinceConnect.ref();
 
-        if (interpretRobotPacket (data)) {
+        config()->beginBatch();
+        bool valid = interpretRobotPacket (data);
+        if (valid) {
             if (!config()->isConnectedToRobot())
                 resetLossCounter();
 
+            int index = robotPacketIndex (data);
+            if (index >= 0)
+                m_robotLink.registerReceived (index, timestamp());
+
             config()->updateRobotCommStatus (DS::kCommsWorking);
-            return true;
         }
 
-        return false;
+        config()->endBatch();
+        return valid;
     }
 
     /**
@@ -392,50 +419,51 @@ class Protocol {
      * not on previous robot packet loss data.
      */
     void resetLossCounter() {
-        m_recvRobotPacketsSinceConnect = 0;
-        m_sentRobotPacketsSinceConnect = 0;
+        m_recvRobotPacketsSinceConnect.store (0);
+        m_sentRobotPacketsSinceConnect.store (0);
+        m_robotLink.reset();
     }
 
     /**
      * Returns the number of packets sent to the FMS
      */
     int sentFMSPackets() {
-        return m_sentFmsPackets;
+        return m_sentFmsPackets.load();
     }
 
     /**
      * Returns the number of packets sent to the radio
      */
     int sentRadioPackets() {
-        return m_sentRadioPackets;
+        return m_sentRadioPackets.load();
     }
 
     /**
      * Returns the number of packets sent to the robot
      */
     int sentRobotPackets() {
-        return m_sentRobotPackets;
+        return m_sentRobotPackets.load();
     }
 
     /**
      * Returns the number of packets received from the FMS
      */
     int receivedFMSPackets() {
-        return m_receivedRobotPackets;
+        return m_receivedRobotPackets.load();
     }
 
     /**
      * Returns the number of packets received from the radio
      */
     int receivedRadioPackets() {
-        return m_receivedRobotPackets;
+        return m_receivedRobotPackets.load();
     }
 
     /**
      * Returns the number of packets received from the robot
      */
     int receivedRobotPackets() {
-        return m_receivedRobotPackets;
+        return m_receivedRobotPackets.load();
     }
 
     /**
@@ -446,7 +474,7 @@ class Protocol {
      * number of packets received before a reset or something.
      */
     int recvRobotPacketsSinceConnect() {
-        return m_recvRobotPacketsSinceConnect;
+        return m_recvRobotPacketsSinceConnect.load();
     }
 
     /**
@@ -457,7 +485,15 @@ class Protocol {
      * number of packets sent before robot connection (which can be a lot).
      */
     int sentRobotPacketsSinceConnect() {
-        return m_sentRobotPacketsSinceConnect;
+        return m_sentRobotPacketsSinceConnect.load();
+    }
+
+    /**
+     * Returns the round-trip time, jitter and loss figures of the robot link
+     * since the robot connection
+     */
+    LinkStatistics::Summary robotLinkStatistics() const {
+        return m_robotLink.summary();
     }
 
   protected:
@@ -468,6 +504,16 @@ class Protocol {
         return DS_Config::getInstance();
     }
 
+    /**
+     * Returns the snapshot of the Driver Station values that was taken when
+     * the packet that is being generated was requested. Packet generation
+     * functions should use this snapshot instead of \c config(), so that
+     * every field of the packet is generated from the same values.
+     */
+    const DS_Config::State& state() const {
+        return m_state;
+    }
+
     /**
      * Gives direct access to the registered joysticks of the DS
      */
@@ -475,6 +521,14 @@ class Protocol {
         return DriverStation::getInstance()->joysticks();
     }
 
+    /**
+     * Returns a consistent snapshot of the joystick values, which can be
+     * safely read while the joysticks are being updated by another thread
+     */
+    const DS::JoystickFrame& joystickFrame() {
+        return DriverStation::getInstance()->joystickFrame();
+    }
+
     /**
      * Returns a packet that is sent to the FMS.
      *
@@ -532,16 +586,41 @@ class Protocol {
         return false;
     }
 
+    /**
+     * Returns the index of the DS packet that the robot is answering to with
+     * the given \a data, which is used to measure the quality of the link.
+     *
+     * \note If you do not re-implement this function, the round-trip time,
+     *       jitter and loss bursts of the robot link are not measured.
+     */
+    virtual int robotPacketIndex (const QByteArray& data) {
+        Q_UNUSED (data);
+        return -1;
+    }
+
+  private:
+    /**
+     * Returns the time elapsed since the protocol was created in microseconds
+     */
+    qint64 timestamp() const {
+        return m_clock.nsecsElapsed() / 1000;
+    }
+
   private:
-    int m_sentFmsPackets;
-    int m_sentRadioPackets;
-    int m_sentRobotPackets;
-    int m_receivedFmsPackets;
-    int m_receivedRadioPackets;
-    int m_receivedRobotPackets;
-
-    int m_recvRobotPacketsSinceConnect;
-    int m_sentRobotPacketsSinceConnect;
+    /* Counters are updated by the network thread, but read from any thread */
+    QAtomicInt m_sentFmsPackets;
+    QAtomicInt m_sentRadioPackets;
+    QAtomicInt m_sentRobotPackets;
+    QAtomicInt m_receivedFmsPackets;
+    QAtomicInt m_receivedRadioPackets;
+    QAtomicInt m_receivedRobotPackets;
+
+    QAtomicInt m_recvRobotPacketsSinceConnect;
+    QAtomicInt m_sentRobotPacketsSinceConnect;
+
+    QElapsedTimer m_clock;
+    LinkStatistics m_robotLink;
+    DS_Config::State m_state;
 };
 
 #endif
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_PROTOCOL_BASE_H
+#define _LIB_DS_PROTOCOL_BASE_H
+
+#include <Core/Protocol.h>
+
+/**
+ * \brief Compile-time description of the constants of a protocol
+ *
+ * The values of this struct are the same defaults used by the \c Protocol
+ * class. A protocol describes itself by inheriting this struct and hiding
+ * the values that it needs to change, for example:
+ *
+ * \code
+ * struct MyProtocol_Descriptor : public ProtocolDescriptor {
+ *     static constexpr int ROBOT_FREQUENCY = 50;
+ *     static constexpr int ROBOT_OUTPUT_PORT = 1110;
+ * };
+ * \endcode
+ *
+ * Since every value is a compile-time constant, the packet code of the
+ * protocol can use them as loop bounds and buffer sizes, and check the
+ * layout of its packets with static assertions.
+ *
+ * \note Only use these values by copy (e.g. not with \c qMin() or \c qMax()),
+ *       since they are not defined outside of the struct
+ */
+struct ProtocolDescriptor {
+    /* Packet frequencies */
+    static constexpr int FMS_FREQUENCY = 1;
+    static constexpr int RADIO_FREQUENCY = 1;
+    static constexpr int ROBOT_FREQUENCY = 1;
+
+    /* Joystick limits */
+    static constexpr int MAX_POV_COUNT = 12;
+    static constexpr int MAX_AXIS_COUNT = 12;
+    static constexpr int MAX_BUTTON_COUNT = 24;
+    static constexpr int MAX_JOYSTICK_COUNT = 6;
+
+    /* Network ports */
+    static constexpr int FMS_INPUT_PORT = DS_DISABLED_PORT;
+    static constexpr int FMS_OUTPUT_PORT = DS_DISABLED_PORT;
+    static constexpr int RADIO_INPUT_PORT = DS_DISABLED_PORT;
+    static constexpr int RADIO_OUTPUT_PORT = DS_DISABLED_PORT;
+    static constexpr int ROBOT_INPUT_PORT = DS_DISABLED_PORT;
+    static constexpr int ROBOT_OUTPUT_PORT = DS_DISABLED_PORT;
+    static constexpr int NETCONSOLE_INPUT_PORT = DS_DISABLED_PORT;
+    static constexpr int NETCONSOLE_OUTPUT_PORT = DS_DISABLED_PORT;
+
+    /* Socket types */
+    static constexpr DS::SocketType FMS_SOCKET_TYPE = DS::kSocketTypeUDP;
+    static constexpr DS::SocketType RADIO_SOCKET_TYPE = DS::kSocketTypeUDP;
+    static constexpr DS::SocketType ROBOT_SOCKET_TYPE = DS::kSocketTypeUDP;
+
+    /* Battery information */
+    static constexpr qreal NOMINAL_BATTERY_VOLTAGE = 12.8;
+    static constexpr qreal NOMINAL_BATTERY_AMPERAGE = 17;
+
+    /* Packet sizes (in bytes) */
+    static constexpr int ROBOT_PACKET_SIZE = 0;  /**< Largest DS packet */
+    static constexpr int FMS_STATUS_SIZE = 0;    /**< Smallest FMS packet */
+    static constexpr int ROBOT_STATUS_SIZE = 0;  /**< Smallest robot packet */
+};
+
+/**
+ * \brief Implements the constant functions of a \c Protocol from a
+ *        \c ProtocolDescriptor
+ *
+ * The \c DriverStation still obtains the protocol constants through the
+ * virtual functions of the \c Protocol class, but protocols that derive
+ * from this class do not need to implement them one by one, and their
+ * descriptor is checked when the protocol is compiled.
+ */
+template <typename Descriptor>
+class ProtocolBase : public Protocol {
+    Q_STATIC_ASSERT_X (Descriptor::FMS_FREQUENCY > 0
+                       && Descriptor::FMS_FREQUENCY <= 1000,
+                       "The FMS frequency must be between 1 and 1000 Hz");
+    Q_STATIC_ASSERT_X (Descriptor::RADIO_FREQUENCY > 0
+                       && Descriptor::RADIO_FREQUENCY <= 1000,
+                       "The radio frequency must be between 1 and 1000 Hz");
+    Q_STATIC_ASSERT_X (Descriptor::ROBOT_FREQUENCY > 0
+                       && Descriptor::ROBOT_FREQUENCY <= 1000,
+                       "The robot frequency must be between 1 and 1000 Hz");
+
+    Q_STATIC_ASSERT_X (Descriptor::MAX_POV_COUNT >= 0
+                       && Descriptor::MAX_POV_COUNT <= DS_MAX_POVS,
+                       "The DS cannot hold that many POVs");
+    Q_STATIC_ASSERT_X (Descriptor::MAX_AXIS_COUNT >= 0
+                       && Descriptor::MAX_AXIS_COUNT <= DS_MAX_AXES,
+                       "The DS cannot hold that many axes");
+    Q_STATIC_ASSERT_X (Descriptor::MAX_BUTTON_COUNT >= 0
+                       && Descriptor::MAX_BUTTON_COUNT <= DS_MAX_BUTTONS,
+                       "The DS cannot hold that many buttons");
+    Q_STATIC_ASSERT_X (Descriptor::MAX_JOYSTICK_COUNT >= 0
+                       && Descriptor::MAX_JOYSTICK_COUNT <= DS_MAX_JOYSTICKS,
+                       "The DS cannot hold that many joysticks");
+
+    Q_STATIC_ASSERT_X (Descriptor::ROBOT_PACKET_SIZE >= 0
+                       && Descriptor::FMS_STATUS_SIZE >= 0
+                       && Descriptor::ROBOT_STATUS_SIZE >= 0,
+                       "Packet sizes cannot be negative");
+
+  public:
+    virtual int fmsFrequency() {
+        return Descriptor::FMS_FREQUENCY;
+    }
+
+    virtual int radioFrequency() {
+        return Descriptor::RADIO_FREQUENCY;
+    }
+
+    virtual int robotFrequency() {
+        return Descriptor::ROBOT_FREQUENCY;
+    }
+
+    virtual int maxJoystickCount() {
+        return Descriptor::MAX_JOYSTICK_COUNT;
+    }
+
+    virtual int maxPOVCount() {
+        return Descriptor::MAX_POV_COUNT;
+    }
+
+    virtual int maxAxisCount() {
+        return Descriptor::MAX_AXIS_COUNT;
+    }
+
+    virtual int maxButtonCount() {
+        return Descriptor::MAX_BUTTON_COUNT;
+    }
+
+    virtual int fmsInputPort() {
+        return Descriptor::FMS_INPUT_PORT;
+    }
+
+    virtual int fmsOutputPort() {
+        return Descriptor::FMS_OUTPUT_PORT;
+    }
+
+    virtual int radioInputPort() {
+        return Descriptor::RADIO_INPUT_PORT;
+    }
+
+    virtual int robotInputPort() {
+        return Descriptor::ROBOT_INPUT_PORT;
+    }
+
+    virtual int radioOutputPort() {
+        return Descriptor::RADIO_OUTPUT_PORT;
+    }
+
+    virtual int robotOutputPort() {
+        return Descriptor::ROBOT_OUTPUT_PORT;
+    }
+
+    virtual int netconsoleInputPort() {
+        return Descriptor::NETCONSOLE_INPUT_PORT;
+    }
+
+    virtual int netconsoleOutputPort() {
+        return Descriptor::NETCONSOLE_OUTPUT_PORT;
+    }
+
+    virtual qreal nominalBatteryVOltage() {
+        return Descriptor::NOMINAL_BATTERY_VOLTAGE;
+    }
+
+    virtual qreal nominalBatteryAmperage() {
+        return Descriptor::NOMINAL_BATTERY_AMPERAGE;
+    }
+
+    virtual DS::SocketType fmsSocketType() {
+        return Descriptor::FMS_SOCKET_TYPE;
+    }
+
+    virtual DS::SocketType radioSocketType() {
+        return Descriptor::RADIO_SOCKET_TYPE;
+    }
+
+    virtual DS::SocketType robotSocketType() {
+        return Descriptor::ROBOT_SOCKET_TYPE;
+    }
+};
+
+#endif
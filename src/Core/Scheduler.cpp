@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "Scheduler.h"
+
+#include <QtMath>
+
+/**
+ * Maximum number of missed slots that are fired with the \c kCatchUp policy.
+ * Anything beyond this limit is dropped, so that a long stall (e.g. when the
+ * computer wakes up from sleep) does not flood the network.
+ */
+const qint64 MAX_CATCH_UP = 5;
+
+/**
+ * Number of nanoseconds in a millisecond
+ */
+const qint64 NSECS_PER_MSEC = 1000000;
+
+Scheduler::Scheduler() {
+    m_running.store (false);
+
+    m_timer.setParent (this);
+    m_timer.setSingleShot (true);
+    m_timer.setTimerType (Qt::PreciseTimer);
+
+    connect (&m_timer, SIGNAL (timeout()), this, SLOT (onTimeout()));
+}
+
+/**
+ * Returns \c true if the scheduler is currently firing its streams
+ */
+bool Scheduler::isRunning() const {
+    return m_running.load();
+}
+
+/**
+ * Returns the timing statistics of the given \a stream
+ */
+Scheduler::Jitter Scheduler::jitter (int stream) const {
+    QMutexLocker locker (&m_mutex);
+    Jitter jitter;
+
+    if (stream >= 0 && stream < m_streams.count()) {
+        const Stream& s = m_streams.at (stream);
+
+        jitter.missed = s.missed;
+        jitter.samples = s.samples;
+        jitter.maximum = static_cast<qreal> (s.maxLateness) / NSECS_PER_MSEC;
+
+        if (s.samples > 0)
+            jitter.average = static_cast<qreal> (s.totalLateness)
+                             / s.samples / NSECS_PER_MSEC;
+    }
+
+    return jitter;
+}
+
+/**
+ * Returns the number of times per second that the given \a stream is fired
+ */
+qreal Scheduler::frequency (int stream) const {
+    QMutexLocker locker (&m_mutex);
+
+    if (stream >= 0 && stream < m_streams.count())
+        return m_streams.at (stream).frequency;
+
+    return 0;
+}
+
+/**
+ * Returns the policy used by the given \a stream to deal with missed slots
+ */
+Scheduler::MissPolicy Scheduler::policy (int stream) const {
+    QMutexLocker locker (&m_mutex);
+
+    if (stream >= 0 && stream < m_streams.count())
+        return m_streams.at (stream).policy;
+
+    return kSkip;
+}
+
+/**
+ * Stops firing the streams
+ */
+void Scheduler::stop() {
+    m_running.store (false);
+    m_timer.stop();
+}
+
+/**
+ * Starts (or restarts) the scheduler. Every stream is fired as soon as the
+ * event loop regains control, and then once every period from that moment.
+ */
+void Scheduler::start() {
+    m_running.store (true);
+    m_clock.start();
+
+    for (int i = 0; i < m_streams.count(); ++i)
+        m_streams [i].deadline = 0;
+
+    schedule();
+}
+
+/**
+ * Clears the timing statistics of every stream
+ */
+void Scheduler::resetJitter() {
+    QMutexLocker locker (&m_mutex);
+
+    for (int i = 0; i < m_streams.count(); ++i) {
+        m_streams [i].missed = 0;
+        m_streams [i].samples = 0;
+        m_streams [i].maxLateness = 0;
+        m_streams [i].totalLateness = 0;
+    }
+}
+
+/**
+ * Changes the number of times per second that the given \a stream is fired.
+ * If the \a frequency is zero (or negative), the stream is disabled.
+ *
+ * \note The new period begins counting from the moment this function is
+ *       called, the old deadline of the stream is discarded.
+ */
+void Scheduler::setFrequency (int stream, qreal frequency) {
+    if (stream < 0)
+        return;
+
+    {
+        QMutexLocker locker (&m_mutex);
+
+        ensureStream (stream);
+        Stream& s = m_streams [stream];
+
+        s.period = 0;
+        s.frequency = qMax (frequency, static_cast<qreal> (0));
+
+        if (s.frequency > 0)
+            s.period = qRound64 (1000 * NSECS_PER_MSEC / s.frequency);
+
+        if (m_running.load())
+            s.deadline = nsecsElapsed() + s.period;
+    }
+
+    if (m_running.load())
+        schedule();
+}
+
+/**
+ * Changes the \a policy used by the given \a stream to deal with missed slots
+ */
+void Scheduler::setPolicy (int stream, MissPolicy policy) {
+    if (stream < 0)
+        return;
+
+    QMutexLocker locker (&m_mutex);
+
+    ensureStream (stream);
+    m_streams [stream].policy = policy;
+}
+
+/**
+ * Returns the number of nanoseconds elapsed since the scheduler was started
+ */
+qint64 Scheduler::nsecsElapsed() const {
+    return m_clock.nsecsElapsed();
+}
+
+/**
+ * Fires every stream whose deadline has passed and advances its deadline by
+ * a whole number of periods, so that the deadlines always stay aligned to
+ * the grid defined when the stream was started.
+ *
+ * The fired streams are wrapped by the \c batchStarted() and
+ * \c batchFinished() signals.
+ */
+void Scheduler::onTimeout() {
+    if (!m_running.load())
+        return;
+
+    bool batch = false;
+    qint64 now = nsecsElapsed();
+
+    for (int i = 0; i < m_streams.count(); ++i) {
+        Stream& s = m_streams [i];
+
+        if (s.period <= 0 || s.deadline > now)
+            continue;
+
+        /* Let the receivers know that a group of packets is coming */
+        if (!batch) {
+            batch = true;
+            emit batchStarted();
+        }
+
+        /* Measure how late we are and how many slots passed entirely */
+        qint64 lateness = now - s.deadline;
+        qint64 passed = lateness / s.period;
+
+        /* Decide how many of the passed slots are fired */
+        qint64 fires = 1;
+        if (s.policy == kCatchUp)
+            fires += qMin (passed, MAX_CATCH_UP);
+
+        /* Register jitter information */
+        {
+            QMutexLocker locker (&m_mutex);
+            s.samples += 1;
+            s.missed += passed - (fires - 1);
+            s.totalLateness += lateness;
+            s.maxLateness = qMax (s.maxLateness, lateness);
+        }
+
+        /* Re-align the deadline to the grid */
+        s.deadline += (passed + 1) * s.period;
+
+        /* Fire the stream */
+        for (qint64 j = 0; j < fires && m_running.load(); ++j)
+            emit triggered (i);
+    }
+
+    if (batch)
+        emit batchFinished();
+
+    schedule();
+}
+
+/**
+ * Arms the timer so that it fires at the earliest deadline of all the
+ * enabled streams.
+ */
+void Scheduler::schedule() {
+    if (!m_running.load())
+        return;
+
+    qint64 next = -1;
+    for (int i = 0; i < m_streams.count(); ++i) {
+        if (m_streams.at (i).period > 0) {
+            if (next < 0 || m_streams.at (i).deadline < next)
+                next = m_streams.at (i).deadline;
+        }
+    }
+
+    /* No stream is enabled */
+    if (next < 0) {
+        m_timer.stop();
+        return;
+    }
+
+    /* Round up, waking up early would only cause an extra timer event */
+    qint64 wait = next - nsecsElapsed();
+    int msecs = wait > 0 ? static_cast<int> ((wait + NSECS_PER_MSEC - 1)
+                                             / NSECS_PER_MSEC) : 0;
+
+    m_timer.start (msecs);
+}
+
+/**
+ * Registers the streams up to the given \a stream ID if required
+ */
+void Scheduler::ensureStream (int stream) {
+    if (stream >= m_streams.count())
+        m_streams.resize (stream + 1);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_SCHEDULER_H
+#define _LIB_DS_SCHEDULER_H
+
+#include <QMutex>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QVector>
+#include <QElapsedTimer>
+
+/**
+ * \brief Fires periodic packet streams at drift-free, absolute deadlines
+ *
+ * Instead of re-arming a single-shot timer after each packet (which adds the
+ * latency of the event loop to every period), the \c Scheduler keeps the
+ * absolute deadline of each stream on a monotonic clock. When a stream fires,
+ * its next deadline is advanced by exactly one period, so a busy event loop
+ * can delay an individual packet, but never the overall send rate.
+ *
+ * If the event loop stalls for longer than a whole period, the missed slots
+ * are handled according to the \c MissPolicy of the stream.
+ *
+ * The lateness of each fired slot is measured and can be obtained with the
+ * \c jitter() function.
+ *
+ * All the streams that fall due in the same timer event are fired between a
+ * \c batchStarted() and a \c batchFinished() signal, so that the packets of
+ * a single tick can be sent together.
+ *
+ * \note The scheduler may live in the network thread, its timing statistics,
+ *       frequencies and policies can be obtained from any thread
+ *
+ * The time is obtained with the \c nsecsElapsed() function, which can be
+ * re-implemented to drive the scheduler with another clock (e.g. in tests).
+ */
+class Scheduler : public QObject {
+    Q_OBJECT
+    Q_ENUMS (MissPolicy)
+
+  signals:
+    void batchStarted();
+    void batchFinished();
+    void triggered (int stream);
+
+  public:
+    /**
+     * \brief Defines what to do with the slots missed during a stall
+     */
+    enum MissPolicy {
+        kSkip,    /**< Drop missed slots and re-align to the next deadline */
+        kCatchUp, /**< Fire missed slots back-to-back (up to a limit) */
+    };
+
+    /**
+     * \brief Holds the timing statistics of a stream
+     */
+    struct Jitter {
+        qint64 samples = 0; /**< Number of slots fired */
+        qint64 missed = 0;  /**< Number of slots that were dropped */
+        qreal average = 0;  /**< Average lateness in milliseconds */
+        qreal maximum = 0;  /**< Maximum lateness in milliseconds */
+    };
+
+    explicit Scheduler();
+
+    bool isRunning() const;
+    Jitter jitter (int stream) const;
+    qreal frequency (int stream) const;
+    MissPolicy policy (int stream) const;
+
+  public slots:
+    void stop();
+    void start();
+    void resetJitter();
+    void setFrequency (int stream, qreal frequency);
+    void setPolicy (int stream, MissPolicy policy);
+
+  protected:
+    virtual qint64 nsecsElapsed() const;
+
+  protected slots:
+    void onTimeout();
+
+  private:
+    void schedule();
+    void ensureStream (int stream);
+
+  private:
+    struct Stream {
+        qint64 period = 0;
+        qint64 deadline = 0;
+        qint64 samples = 0;
+        qint64 missed = 0;
+        qint64 totalLateness = 0;
+        qint64 maxLateness = 0;
+        qreal frequency = 0;
+        MissPolicy policy = kSkip;
+    };
+
+    QAtomicInt m_running;
+    QTimer m_timer;
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QVector<Stream> m_streams;
+};
+
+#endif
@@ -10,9 +10,33 @@
 
 #include <QHostInfo>
 #include <DriverStation.h>
+#include <Core/DS_Config.h>
 #include <QNetworkInterface>
 #include <Utilities/Lookup.h>
 
+#ifdef Q_OS_LINUX
+    #include <string.h>
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+#endif
+
+/*
+ * Receive ring definitions, a burst that does not fit in the ring is simply
+ * read during the next notification of the socket
+ */
+const int RING_SIZE = 16;
+const int DATAGRAM_CAPACITY = 2048;
+
+/*
+ * Number of nanoseconds in a millisecond
+ */
+const qint64 NSECS_PER_MSEC = 1000000;
+
+/*
+ * Address of the roboRIO when connected through USB
+ */
+const QString USB_ROBOT_ADDRESS = "172.22.11.2";
+
 /**
  * Sets the socket options for the given \a socket
  */
@@ -35,6 +59,51 @@ QString GET_CONSOLE_IP (const QHostAddress& address) {
     return ip;
 }
 
+/**
+ * Returns the IPv4 form of the given \a address if it is an IPv4-mapped
+ * IPv6 address (as reported by dual-stack sockets)
+ */
+QHostAddress TO_IPV4 (const QHostAddress& address) {
+    bool ok = false;
+    quint32 ipv4 = address.toIPv4Address (&ok);
+
+    if (ok && address.protocol() == QAbstractSocket::IPv6Protocol)
+        return QHostAddress (ipv4);
+
+    return address;
+}
+
+#ifdef Q_OS_LINUX
+/**
+ * Writes the given \a address and \a port into the given \a storage and
+ * returns the length of the resulting socket address (or 0 if the address
+ * cannot be used directly, e.g. when it is null)
+ */
+socklen_t SOCKET_ADDRESS (const QHostAddress& address, int port,
+                          struct sockaddr_storage* storage) {
+    memset (storage, 0, sizeof (*storage));
+
+    if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+        struct sockaddr_in* in = (struct sockaddr_in*) storage;
+        in->sin_family = AF_INET;
+        in->sin_port = htons (port);
+        in->sin_addr.s_addr = htonl (address.toIPv4Address());
+        return sizeof (struct sockaddr_in);
+    }
+
+    if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+        Q_IPV6ADDR ip = address.toIPv6Address();
+        struct sockaddr_in6* in = (struct sockaddr_in6*) storage;
+        in->sin6_family = AF_INET6;
+        in->sin6_port = htons (port);
+        memcpy (&in->sin6_addr, &ip, sizeof (ip));
+        return sizeof (struct sockaddr_in6);
+    }
+
+    return 0;
+}
+#endif
+
 Sockets::Sockets() {
     /* Assign invalid addresses */
     m_fmsAddress = QHostAddress ("");
@@ -61,6 +130,30 @@ Sockets::Sockets() {
     m_robotLookup = new Lookup;
     m_driverStation = Q_NULLPTR;
 
+    /* Allocate the receive ring once, readDatagrams() only reuses it */
+    m_emittedDatagram = -1;
+    m_sources.resize (RING_SIZE);
+    m_datagrams.resize (RING_SIZE);
+    for (int i = 0; i < RING_SIZE; ++i)
+        m_datagrams [i].reserve (DATAGRAM_CAPACITY);
+
+    /* Initialize the send path */
+    m_batching = false;
+    m_outgoingCount = 0;
+    m_connectSenders = false;
+    m_outgoing.resize (RING_SIZE);
+    m_sendClock.start();
+    resetSendStatistics();
+
+    /* Nothing to discover yet */
+    m_robotDiscoveryTime = -1;
+    m_discoveryClock.start();
+
+    /* Ensure that the lookups follow us when moved to another thread */
+    m_fmsLookup->setParent (this);
+    m_radioLookup->setParent (this);
+    m_robotLookup->setParent (this);
+
     /* Assign the initial ports */
     m_fmsOutputPort = DS_DISABLED_PORT;
     m_radioOutputPort = DS_DISABLED_PORT;
@@ -106,6 +199,154 @@ QHostAddress Sockets::robotAddress() const {
 
     return m_robotAddress;
 }
+
+/**
+ * Returns \c true if the UDP senders are connected to their targets
+ */
+bool Sockets::connectedSendersEnabled() const {
+    return m_connectSenders;
+}
+
+/**
+ * Returns the time (in milliseconds) that passed between the start of the
+ * robot discovery and the first packet received from the robot, or -1 if
+ * the robot has not been found yet.
+ */
+qint64 Sockets::robotDiscoveryTime() const {
+    QMutexLocker locker (&m_statisticsMutex);
+    return m_robotDiscoveryTime;
+}
+
+/**
+ * Returns the counters of the UDP send path
+ */
+Sockets::SendStatistics Sockets::sendStatistics() const {
+    QMutexLocker locker (&m_statisticsMutex);
+
+    SendStatistics statistics;
+    statistics.errors = m_sendErrors;
+    statistics.syscalls = m_sendSyscalls;
+    statistics.datagrams = m_sentDatagrams;
+    statistics.maximum = static_cast<qreal> (m_maxSendTime) / NSECS_PER_MSEC;
+
+    if (m_sendSyscalls > 0)
+        statistics.average = static_cast<qreal> (m_sendTime)
+                             / m_sendSyscalls / NSECS_PER_MSEC;
+
+    return statistics;
+}
+
+/**
+ * Sends every UDP datagram queued since the call to \c beginBatch().
+ *
+ * On Linux, the queued datagrams are grouped by the sender that queued them,
+ * and each group is sent with a single \c sendmmsg() call through the
+ * descriptor of its sender (so that the bound port and the options of the
+ * sender are kept). The destination address is only given for the datagrams
+ * of senders that are not connected, since the kernel rejects an explicit
+ * address on a connected UDP socket.
+ *
+ * When the kernel rejects a datagram (e.g. the address of a robot candidate
+ * is unreachable), it is dropped and counted as a send error, and the rest
+ * of its group is sent with another call.
+ *
+ * Anything that cannot be sent that way is sent normally through Qt.
+ */
+void Sockets::endBatch() {
+    m_batching = false;
+
+#ifdef Q_OS_LINUX
+    int indexes [RING_SIZE];
+    struct iovec vectors [RING_SIZE];
+    struct mmsghdr messages [RING_SIZE];
+    struct sockaddr_storage addresses [RING_SIZE];
+
+    for (int first = 0; first < m_outgoingCount; ++first) {
+        QUdpSocket* sender = m_outgoing.at (first).socket;
+        if (!sender || sender->socketDescriptor() < 0)
+            continue;
+
+        int count = 0;
+        int descriptor = sender->socketDescriptor();
+        bool connected = sender->state() == QAbstractSocket::ConnectedState;
+        memset (messages, 0, sizeof (messages));
+
+        /* Build the message vector of this sender */
+        for (int i = first; i < m_outgoingCount; ++i) {
+            Outgoing& datagram = m_outgoing [i];
+            if (datagram.socket != sender)
+                continue;
+
+            struct msghdr& header = messages [count].msg_hdr;
+            if (!connected) {
+                header.msg_name = &addresses [count];
+                header.msg_namelen = SOCKET_ADDRESS (datagram.address,
+                                                     datagram.port,
+                                                     &addresses [count]);
+
+                if (header.msg_namelen == 0)
+                    continue;
+            }
+
+            /* Do not detach the data, it is usually shared with the protocol */
+            char* data = const_cast<char*> (datagram.data.constData());
+            vectors [count].iov_base = data;
+            vectors [count].iov_len = datagram.data.size();
+            header.msg_iov = &vectors [count];
+            header.msg_iovlen = 1;
+            indexes [count++] = i;
+        }
+
+        /* Send the group, skipping (and counting) the datagrams that fail */
+        for (int offset = 0; offset < count;) {
+            qint64 start = m_sendClock.nsecsElapsed();
+            int sent = ::sendmmsg (descriptor,
+                                   &messages [offset],
+                                   count - offset,
+                                   0);
+            qint64 time = m_sendClock.nsecsElapsed() - start;
+
+            if (sent > 0) {
+                offset += sent;
+                registerSend (time, sent, 0);
+            }
+
+            else {
+                offset += 1;
+                registerSend (time, 0, 1);
+            }
+        }
+
+        for (int i = 0; i < count; ++i)
+            m_outgoing [indexes [i]].socket = Q_NULLPTR;
+    }
+#endif
+
+    /* Send the remaining datagrams one by one & release the packet data */
+    for (int i = 0; i < m_outgoingCount; ++i) {
+        Outgoing& datagram = m_outgoing [i];
+
+        if (datagram.socket)
+            sendDatagram (datagram.socket,
+                          datagram.data,
+                          datagram.address,
+                          datagram.port);
+
+        datagram.socket = Q_NULLPTR;
+        datagram.data = QByteArray();
+    }
+
+    m_outgoingCount = 0;
+}
+
+/**
+ * Queues the UDP datagrams sent after calling this function, so that they
+ * are sent together when \c endBatch() is called
+ */
+void Sockets::beginBatch() {
+    m_batching = true;
+}
+
 /**
  * If any of the IPs used during the communications is not known,
  * this function will ensure that the DS performs a lookup periodically
@@ -128,13 +369,62 @@ void Sockets::performLookups() {
         m_radioLookup->lookup (m_driverStation->radioAddress());
 
     /* Perform a robot lookup */
-    if (m_robotAddress.isNull() && !m_driverStation->isConnectedToRobot())
-        m_robotLookup->lookup (m_driverStation->robotAddress());
+    if (m_robotAddress.isNull()
+            && !m_robotName.isEmpty()
+            && !m_driverStation->isConnectedToRobot())
+        m_robotLookup->lookup (m_robotName);
 
     /* Wait and perform the lookup again */
     DS_Schedule (2000, this, SLOT (performLookups()));
 }
 
+/**
+ * Clears the counters of the UDP send path
+ */
+void Sockets::resetSendStatistics() {
+    QMutexLocker locker (&m_statisticsMutex);
+
+    m_sendTime = 0;
+    m_sendErrors = 0;
+    m_maxSendTime = 0;
+    m_sendSyscalls = 0;
+    m_sentDatagrams = 0;
+}
+
+/**
+ * Forgets the robot address found by the discovery process and starts racing
+ * the candidate addresses again. This is called when the robot watchdog
+ * expires, so that a robot that changed its link (e.g. from USB to the
+ * radio) is found again as soon as it answers on any of its addresses.
+ *
+ * \note This function has no effect if the robot address was given as an
+ *       IP address, or while the discovery is still running.
+ */
+void Sockets::restartRobotDiscovery() {
+    if (m_robotCandidates.isEmpty() || m_robotAddress.isNull())
+        return;
+
+    qDebug() << "Robot lost, discovering it again";
+
+    m_robotAddress = QHostAddress ("");
+    setRobotDiscoveryTime (-1);
+    m_discoveryClock.restart();
+    connectSenders();
+
+    if (!m_robotName.isEmpty())
+        m_robotLookup->lookup (m_robotName);
+}
+
+/**
+ * If \a enabled is set to \c true, each UDP sender will be connected to the
+ * address and port of its target, which saves the kernel from looking up the
+ * route of the target on every single packet.
+ */
+void Sockets::setConnectedSendersEnabled (bool enabled) {
+    m_connectSenders = enabled;
+    connectSenders();
+}
+
 /**
  * Changes the port in which we receive data from the FMS
  */
@@ -157,6 +447,7 @@ void Sockets::setFMSInputPort (int port) {
  */
 void Sockets::setFMSOutputPort (int port) {
     m_fmsOutputPort = port;
+    connectSenders();
 }
 
 /**
@@ -198,6 +489,7 @@ void Sockets::setRobotInputPort (int port) {
  */
 void Sockets::setRadioOutputPort (int port) {
     m_radioOutputPort = port;
+    connectSenders();
 }
 
 /**
@@ -205,6 +497,7 @@ void Sockets::setRadioOutputPort (int port) {
  */
 void Sockets::setRobotOutputPort (int port) {
     m_robotOutputPort = port;
+    connectSenders();
 }
 
 /**
@@ -218,7 +511,7 @@ void Sockets::sendToFMS (const QByteArray& data) {
         m_tcpFmsSender->write (data);
 
     else if (m_udpFmsSender)
-        m_udpFmsSender->writeDatagram (data, fmsAddress(), m_fmsOutputPort);
+        sendDatagram (m_udpFmsSender, data, fmsAddress(), m_fmsOutputPort);
 }
 
 /**
@@ -231,8 +524,13 @@ void Sockets::sendToRobot (const QByteArray& data) {
     if (m_tcpRobotSender)
         m_tcpRobotSender->write (data);
 
+    else if (m_udpRobotSender && discoveringRobot()) {
+        foreach (const QHostAddress& address, m_robotCandidates)
+            sendDatagram (m_udpRobotSender, data, address, m_robotOutputPort);
+    }
+
     else if (m_udpRobotSender)
-        m_udpRobotSender->writeDatagram (data, robotAddress(), m_robotOutputPort);
+        sendDatagram (m_udpRobotSender, data, robotAddress(), m_robotOutputPort);
 }
 
 /**
@@ -246,7 +544,7 @@ void Sockets::sendToRadio (const QByteArray& data) {
         m_tcpRadioSender->write (data);
 
     else if (m_udpRadioSender)
-        m_udpRadioSender->writeDatagram (data, radioAddress(), m_radioOutputPort);
+        sendDatagram (m_udpRadioSender, data, radioAddress(), m_radioOutputPort);
 }
 
 /**
@@ -284,6 +582,7 @@ void Sockets::setFMSSocketType (DS::SocketType type) {
 
         CONFIGURE_SOCKET (m_udpFmsSender);
         CONFIGURE_SOCKET (m_udpFmsReceiver);
+        connectSenders();
 
         connect (m_udpFmsReceiver, SIGNAL (readyRead()),
                  this,               SLOT (readFMSSocket()));
@@ -325,6 +624,7 @@ void Sockets::setRadioSocketType (DS::SocketType type) {
 
         CONFIGURE_SOCKET (m_udpRadioSender);
         CONFIGURE_SOCKET (m_udpRadioReceiver);
+        connectSenders();
 
         connect (m_udpRadioReceiver, SIGNAL (readyRead()),
                  this,                 SLOT (readRadioSocket()));
@@ -342,6 +642,8 @@ void Sockets::setRobotSocketType (DS::SocketType type) {
     delete m_tcpRobotReceiver;
 
     /* Assign a null pointer to all sockets, so that we do not crash */
+    m_udpRobotSender = Q_NULLPTR;
+    m_tcpRobotSender = Q_NULLPTR;
     m_udpRobotReceiver = Q_NULLPTR;
     m_tcpRobotReceiver = Q_NULLPTR;
 
@@ -364,6 +666,7 @@ void Sockets::setRobotSocketType (DS::SocketType type) {
 
         CONFIGURE_SOCKET (m_udpRobotSender);
         CONFIGURE_SOCKET (m_udpRobotReceiver);
+        connectSenders();
 
         connect (m_udpRobotReceiver, SIGNAL (readyRead()),
                  this,                 SLOT (readRobotSocket()));
@@ -409,7 +712,13 @@ void Sockets::setRobotAddress (const QString& address) {
     if (ip.isNull() && !address.isEmpty())
         qDebug() << "Robot address" << address << "scheduled for lookup";
 
-    setRobotAddress (ip);
+    if (ip.isNull())
+        startRobotDiscovery (address);
+    else {
+        m_robotName = "";
+        m_robotCandidates.clear();
+        setRobotAddress (ip);
+    }
 }
 
 /**
@@ -419,6 +728,7 @@ void Sockets::setFMSAddress (const QHostAddress& address) {
     if (m_fmsAddress != address && !address.isNull()) {
         m_fmsAddress = address;
         qDebug() << "FMS Address set to" << GET_CONSOLE_IP (address);
+        connectSenders();
     }
 }
 
@@ -429,6 +739,7 @@ void Sockets::setRadioAddress (const QHostAddress& address) {
     if (m_radioAddress != address && !address.isNull()) {
         m_radioAddress = address;
         qDebug() << "Radio Address set to" << GET_CONSOLE_IP (address);
+        connectSenders();
     }
 }
 
@@ -439,6 +750,7 @@ void Sockets::setRobotAddress (const QHostAddress& address) {
     if (m_robotAddress != address && !address.isNull()) {
         m_robotAddress = address;
         qDebug() << "Robot Address set to" << GET_CONSOLE_IP (address);
+        connectSenders();
     }
 }
 
@@ -446,63 +758,43 @@ void Sockets::setRobotAddress (const QHostAddress& address) {
  * Called when we receive data from the FMS
  */
 void Sockets::readFMSSocket() {
-    QByteArray data;
-    QHostAddress address;
-
     if (m_tcpFmsReceiver) {
-        data = DS::readSocket (m_tcpFmsReceiver);
-        address = m_tcpFmsReceiver->peerAddress();
+        setFMSAddress (m_tcpFmsReceiver->peerAddress());
+        emit fmsPacketReceived (DS::readSocket (m_tcpFmsReceiver));
     }
 
     else if (m_udpFmsReceiver) {
-        data = DS::readSocket (m_udpFmsReceiver);
-        address = m_udpFmsReceiver->peerAddress();
+        setFMSAddress (m_udpFmsReceiver->peerAddress());
+        readDatagrams (m_udpFmsReceiver, &Sockets::fmsPacketReceived);
     }
-
-    setFMSAddress (address);
-    emit fmsPacketReceived (data);
 }
 
 /**
  * Called when we receive data from the radio
  */
 void Sockets::readRadioSocket() {
-    QByteArray data;
-    QHostAddress address;
-
     if (m_tcpRadioReceiver) {
-        data = DS::readSocket (m_tcpRadioReceiver);
-        address = m_tcpRadioReceiver->peerAddress();
+        setRadioAddress (m_tcpRadioReceiver->peerAddress());
+        emit radioPacketReceived (DS::readSocket (m_tcpRadioReceiver));
     }
 
     else if (m_udpRadioReceiver) {
-        data = DS::readSocket (m_udpRadioReceiver);
-        address = m_udpRadioReceiver->peerAddress();
+        setRadioAddress (m_udpRadioReceiver->peerAddress());
+        readDatagrams (m_udpRadioReceiver, &Sockets::radioPacketReceived);
     }
-
-    setRadioAddress (address);
-    emit radioPacketReceived (data);
 }
 
 /**
  * Called when we receive data from the robot
  */
 void Sockets::readRobotSocket() {
-    QByteArray data;
-    QHostAddress address;
-
     if (m_tcpRobotReceiver) {
-        data = DS::readSocket (m_tcpRobotReceiver);
-        address = m_tcpRobotReceiver->peerAddress();
+        setRobotAddress (m_tcpRobotReceiver->peerAddress());
+        emit robotPacketReceived (DS::readSocket (m_tcpRobotReceiver));
     }
 
-    else if (m_udpRobotReceiver) {
-        data = DS::readSocket (m_udpRobotReceiver);
-        address = m_udpRobotReceiver->peerAddress();
-    }
-
-    setRobotAddress (address);
-    emit robotPacketReceived (data);
+    else if (m_udpRobotReceiver)
+        readDatagrams (m_udpRobotReceiver, &Sockets::robotPacketReceived);
 }
 
 /**
@@ -528,12 +820,256 @@ void Sockets::onRadioLookupFinished (const QString& name,
 }
 
 /**
- * Assigns the found robot IP
+ * Adds the found robot IP to the addresses that are raced while discovering
+ * the robot (it only becomes the robot address once the robot answers)
  */
 void Sockets::onRobotLookupFinished (const QString& name,
                                      const QHostAddress& address) {
-    if (m_robotAddress.isNull()
-            && !address.isNull()
-            && name.toLower() == m_driverStation->robotAddress().toLower())
-        setRobotAddress (address);
+    if (address.isNull() || m_robotName.isEmpty())
+        return;
+
+    if (Lookup::normalize (name) != Lookup::normalize (m_robotName))
+        return;
+
+    if (!m_robotCandidates.contains (address)) {
+        m_robotCandidates.prepend (address);
+        qDebug() << "Robot candidate" << GET_CONSOLE_IP (address)
+                 << "found by lookup";
+    }
+}
+
+/**
+ * Reads every datagram pending in the given UDP \a socket into the receive
+ * ring and emits the given packet \a signal once for each one of them.
+ * Returns the number of datagrams read, their sender addresses are stored
+ * in the same slots of \c m_sources, and the slot of the datagram that is
+ * being emitted is stored in \c m_emittedDatagram.
+ *
+ * On Linux, the oldest datagram is read through Qt, because Qt only re-enables
+ * the read notifier of an unbuffered UDP socket when \c readDatagram() is
+ * called, and the rest of the burst is drained with a single \c recvmmsg()
+ * call. Qt is only asked to read when a datagram is pending, since reading an
+ * empty socket sets (and emits) a socket error. Datagrams are only emitted
+ * after the socket has been read, since a packet handler may end up replacing
+ * the socket.
+ */
+int Sockets::readDatagrams (QUdpSocket* socket, PacketSignal signal) {
+    if (!socket)
+        return 0;
+
+    /* Get the ring buffers, this only allocates if a receiver kept a copy */
+    char* buffers [RING_SIZE];
+    for (int i = 0; i < RING_SIZE; ++i) {
+        m_datagrams [i].resize (DATAGRAM_CAPACITY);
+        buffers [i] = m_datagrams [i].data();
+    }
+
+    int count = 0;
+
+#ifdef Q_OS_LINUX
+    /* Re-arm the Qt notifier with the oldest datagram */
+    if (socket->hasPendingDatagrams()) {
+        qint64 length = socket->readDatagram (buffers [0], DATAGRAM_CAPACITY,
+                                              &m_sources [0]);
+        if (length >= 0)
+            m_datagrams [count++].resize (length);
+    }
+
+    /* Drain the rest of the burst with a single system call */
+    if (count > 0) {
+        struct iovec vectors [RING_SIZE - 1];
+        struct mmsghdr messages [RING_SIZE - 1];
+        struct sockaddr_storage names [RING_SIZE - 1];
+        memset (messages, 0, sizeof (messages));
+
+        for (int i = 0; i < RING_SIZE - 1; ++i) {
+            vectors [i].iov_base = buffers [count + i];
+            vectors [i].iov_len = DATAGRAM_CAPACITY;
+            messages [i].msg_hdr.msg_iov = &vectors [i];
+            messages [i].msg_hdr.msg_iovlen = 1;
+            messages [i].msg_hdr.msg_name = &names [i];
+            messages [i].msg_hdr.msg_namelen = sizeof (names [i]);
+        }
+
+        int received = ::recvmmsg (socket->socketDescriptor(), messages,
+                                   RING_SIZE - 1, MSG_DONTWAIT, Q_NULLPTR);
+
+        for (int i = 0; i < received; ++i) {
+            int length = qMin ((int) messages [i].msg_len, DATAGRAM_CAPACITY);
+            m_sources [count].setAddress ((const sockaddr*) &names [i]);
+            m_datagrams [count++].resize (length);
+        }
+    }
+#else
+    while (count < RING_SIZE && socket->hasPendingDatagrams()) {
+        qint64 length = socket->readDatagram (buffers [count],
+                                              DATAGRAM_CAPACITY,
+                                              &m_sources [count]);
+        if (length < 0)
+            break;
+
+        m_datagrams [count++].resize (length);
+    }
+#endif
+
+    /* Deliver every packet, not only the most recent one */
+    for (int i = 0; i < count; ++i) {
+        m_emittedDatagram = i;
+        emit (this->*signal) (m_datagrams [i]);
+    }
+
+    m_emittedDatagram = -1;
+
+    return count;
+}
+
+/**
+ * Returns \c true if the robot address is still being raced between the
+ * candidate addresses
+ */
+bool Sockets::discoveringRobot() const {
+    return m_robotAddress.isNull() && !m_robotCandidates.isEmpty();
+}
+
+/**
+ * Begins racing the candidate robot addresses: the given host \a name (once
+ * it is resolved), the static 10.TE.AM.2 address, the USB address and the
+ * local computer (for simulations)
+ */
+void Sockets::startRobotDiscovery (const QString& name) {
+    int team = DS_Config::getInstance()->state().team;
+
+    m_robotName = name;
+    m_robotAddress = QHostAddress ("");
+    setRobotDiscoveryTime (-1);
+    m_discoveryClock.restart();
+
+    m_robotCandidates.clear();
+    m_robotCandidates.append (QHostAddress (DS::getStaticIP (10, team, 2)));
+    m_robotCandidates.append (QHostAddress (USB_ROBOT_ADDRESS));
+    m_robotCandidates.append (QHostAddress (QHostAddress::LocalHost));
+    connectSenders();
+
+    if (!name.isEmpty())
+        m_robotLookup->lookup (name);
+}
+
+/**
+ * Uses the sender of the robot packet that is being received as the robot
+ * address (if it is one of the candidate addresses), and registers the time
+ * that it took to find the robot.
+ *
+ * This is called by the \c DriverStation once the protocol has accepted the
+ * packet, so that other programs that send data to the robot input port
+ * cannot take the place of the robot.
+ */
+void Sockets::lockRobotAddress() {
+    if (!discoveringRobot() || m_emittedDatagram < 0)
+        return;
+
+    QHostAddress source = TO_IPV4 (m_sources.at (m_emittedDatagram));
+    if (!m_robotCandidates.contains (source))
+        return;
+
+    setRobotDiscoveryTime (m_discoveryClock.elapsed());
+    qDebug() << "Robot found at" << GET_CONSOLE_IP (source)
+             << "after" << robotDiscoveryTime() << "ms";
+
+    setRobotAddress (source);
+}
+
+/**
+ * Changes the time that it took to find the robot, -1 means that the robot
+ * has not been found yet
+ */
+void Sockets::setRobotDiscoveryTime (qint64 msecs) {
+    QMutexLocker locker (&m_statisticsMutex);
+    m_robotDiscoveryTime = msecs;
+}
+
+/**
+ * Connects (or disconnects) each UDP sender to the current address and
+ * output port of its target
+ */
+void Sockets::connectSenders() {
+    connectSender (m_udpFmsSender, fmsAddress(), m_fmsOutputPort);
+    connectSender (m_udpRadioSender, radioAddress(), m_radioOutputPort);
+
+    /* Do not connect the robot sender while the candidates are raced */
+    if (discoveringRobot())
+        connectSender (m_udpRobotSender, QHostAddress(), m_robotOutputPort);
+    else
+        connectSender (m_udpRobotSender, robotAddress(), m_robotOutputPort);
+}
+
+/**
+ * Registers a send system call that took \a nsecs nanoseconds to hand the
+ * given number of \a datagrams to the kernel
+ */
+void Sockets::registerSend (qint64 nsecs, int datagrams, int errors) {
+    QMutexLocker locker (&m_statisticsMutex);
+
+    m_sendTime += nsecs;
+    m_sendSyscalls += 1;
+    m_sendErrors += errors;
+    m_sentDatagrams += datagrams;
+    m_maxSendTime = qMax (m_maxSendTime, nsecs);
+}
+
+/**
+ * Connects the given UDP \a socket to the given \a address and \a port if
+ * connected senders are enabled, otherwise, the socket is disconnected
+ */
+void Sockets::connectSender (QUdpSocket* socket,
+                             const QHostAddress& address,
+                             int port) {
+    if (!socket)
+        return;
+
+    bool valid = m_connectSenders && !address.isNull() && port > 0;
+
+    if (socket->state() == QAbstractSocket::ConnectedState) {
+        if (valid
+                && socket->peerPort() == port
+                && socket->peerAddress() == address)
+            return;
+
+        socket->abort();
+    }
+
+    if (valid)
+        socket->connectToHost (address, port, QIODevice::WriteOnly);
+}
+
+/**
+ * Sends the given \a data through the given UDP \a socket. If the socket is
+ * connected, the \a address and \a port are ignored.
+ *
+ * While a batch is open, the datagram is queued until \c endBatch() is
+ * called (as long as the queue has room for it).
+ */
+void Sockets::sendDatagram (QUdpSocket* socket,
+                            const QByteArray& data,
+                            const QHostAddress& address,
+                            int port) {
+    if (m_batching && m_outgoingCount < m_outgoing.count()) {
+        Outgoing& datagram = m_outgoing [m_outgoingCount++];
+        datagram.port = port;
+        datagram.data = data;
+        datagram.socket = socket;
+        datagram.address = address;
+        return;
+    }
+
+    qint64 bytes = 0;
+    qint64 start = m_sendClock.nsecsElapsed();
+
+    if (socket->state() == QAbstractSocket::ConnectedState)
+        bytes = socket->write (data);
+    else
+        bytes = socket->writeDatagram (data, address, port);
+
+    registerSend (m_sendClock.nsecsElapsed() - start,
+                  bytes < 0 ? 0 : 1,
+                  bytes < 0 ? 1 : 0);
 }
@@ -9,6 +9,9 @@
 #ifndef _LIB_DS_SOCKETS_H
 #define _LIB_DS_SOCKETS_H
 
+#include <QMutex>
+#include <QVector>
+#include <QElapsedTimer>
 #include <Core/DS_Base.h>
 
 class Lookup;
@@ -21,11 +24,20 @@ class DriverStation;
  * required (for example, when using mDNS targets). As a rule of thumb, this
  * class will broadcast generated packets if we do not know the target IP.
  *
+ * When the robot address is not a literal IP, the robot packets are sent to
+ * every candidate address at once (the resolved mDNS name, 10.TE.AM.2, the
+ * USB address and the local computer). The first candidate that answers
+ * becomes the robot address, until the robot watchdog expires and the race
+ * is started again.
+ *
  * This class is controlled directly by the \c DriverStation, which acts as a
  * man-in-the-middle between the loaded \c Protocol and the \c Sockets class.
  *
  * \note The packets can be sent either with UDP or TCP packets (as defined by
  *       the DS/protocol)
+ *
+ * \note The sockets may live in the network thread, the send statistics and
+ *       the robot discovery time can be obtained from any thread
  */
 class Sockets : public QObject {
     Q_OBJECT
@@ -36,6 +48,17 @@ class Sockets : public QObject {
     void robotPacketReceived (const QByteArray& data);
 
   public:
+    /**
+     * \brief Holds the counters of the UDP send path
+     */
+    struct SendStatistics {
+        qint64 datagrams = 0; /**< Number of datagrams handed to the kernel */
+        qint64 syscalls = 0;  /**< Number of send system calls */
+        qint64 errors = 0;    /**< Number of datagrams that failed to send */
+        qreal average = 0;    /**< Average duration of a send call (in ms) */
+        qreal maximum = 0;    /**< Maximum duration of a send call (in ms) */
+    };
+
     explicit Sockets();
     ~Sockets();
 
@@ -43,8 +66,18 @@ class Sockets : public QObject {
     QHostAddress radioAddress() const;
     QHostAddress robotAddress() const;
 
+    bool connectedSendersEnabled() const;
+    qint64 robotDiscoveryTime() const;
+    SendStatistics sendStatistics() const;
+
   public slots:
+    void endBatch();
+    void beginBatch();
     void performLookups();
+    void lockRobotAddress();
+    void resetSendStatistics();
+    void restartRobotDiscovery();
+    void setConnectedSendersEnabled (bool enabled);
     void setFMSInputPort (int port);
     void setFMSOutputPort (int port);
     void setRadioInputPort (int port);
@@ -72,6 +105,24 @@ class Sockets : public QObject {
     void onRadioLookupFinished (const QString& name, const QHostAddress& address);
     void onRobotLookupFinished (const QString& name, const QHostAddress& address);
 
+  private:
+    typedef void (Sockets::*PacketSignal) (const QByteArray&);
+    int readDatagrams (QUdpSocket* socket, PacketSignal signal);
+
+    bool discoveringRobot() const;
+    void startRobotDiscovery (const QString& name);
+    void setRobotDiscoveryTime (qint64 msecs);
+
+    void connectSenders();
+    void registerSend (qint64 nsecs, int datagrams, int errors);
+    void connectSender (QUdpSocket* socket,
+                        const QHostAddress& address,
+                        int port);
+    void sendDatagram (QUdpSocket* socket,
+                       const QByteArray& data,
+                       const QHostAddress& address,
+                       int port);
+
   private:
     int m_robotIterator;
     int m_fmsOutputPort;
@@ -90,6 +141,35 @@ class Sockets : public QObject {
     Lookup* m_radioLookup;
     Lookup* m_robotLookup;
     DriverStation* m_driverStation;
+    QVector<QByteArray> m_datagrams;
+    QVector<QHostAddress> m_sources;
+    int m_emittedDatagram;
+
+    QString m_robotName;
+    qint64 m_robotDiscoveryTime;
+    QElapsedTimer m_discoveryClock;
+    QVector<QHostAddress> m_robotCandidates;
+
+    struct Outgoing {
+        int port = 0;
+        QByteArray data;
+        QHostAddress address;
+        QUdpSocket* socket = Q_NULLPTR;
+    };
+
+    bool m_batching;
+    bool m_connectSenders;
+    int m_outgoingCount;
+    QVector<Outgoing> m_outgoing;
+
+    mutable QMutex m_statisticsMutex;
+
+    qint64 m_sentDatagrams;
+    qint64 m_sendSyscalls;
+    qint64 m_sendErrors;
+    qint64 m_sendTime;
+    qint64 m_maxSendTime;
+    QElapsedTimer m_sendClock;
 
     QUdpSocket* m_udpFmsSender;
     QTcpSocket* m_tcpFmsSender;
@@ -7,30 +7,63 @@
  */
 
 #include "Watchdog.h"
+#include "WatchdogManager.h"
 
-Watchdog::Watchdog() {
-    connect (&m_timer, SIGNAL (timeout()), this, SIGNAL (expired()));
+/*
+ * Default expiration time (in milliseconds)
+ */
+const int DEFAULT_EXPIRATION_TIME = 1000;
+
+/**
+ * Creates a watchdog that is checked by the given \a manager. The watchdog
+ * becomes a child of the \a manager, so that it follows it to other threads.
+ */
+Watchdog::Watchdog (WatchdogManager* manager) {
+    m_manager = manager;
+    m_expirationTime = DEFAULT_EXPIRATION_TIME;
+    m_lastReset.store (m_manager ? m_manager->elapsed() : 0);
+
+    if (m_manager) {
+        setParent (m_manager);
+        m_manager->add (this);
+    }
+}
+
+Watchdog::~Watchdog() {
+    if (m_manager)
+        m_manager->remove (this);
 }
 
 /**
  * Returns the expiration time of the watchdog in milliseconds
  */
 int Watchdog::expirationTime() const {
-    return m_timer.interval();
+    return m_expirationTime;
+}
+
+/**
+ * Returns the time (on the clock of the manager) in which the watchdog was
+ * last reset
+ */
+qint64 Watchdog::lastReset() const {
+    return m_lastReset.load();
 }
 
 /**
  * Resets the watchdog and prevents it from expiring
  */
 void Watchdog::reset() {
-    m_timer.stop();
-    m_timer.start (expirationTime());
+    if (m_manager)
+        m_lastReset.store (m_manager->elapsed());
 }
 
 /**
  * Changes the expiration time and resets the watchdog
  */
 void Watchdog::setExpirationTime (int msecs) {
-    m_timer.setInterval (msecs);
+    m_expirationTime = msecs;
     reset();
+
+    if (m_manager)
+        m_manager->reschedule (this);
 }
@@ -9,17 +9,22 @@
 #ifndef _LIB_DS_WATCHDOG_H
 #define _LIB_DS_WATCHDOG_H
 
-#include <QTimer>
+#include <QObject>
+#include <QAtomicInteger>
+
+class WatchdogManager;
 
 /**
  * \brief Implements a simple watchdog used to reset comms. when needed.
  *
  * The \c Watchdog class implements a simple software watchdog with the help of
- * the \c QTimer object.
+ * a \c WatchdogManager, which checks all of its watchdogs with a single timer.
  *
  * During normal operation, the program periodically resets the watchdog timer
  * to prevent it from expiring. If, due to an error, the program fails to reset
  * or feed the watchdog, it shall expire and emit the appropriate signals.
+ * Resetting the watchdog only stores a timestamp, so it is cheap enough to be
+ * done for every received packet (and it can be done from any thread).
  *
  * The expiration signal is then received by the current protocol, which in
  * turn will reset itself and try to re-establish communications with the robot
@@ -32,15 +37,22 @@ class Watchdog : public QObject {
     void expired();
 
   public:
-    explicit Watchdog();
+    explicit Watchdog (WatchdogManager* manager);
+    ~Watchdog();
+
     int expirationTime() const;
+    qint64 lastReset() const;
 
   public slots:
     void reset();
     void setExpirationTime (int msecs);
 
   private:
-    QTimer m_timer;
+    int m_expirationTime;
+    WatchdogManager* m_manager;
+    QAtomicInteger<qint64> m_lastReset;
+
+    friend class WatchdogManager;
 };
 
 #endif
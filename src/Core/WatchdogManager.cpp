@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "WatchdogManager.h"
+#include "Watchdog.h"
+
+#include <climits>
+#include <QPointer>
+#include <algorithm>
+
+/**
+ * Orders the heap entries so that the earliest deadline is on top
+ */
+template <typename T>
+static bool LATER (const T& a, const T& b) {
+    return a.deadline > b.deadline;
+}
+
+WatchdogManager::WatchdogManager() {
+    m_clock.start();
+
+    m_timer.setParent (this);
+    m_timer.setSingleShot (true);
+    m_timer.setTimerType (Qt::PreciseTimer);
+
+    connect (&m_timer, SIGNAL (timeout()), this, SLOT (onTimeout()));
+}
+
+/**
+ * Detaches the registered watchdogs, so that they do not try to unregister
+ * themselves from a destroyed manager
+ */
+WatchdogManager::~WatchdogManager() {
+    for (int i = 0; i < m_heap.count(); ++i)
+        m_heap [i].watchdog->m_manager = Q_NULLPTR;
+}
+
+/**
+ * Returns the time (in milliseconds) of the monotonic clock used to feed
+ * the watchdogs. This function is thread-safe.
+ */
+qint64 WatchdogManager::elapsed() const {
+    return m_clock.elapsed();
+}
+
+/**
+ * Returns the number of registered watchdogs
+ */
+int WatchdogManager::count() const {
+    return m_heap.count();
+}
+
+/**
+ * Registers the given \a watchdog, which is checked when its expiration
+ * time has passed since it was last fed
+ */
+void WatchdogManager::add (Watchdog* watchdog) {
+    if (!watchdog)
+        return;
+
+    remove (watchdog);
+    push (watchdog, watchdog->lastReset() + watchdog->expirationTime());
+    schedule();
+}
+
+/**
+ * Unregisters the given \a watchdog
+ */
+void WatchdogManager::remove (Watchdog* watchdog) {
+    for (int i = 0; i < m_heap.count(); ++i) {
+        if (m_heap.at (i).watchdog == watchdog) {
+            m_heap.remove (i);
+            std::make_heap (m_heap.begin(), m_heap.end(), LATER<Entry>);
+            schedule();
+            return;
+        }
+    }
+}
+
+/**
+ * Updates the deadline of the given \a watchdog, this is only needed when
+ * its expiration time is changed (feeding the watchdog does not require it)
+ */
+void WatchdogManager::reschedule (Watchdog* watchdog) {
+    add (watchdog);
+}
+
+/**
+ * Pops every due deadline from the heap. Watchdogs that were fed after their
+ * deadline was pushed are pushed again with their new deadline, the others
+ * expire and are checked again after another expiration time.
+ */
+void WatchdogManager::onTimeout() {
+    qint64 now = elapsed();
+    QVector<QPointer<Watchdog>> expired;
+
+    while (!m_heap.isEmpty() && m_heap.first().deadline <= now) {
+        std::pop_heap (m_heap.begin(), m_heap.end(), LATER<Entry>);
+        Watchdog* watchdog = m_heap.last().watchdog;
+        m_heap.removeLast();
+
+        qint64 deadline = watchdog->lastReset() + watchdog->expirationTime();
+        if (deadline > now)
+            push (watchdog, deadline);
+
+        else {
+            expired.append (watchdog);
+            push (watchdog, now + watchdog->expirationTime());
+        }
+    }
+
+    schedule();
+
+    /* Signals are emitted last, a receiver may add or remove watchdogs */
+    foreach (const QPointer<Watchdog>& watchdog, expired) {
+        if (watchdog)
+            emit watchdog->expired();
+    }
+}
+
+/**
+ * Arms the timer for the earliest deadline of the heap
+ */
+void WatchdogManager::schedule() {
+    if (m_heap.isEmpty()) {
+        m_timer.stop();
+        return;
+    }
+
+    qint64 wait = m_heap.first().deadline - elapsed();
+    m_timer.start (static_cast<int> (qBound (qint64 (0), wait,
+                                             qint64 (INT_MAX))));
+}
+
+/**
+ * Adds the given \a watchdog to the heap with the given \a deadline
+ */
+void WatchdogManager::push (Watchdog* watchdog, qint64 deadline) {
+    Entry entry;
+    entry.deadline = deadline;
+    entry.watchdog = watchdog;
+
+    m_heap.append (entry);
+    std::push_heap (m_heap.begin(), m_heap.end(), LATER<Entry>);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_WATCHDOG_MANAGER_H
+#define _LIB_DS_WATCHDOG_MANAGER_H
+
+#include <QTimer>
+#include <QVector>
+#include <QElapsedTimer>
+
+class Watchdog;
+
+/**
+ * \brief Checks the expiration of many watchdogs with a single timer
+ *
+ * Feeding a watchdog only stores a timestamp of the manager's monotonic
+ * clock, so it does not touch any timer (and can be done from any thread).
+ *
+ * The manager keeps the deadline of each watchdog in a min-heap and arms its
+ * timer for the earliest one. Deadlines are checked lazily: when the timer
+ * fires, a watchdog that was fed in the meantime is simply pushed back to its
+ * new deadline, and a watchdog that was not fed emits its \c expired()
+ * signal. This way, the cost of the watchdogs does not grow with the rate of
+ * the received packets.
+ *
+ * The time is obtained with the \c elapsed() function, which can be
+ * re-implemented to drive the watchdogs with another clock (e.g. in tests).
+ *
+ * \note The watchdogs must live in the same thread as their manager, and
+ *       moving the manager to another thread also moves them.
+ */
+class WatchdogManager : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit WatchdogManager();
+    ~WatchdogManager();
+
+    virtual qint64 elapsed() const;
+    int count() const;
+
+    void add (Watchdog* watchdog);
+    void remove (Watchdog* watchdog);
+    void reschedule (Watchdog* watchdog);
+
+  protected slots:
+    void onTimeout();
+
+  private:
+    void schedule();
+    void push (Watchdog* watchdog, qint64 deadline);
+
+  private:
+    struct Entry {
+        qint64 deadline;
+        Watchdog* watchdog;
+    };
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QVector<Entry> m_heap;
+};
+
+#endif
@@ -20,6 +20,8 @@
 #include "Core/Sockets.h"
 #include "Core/Protocol.h"
 #include "Core/Watchdog.h"
+#include "Core/WatchdogManager.h"
+#include "Core/Scheduler.h"
 #include "Core/DS_Config.h"
 #include "Core/NetConsole.h"
 
@@ -31,15 +33,32 @@
 #include "Protocols/FRC_2015.h"
 #include "Protocols/FRC_2016.h"
 
+//------------------------------------------------------------------------------
+// Import utilities
+//------------------------------------------------------------------------------
+
+#include "Utilities/LogReader.h"
+
 //------------------------------------------------------------------------------
 // Import other Qt Dependencies
 //------------------------------------------------------------------------------
 
 #include <QDir>
 #include <QUrl>
+#include <QThread>
 #include <QFileDialog>
+#include <QJsonArray>
 #include <QDesktopServices>
 
+/**
+ * Identifies the packet streams fired by the scheduler
+ */
+enum Streams {
+    kFMSStream   = 0, /**< Packets sent to the FMS */
+    kRadioStream = 1, /**< Packets sent to the robot radio */
+    kRobotStream = 2, /**< Packets sent to the robot controller */
+};
+
 /**
  * Formats the input message so that it looks nice on a console display widget
  */
@@ -47,6 +66,30 @@ static QString CONSOLE_MESSAGE (const QString& input) {
     return "<font color='#888'>** " + input + "</font>";
 }
 
+/**
+ * Calls the given \a member of the \a object. If the \a object lives in
+ * another thread (e.g. the network thread), the call is queued and this
+ * function blocks until the \a member has been executed by that thread.
+ */
+static void INVOKE (QObject* object, const char* member,
+                    QGenericArgument arg0 = QGenericArgument(),
+                    QGenericArgument arg1 = QGenericArgument()) {
+    Qt::ConnectionType type = Qt::DirectConnection;
+    if (object->thread() != QThread::currentThread())
+        type = Qt::BlockingQueuedConnection;
+
+    QMetaObject::invokeMethod (object, member, type, arg0, arg1);
+}
+
+/**
+ * Registers the given DS enum so that it can be used in queued connections,
+ * both with its qualified and unqualified names (moc uses the latter for the
+ * signals declared in the \c DS_Base class).
+ */
+#define REGISTER_ENUM(ENUM) \
+    qRegisterMetaType<DS::ENUM> ("DS::" #ENUM); \
+    qRegisterMetaType<DS::ENUM> (#ENUM)
+
 /**
  * Ensures that the \a input real respects the given range (\a max, \a min)
  */
@@ -60,6 +103,54 @@ static qreal RANGE (qreal input, qreal max, qreal min) {
     return input;
 }
 
+/**
+ * Converts the given log \a points to a list with the same structure as the
+ * series of the JSON log documents
+ */
+static QVariantList LOG_POINTS (const QVector<LogReader::Point>& points) {
+    QVariantList list;
+
+    foreach (const LogReader::Point& point, points) {
+        QVariantMap map;
+        map.insert ("t", point.time);
+        map.insert ("d", point.value);
+        list.append (map);
+    }
+
+    return list;
+}
+
+/**
+ * Converts the given robot link \a summary to a map, which can be used
+ * by QML and by the other Qt classes
+ */
+static QVariantMap LINK_STATISTICS (const LinkStatistics::Summary& summary) {
+    QVariantMap map;
+    map.insert ("sent", summary.sent);
+    map.insert ("received", summary.received);
+    map.insert ("lost", summary.lost);
+    map.insert ("bursts", summary.bursts);
+    map.insert ("maxBurst", summary.maxBurst);
+    map.insert ("reordered", summary.reordered);
+    map.insert ("duplicated", summary.duplicated);
+    map.insert ("rtt", summary.rtt);
+    map.insert ("rtt99", summary.rtt99);
+    map.insert ("rttMax", summary.rttMax);
+    map.insert ("jitter", summary.jitter);
+    map.insert ("jitter99", summary.jitter99);
+    return map;
+}
+
+/**
+ * Assigns neutral values to every axis, button and POV of the given \a state
+ */
+static void NEUTRALIZE (DS::JoystickState* state) {
+    memset (state, 0, sizeof (DS::JoystickState));
+
+    for (int i = 0; i < DS_MAX_POVS; ++i)
+        state->povs [i] = -1;
+}
+
 DriverStation::DriverStation() {
     qDebug() << "Initializing DriverStation...";
 
@@ -67,6 +158,20 @@ DriverStation::DriverStation() {
     m_init = false;
     m_running = false;
     m_protocol = Q_NULLPTR;
+    m_networkThread = Q_NULLPTR;
+    m_useNetworkThread = false;
+
+    /* Allow DS types to be sent between the network and UI threads */
+    REGISTER_ENUM (Alliance);
+    REGISTER_ENUM (Position);
+    REGISTER_ENUM (SocketType);
+    REGISTER_ENUM (CodeStatus);
+    REGISTER_ENUM (CommStatus);
+    REGISTER_ENUM (ControlMode);
+    REGISTER_ENUM (EnableStatus);
+    REGISTER_ENUM (VoltageStatus);
+    REGISTER_ENUM (OperationStatus);
+    qRegisterMetaType<QHostInfo> ("QHostInfo");
 
     /* Initialzie misc. variables */
     m_packetLoss = 0;
@@ -74,6 +179,10 @@ DriverStation::DriverStation() {
     m_radioInterval = 1000;
     m_robotInterval = 1000;
 
+    /* Neutralize the joystick table */
+    for (int i = 0; i < DS_MAX_JOYSTICKS; ++i)
+        NEUTRALIZE (&m_joystickTable.joysticks [i]);
+
     /* Initialize custom addresses */
     m_customFMSAddress = "";
     m_customRadioAddress = "";
@@ -82,17 +191,43 @@ DriverStation::DriverStation() {
     /* Initialize DS modules & watchdogs */
     m_sockets = new Sockets;
     m_console = new NetConsole;
-    m_fmsWatchdog = new Watchdog;
-    m_radioWatchdog = new Watchdog;
-    m_robotWatchdog = new Watchdog;
-
-    /* React when the sockets receive data from FMS, radio or robot */
+    m_logReader = new LogReader;
+    m_scheduler = new Scheduler;
+    m_watchdogManager = new WatchdogManager;
+    m_fmsWatchdog = new Watchdog (m_watchdogManager);
+    m_radioWatchdog = new Watchdog (m_watchdogManager);
+    m_robotWatchdog = new Watchdog (m_watchdogManager);
+
+    /* React when the sockets receive data from FMS, radio or robot.
+     * Direct connections are used so that the packets are interpreted by the
+     * thread that received them (which may be the network thread) */
     connect (m_sockets, SIGNAL (fmsPacketReceived   (QByteArray)),
-             this,        SLOT (readFMSPacket       (QByteArray)));
+             this,        SLOT (readFMSPacket       (QByteArray)),
+             Qt::DirectConnection);
     connect (m_sockets, SIGNAL (radioPacketReceived (QByteArray)),
-             this,        SLOT (readRadioPacket     (QByteArray)));
+             this,        SLOT (readRadioPacket     (QByteArray)),
+             Qt::DirectConnection);
     connect (m_sockets, SIGNAL (robotPacketReceived (QByteArray)),
-             this,        SLOT (readRobotPacket     (QByteArray)));
+             this,        SLOT (readRobotPacket     (QByteArray)),
+             Qt::DirectConnection);
+
+    /* Send a packet every time that its stream reaches its deadline */
+    connect (m_scheduler, SIGNAL (triggered  (int)),
+             this,          SLOT (sendPacket (int)),
+             Qt::DirectConnection);
+
+    /* Send the packets that fall due in the same tick together */
+    connect (m_scheduler, SIGNAL (batchStarted()),
+             m_sockets,     SLOT (beginBatch()),
+             Qt::DirectConnection);
+    connect (m_scheduler, SIGNAL (batchFinished()),
+             m_sockets,     SLOT (endBatch()),
+             Qt::DirectConnection);
+
+    /* Send one packet per second until a protocol is loaded */
+    m_scheduler->setFrequency (kFMSStream, 1);
+    m_scheduler->setFrequency (kRadioStream, 1);
+    m_scheduler->setFrequency (kRobotStream, 1);
 
     /* Begin the lookup process when the app initializes the DS */
     connect (this, SIGNAL (initialized()), m_sockets, SLOT (performLookups()));
@@ -100,6 +235,8 @@ DriverStation::DriverStation() {
     /* Sync DS signals with DS_Config signals */
     connect (config(), SIGNAL (allianceChanged (Alliance)),
              this,     SIGNAL (allianceChanged (Alliance)));
+    connect (config(), SIGNAL (canUsageChanged (int)),
+             this,     SIGNAL (canUsageChanged (int)));
     connect (config(), SIGNAL (codeStatusChanged (CodeStatus)),
              this,     SIGNAL (codeStatusChanged (CodeStatus)));
     connect (config(), SIGNAL (controlModeChanged (ControlMode)),
@@ -138,6 +275,8 @@ DriverStation::DriverStation() {
              this,     SIGNAL (robotCommStatusChanged (CommStatus)));
     connect (config(), SIGNAL (simulatedChanged (bool)),
              this,     SIGNAL (simulatedChanged (bool)));
+    connect (config(), SIGNAL (stateChanged (int)),
+             this,     SIGNAL (stateChanged (int)));
     connect (config(), SIGNAL (statusChanged (QString)),
              this,     SIGNAL (statusChanged (QString)));
     connect (config(), SIGNAL (teamChanged (int)),
@@ -159,9 +298,12 @@ DriverStation::DriverStation() {
     m_robotWatchdog->setExpirationTime (1000);
 
     /* Reset the DS values when one of the watchdogs is not feed */
-    connect (m_fmsWatchdog,   SIGNAL (expired()), this, SLOT (resetFMS()));
-    connect (m_radioWatchdog, SIGNAL (expired()), this, SLOT (resetRadio()));
-    connect (m_robotWatchdog, SIGNAL (expired()), this, SLOT (resetRobot()));
+    connect (m_fmsWatchdog,   SIGNAL (expired()), this, SLOT (resetFMS()),
+             Qt::DirectConnection);
+    connect (m_radioWatchdog, SIGNAL (expired()), this, SLOT (resetRadio()),
+             Qt::DirectConnection);
+    connect (m_robotWatchdog, SIGNAL (expired()), this, SLOT (resetRobot()),
+             Qt::DirectConnection);
 
     /* Notify client when the NetConsole receives a new message */
     connect (m_console,        SIGNAL (newMessage (QString)),
@@ -178,7 +320,15 @@ DriverStation::DriverStation() {
 
 DriverStation::~DriverStation() {
     stop();
+    qDeleteAll (m_joysticks);
+
+    if (m_networkThread) {
+        m_networkThread->quit();
+        m_networkThread->wait();
+    }
+
     config()->logger()->closeLogs();
+    delete m_logReader;
 }
 
 /**
@@ -305,6 +455,21 @@ bool DriverStation::isRobotCodeRunning() const {
     return robotCodeStatus() == kCodeRunning;
 }
 
+/**
+ * Returns \c true if the sockets, the packet scheduler and the watchdogs are
+ * operated by a dedicated network thread instead of the UI thread
+ */
+bool DriverStation::networkThreadEnabled() const {
+    return m_useNetworkThread;
+}
+
+/**
+ * Returns \c true if the UDP sockets are connected to their targets
+ */
+bool DriverStation::connectedSocketsEnabled() const {
+    return m_sockets->connectedSendersEnabled();
+}
+
 /**
  * Returns the path in which application log files are stored
  */
@@ -327,12 +492,91 @@ QStringList DriverStation::availableLogs() const {
 }
 
 /**
- * Returns the current JSON log document
+ * Returns the summary of the given saved \a log (duration and statistics of
+ * the voltage, packet loss, CPU and RAM usage). The summary is generated
+ * when the log is compacted, so it is empty for the current log.
+ */
+QVariantMap DriverStation::logSummary (const QString& log) const {
+    return config()->logger()->logSummary (log).toVariantMap();
+}
+
+/**
+ * Returns the quality figures of the robot link since the robot connection:
+ *
+ *   - \c sent, \c received: number of sent and answered packets
+ *   - \c lost, \c bursts, \c maxBurst: lost packets and loss bursts
+ *   - \c reordered, \c duplicated: packets that arrived late or twice
+ *   - \c rtt, \c rtt99, \c rttMax: round-trip times in milliseconds
+ *   - \c jitter, \c jitter99: round-trip time variation in milliseconds
+ *
+ * Bursts of lost packets point to a network problem, while round-trip time
+ * spikes without losses point to a busy robot.
+ *
+ * \note This value is updated every 250 milliseconds.
+ */
+QVariantMap DriverStation::robotLinkStatistics() const {
+    return m_robotLinkStatistics;
+}
+
+/**
+ * Returns the current JSON log document.
+ *
+ * \note Binary logs are converted to JSON every time that this function is
+ *       called, use \c logRange() or \c logDownsample() to obtain parts of
+ *       long logs.
  */
 QJsonDocument DriverStation::logDocument() const {
+    if (m_logReader->isOpen())
+        return m_logReader->document();
+
     return m_logDocument;
 }
 
+/**
+ * Returns the recent values of the given event \a series of the running
+ * session with the given \a resolution (0 = raw values, 1 = one second
+ * intervals, 2 = one minute intervals). The series are identified by their
+ * index in the JSON log documents.
+ */
+QVariantList DriverStation::logHistory (int series, int resolution) const {
+    return config()->logger()->history (series, resolution);
+}
+
+/**
+ * Returns the elapsed time (in milliseconds) registered in the current log
+ */
+qint64 DriverStation::logDuration() const {
+    if (m_logReader->isOpen())
+        return m_logReader->duration();
+
+    return m_logDocument.array().at (0).toVariant().toLongLong();
+}
+
+/**
+ * Returns the records of the given \a series of the current log that were
+ * registered between the \a from and \a to times (in milliseconds).
+ * The series are identified by their index in the JSON log document.
+ *
+ * \note Only binary logs support this function
+ */
+QVariantList DriverStation::logRange (int series,
+                                      qint64 from, qint64 to) const {
+    return LOG_POINTS (m_logReader->range (series, from, to));
+}
+
+/**
+ * Returns at most the given number of \a points of the given \a series of
+ * the current log, between the \a from and \a to times (in milliseconds).
+ * The minimum and maximum values of each time interval are kept, which makes
+ * the obtained data suitable for plotting.
+ *
+ * \note Only binary logs support this function
+ */
+QVariantList DriverStation::logDownsample (int series, int points,
+                                           qint64 from, qint64 to) const {
+    return LOG_POINTS (m_logReader->downsample (series, points, from, to));
+}
+
 /**
  * Returns the nominal battery voltage of the robot.
  * This value, along with the \c currentBatteryVoltage() function, can be
@@ -369,6 +613,60 @@ qreal DriverStation::nominalBatteryAmperage() const {
     return 0;
 }
 
+/**
+ * Returns the average delay (in milliseconds) between the moment in which a
+ * FMS packet should have been sent and the moment in which it was sent.
+ */
+qreal DriverStation::fmsPacketJitter() const {
+    return m_scheduler->jitter (kFMSStream).average;
+}
+
+/**
+ * Returns the average delay (in milliseconds) between the moment in which a
+ * radio packet should have been sent and the moment in which it was sent.
+ */
+qreal DriverStation::radioPacketJitter() const {
+    return m_scheduler->jitter (kRadioStream).average;
+}
+
+/**
+ * Returns the average delay (in milliseconds) between the moment in which a
+ * robot packet should have been sent and the moment in which it was sent.
+ */
+qreal DriverStation::robotPacketJitter() const {
+    return m_scheduler->jitter (kRobotStream).average;
+}
+
+/**
+ * Returns the average time (in milliseconds) spent by the operating system
+ * in each system call used to send UDP packets.
+ */
+qreal DriverStation::sendLatency() const {
+    return m_sockets->sendStatistics().average;
+}
+
+/**
+ * Returns the time (in milliseconds) that it took to find the robot since the
+ * robot discovery was (re)started, or -1 if the robot has not been found
+ */
+qint64 DriverStation::robotDiscoveryTime() const {
+    return m_sockets->robotDiscoveryTime();
+}
+
+/**
+ * Returns the number of system calls used to send UDP packets
+ */
+int DriverStation::sendSyscalls() const {
+    return m_sockets->sendStatistics().syscalls;
+}
+
+/**
+ * Returns the number of UDP packets sent to the FMS, radio and robot
+ */
+int DriverStation::sentDatagrams() const {
+    return m_sockets->sendStatistics().datagrams;
+}
+
 /**
  * Returns the current team number, which can be used by the client application.
  */
@@ -400,6 +698,14 @@ int DriverStation::diskUsage() const {
     return config()->diskUsage();
 }
 
+/**
+ * Returns the current utilization of the robot CAN bus.
+ * Value range is from 0 to 100.
+ */
+int DriverStation::canUsage() const {
+    return config()->canUsage();
+}
+
 /**
  * Returns the current packet loss percentage (from 0 to 100).
  * \note This value is updated every 250 milliseconds.
@@ -541,6 +847,19 @@ DS_Joysticks* DriverStation::joysticks() {
     return &m_joysticks;
 }
 
+/**
+ * Returns the newest joystick values published by the thread that manages
+ * the joysticks. The returned frame is always consistent, even if the
+ * joysticks are updated while a packet is being generated.
+ *
+ * \note This function must only be called by the thread that generates the
+ *       packets (e.g. the network thread)
+ */
+const DS::JoystickFrame& DriverStation::joystickFrame() {
+    m_joystickFrames.update();
+    return m_joystickFrames.front();
+}
+
 /**
  * Returns the current alliance (red or blue) of the robot.
  */
@@ -797,7 +1116,7 @@ bool DriverStation::registerJoystick (int axes,
     }
 
     /* Joystick limit reached */
-    else if (joystickCount() + 1 > maxJoystickCount()) {
+    else if (joystickCount() + 1 > qMin (maxJoystickCount(), DS_MAX_JOYSTICKS)) {
         qCritical() << "Too many joysticks!";
         qCritical() << "Abort joystick registration";
         return false;
@@ -813,22 +1132,17 @@ bool DriverStation::registerJoystick (int axes,
         joystick->realNumButtons = buttons;
 
         /* Set number of axes, buttons and POVs according to protocol needs */
-        joystick->numAxes = qMin (axes, maxAxisCount());
-        joystick->numPOVs = qMin (povs, maxPOVCount());
-        joystick->numButtons = qMin (buttons, maxButtonCount());
-
-        /* Initialize joystick values */
-        joystick->povs = new int [joystick->numPOVs];
-        joystick->axes = new qreal [joystick->numAxes];
-        joystick->buttons = new bool  [joystick->numButtons];
-
-        /* Neutralize joystick values */
-        for (int i = 0; i < joystick->numAxes; i++)
-            joystick->axes [i] = 0;
-        for (int i = 0; i < joystick->numPOVs; i++)
-            joystick->povs [i] = -1;
-        for (int i = 0; i < joystick->numButtons; i++)
-            joystick->buttons [i] = false;
+        joystick->numAxes = qBound (0, axes, qMin (maxAxisCount(), DS_MAX_AXES));
+        joystick->numPOVs = qBound (0, povs, qMin (maxPOVCount(), DS_MAX_POVS));
+        joystick->numButtons = qBound (0, buttons, qMin (maxButtonCount(),
+                                                         DS_MAX_BUTTONS));
+
+        /* Neutralize joystick values in the joystick table */
+        JoystickState* state = &m_joystickTable.joysticks [joystickCount()];
+        NEUTRALIZE (state);
+        state->numAxes = joystick->numAxes;
+        state->numPOVs = joystick->numPOVs;
+        state->numButtons = joystick->numButtons;
 
         /* That joystick, Scotty, status report! */
         qDebug() << "Joystick registered!";
@@ -838,6 +1152,8 @@ bool DriverStation::registerJoystick (int axes,
                  << joystick->numButtons << "POVs";
 
         joysticks()->append (joystick);
+        m_joystickTable.count = joystickCount();
+        publishJoysticks();
     }
 
     qDebug() << "New joystick count is" << joystickCount();
@@ -863,11 +1179,13 @@ void DriverStation::init() {
         resetFMS();
         resetRadio();
         resetRobot();
-        sendFMSPacket();
-        sendRadioPacket();
-        sendRobotPacket();
         updatePacketLoss();
 
+        if (m_useNetworkThread)
+            startNetworkThread();
+
+        INVOKE (m_scheduler, "start");
+
         DS_Schedule (250, this, SLOT (finishInit()));
 
         qDebug() << "DS engine started!";
@@ -925,14 +1243,39 @@ void DriverStation::disableRobot() {
 void DriverStation::resetJoysticks() {
     qDebug() << "Clearing all joysticks";
 
+    qDeleteAll (m_joysticks);
     joysticks()->clear();
 
+    m_joystickTable.count = 0;
+    for (int i = 0; i < DS_MAX_JOYSTICKS; ++i)
+        NEUTRALIZE (&m_joystickTable.joysticks [i]);
+
+    publishJoysticks();
+
     if (!isConnectedToFMS())
         setEnabled (false);
 
     emit joystickCountChanged (joystickCount());
 }
 
+/**
+ * Changes the maximum age (in days) of the saved logs. Older logs are removed
+ * when the logs of previous sessions are compacted.
+ */
+void DriverStation::setMaximumLogAge (int days) {
+    QMetaObject::invokeMethod (config()->logger(), "setMaximumLogAge",
+                               Qt::QueuedConnection, Q_ARG (int, days));
+}
+
+/**
+ * Changes the maximum size (in bytes) of the saved logs. The oldest logs are
+ * removed when the logs of previous sessions are compacted.
+ */
+void DriverStation::setMaximumLogsSize (qint64 bytes) {
+    QMetaObject::invokeMethod (config()->logger(), "setMaximumLogsSize",
+                               Qt::QueuedConnection, Q_ARG (qint64, bytes));
+}
+
 /**
  * Changes the team number to the given \a team.
  * \note Calling this function will trigger a re-evaluation of the FMS, radio
@@ -995,6 +1338,7 @@ void DriverStation::triggerEmergencyStop() {
  */
 void DriverStation::reconfigureJoysticks() {
     DS_Joysticks list = m_joysticks;
+    m_joysticks.clear();
     resetJoysticks();
 
     qDebug() << "Re-generating joystick list based on protocol preferences";
@@ -1009,14 +1353,24 @@ void DriverStation::reconfigureJoysticks() {
                           joystick->realNumButtons,
                           joystick->realNumPOVs);
     }
+
+    qDeleteAll (list);
 }
 
 /**
  * Removes the joystick at the given \a id
  */
 void DriverStation::removeJoystick (int id) {
-    if (joystickCount() > id) {
-        joysticks()->removeAt (id);
+    if (id >= 0 && joystickCount() > id) {
+        delete joysticks()->takeAt (id);
+
+        /* Shift the joystick table to fill the gap */
+        for (int i = id; i < joystickCount(); ++i)
+            m_joystickTable.joysticks [i] = m_joystickTable.joysticks [i + 1];
+
+        m_joystickTable.count = joystickCount();
+        NEUTRALIZE (&m_joystickTable.joysticks [joystickCount()]);
+        publishJoysticks();
 
         if (!isConnectedToFMS())
             setEnabled (false);
@@ -1034,6 +1388,36 @@ void DriverStation::setEnabled (bool enabled) {
     setEnabled (enabled ? DS::kEnabled : DS::kDisabled);
 }
 
+/**
+ * If \a enabled is set to \c true, the sockets, the packet scheduler and the
+ * watchdogs will be moved to a dedicated thread with elevated priority when
+ * the DS is initialized. Packets are then generated, sent, received and
+ * interpreted by that thread, so that the control loop is not delayed by
+ * the UI (e.g. by a heavy repaint).
+ *
+ * The signals of the \c DriverStation will be emitted from the network
+ * thread, Qt delivers them to the UI with queued connections.
+ *
+ * \note This function must be called before calling \c init()
+ */
+void DriverStation::setNetworkThreadEnabled (bool enabled) {
+    if (m_init) {
+        qWarning() << "Cannot change the network thread after calling init()";
+        return;
+    }
+
+    m_useNetworkThread = enabled;
+}
+
+/**
+ * If \a enabled is set to \c true, the UDP sockets used to send packets
+ * will be connected to the FMS, radio and robot once their addresses are
+ * known, which saves a route lookup on every packet.
+ */
+void DriverStation::setConnectedSocketsEnabled (bool enabled) {
+    INVOKE (m_sockets, "setConnectedSendersEnabled", Q_ARG (bool, enabled));
+}
+
 /**
  * If you are lazy enough to not wanting to use two function calls to
  * change the alliance & position of the robot, we've got you covered!
@@ -1071,11 +1455,18 @@ void DriverStation::setTeamStation (int station) {
 }
 
 /**
- * Opens the given log file \a file and parses it as a JSON document
+ * Opens the given log file \a file. Binary logs are memory-mapped and their
+ * records are decoded on demand, legacy logs are parsed as JSON documents.
  */
 void DriverStation::openLog (const QString& file) {
     m_logDocumentPath = file;
-    m_logDocument = config()->logger()->openLog (file);
+
+    /* Binary logs are read on demand */
+    if (m_logReader->open (file))
+        m_logDocument = QJsonDocument();
+    else
+        m_logDocument = config()->logger()->openLog (file);
+
     emit logFileChanged();
 }
 
@@ -1123,6 +1514,11 @@ void DriverStation::setPosition (Position position) {
  *       new \a protocol.
  */
 void DriverStation::setProtocol (Protocol* protocol) {
+    /* Stop sending data, wait until the network thread stops using the
+     * current protocol */
+    stop();
+    INVOKE (m_scheduler, "stop");
+
     /* Decommission the current protocol */
     if (m_protocol && protocol) {
         qDebug() << "Protocol" << m_protocol->name() << "decommissioned";
@@ -1133,8 +1529,7 @@ void DriverStation::setProtocol (Protocol* protocol) {
         free (m_protocol);
     }
 
-    /* Re-assign the protocol, stop sending data */
-    stop();
+    /* Re-assign the protocol */
     m_protocol = protocol;
 
     /* Update DS config to match new protocol settings */
@@ -1142,17 +1537,26 @@ void DriverStation::setProtocol (Protocol* protocol) {
         qDebug() << "Configuring new protocol...";
 
         /* Update radio, FMS and robot socket types */
-        m_sockets->setFMSSocketType   (m_protocol->fmsSocketType());
-        m_sockets->setRadioSocketType (m_protocol->radioSocketType());
-        m_sockets->setRobotSocketType (m_protocol->robotSocketType());
+        INVOKE (m_sockets, "setFMSSocketType",
+                Q_ARG (DS::SocketType, m_protocol->fmsSocketType()));
+        INVOKE (m_sockets, "setRadioSocketType",
+                Q_ARG (DS::SocketType, m_protocol->radioSocketType()));
+        INVOKE (m_sockets, "setRobotSocketType",
+                Q_ARG (DS::SocketType, m_protocol->robotSocketType()));
 
         /* Update radio, FMS and robot ports */
-        m_sockets->setFMSInputPort    (m_protocol->fmsInputPort());
-        m_sockets->setFMSOutputPort   (m_protocol->fmsOutputPort());
-        m_sockets->setRadioInputPort  (m_protocol->radioInputPort());
-        m_sockets->setRobotInputPort  (m_protocol->robotInputPort());
-        m_sockets->setRadioOutputPort (m_protocol->radioOutputPort());
-        m_sockets->setRobotOutputPort (m_protocol->robotOutputPort());
+        INVOKE (m_sockets, "setFMSInputPort",
+                Q_ARG (int, m_protocol->fmsInputPort()));
+        INVOKE (m_sockets, "setFMSOutputPort",
+                Q_ARG (int, m_protocol->fmsOutputPort()));
+        INVOKE (m_sockets, "setRadioInputPort",
+                Q_ARG (int, m_protocol->radioInputPort()));
+        INVOKE (m_sockets, "setRobotInputPort",
+                Q_ARG (int, m_protocol->robotInputPort()));
+        INVOKE (m_sockets, "setRadioOutputPort",
+                Q_ARG (int, m_protocol->radioOutputPort()));
+        INVOKE (m_sockets, "setRobotOutputPort",
+                Q_ARG (int, m_protocol->robotOutputPort()));
 
         /* Update NetConsole ports */
         m_console->setInputPort (m_protocol->netconsoleInputPort());
@@ -1164,14 +1568,22 @@ void DriverStation::setProtocol (Protocol* protocol) {
         m_robotInterval = 1000 / m_protocol->robotFrequency();
 
         /* Update the watchdog expiration times */
-        m_fmsWatchdog->setExpirationTime (m_fmsInterval * 50);
-        m_radioWatchdog->setExpirationTime (m_radioInterval * 50);
-        m_robotWatchdog->setExpirationTime (m_robotInterval * 50);
-
-        /* Make the intervals smaller to compensate for hardware delay */
-        m_fmsInterval -= static_cast<qreal> (m_fmsInterval) * 0.1;
-        m_radioInterval -= static_cast<qreal> (m_radioInterval) * 0.1;
-        m_robotInterval -= static_cast<qreal> (m_robotInterval) * 0.1;
+        INVOKE (m_fmsWatchdog, "setExpirationTime",
+                Q_ARG (int, m_fmsInterval * 50));
+        INVOKE (m_radioWatchdog, "setExpirationTime",
+                Q_ARG (int, m_radioInterval * 50));
+        INVOKE (m_robotWatchdog, "setExpirationTime",
+                Q_ARG (int, m_robotInterval * 50));
+
+        /* Send the packets at the exact rate defined by the protocol */
+        INVOKE (m_scheduler, "setFrequency", Q_ARG (int, kFMSStream),
+                Q_ARG (qreal, m_protocol->fmsFrequency()));
+        INVOKE (m_scheduler, "setFrequency", Q_ARG (int, kRadioStream),
+                Q_ARG (qreal, m_protocol->radioFrequency()));
+        INVOKE (m_scheduler, "setFrequency", Q_ARG (int, kRobotStream),
+                Q_ARG (qreal, m_protocol->robotFrequency()));
+        INVOKE (m_scheduler, "resetJitter");
+        INVOKE (m_sockets, "resetSendStatistics");
 
         /* Update joystick config. to match protocol requirements */
         reconfigureJoysticks();
@@ -1180,10 +1592,13 @@ void DriverStation::setProtocol (Protocol* protocol) {
         updateAddresses();
 
         /* Release the kraken */
-        start();
         resetFMS();
         resetRadio();
         resetRobot();
+        start();
+
+        if (m_init)
+            INVOKE (m_scheduler, "start");
 
         /* Send a message telling that the protocol has been initialized */
         emit protocolChanged();
@@ -1211,9 +1626,13 @@ void DriverStation::setControlMode (ControlMode mode) {
  *       your request
  */
 void DriverStation::updatePOV (int id, int pov, int angle) {
-    if (joysticks()->count() > abs (id)) {
-        if (joysticks()->at (id)->numPOVs > pov)
-            joysticks()->at (id)->povs [abs (pov)] = angle;
+    if (id >= 0 && joystickCount() > id) {
+        JoystickState* state = &m_joystickTable.joysticks [id];
+
+        if (pov >= 0 && state->numPOVs > pov) {
+            state->povs [pov] = angle;
+            publishJoysticks();
+        }
     }
 }
 
@@ -1235,9 +1654,13 @@ void DriverStation::setEnabled (EnableStatus status) {
  *       your request
  */
 void DriverStation::updateAxis (int id, int axis, qreal value) {
-    if (joysticks()->count() > abs (id)) {
-        if (joysticks()->at (id)->numAxes > axis)
-            joysticks()->at (id)->axes [abs (axis)] = RANGE (value, 1, -1);
+    if (id >= 0 && joystickCount() > id) {
+        JoystickState* state = &m_joystickTable.joysticks [id];
+
+        if (axis >= 0 && state->numAxes > axis) {
+            state->axes [axis] = (DS_SByte) (RANGE (value, 1, -1) * 127);
+            publishJoysticks();
+        }
     }
 }
 
@@ -1249,9 +1672,17 @@ void DriverStation::updateAxis (int id, int axis, qreal value) {
  *       your request
  */
 void DriverStation::updateButton (int id, int button, bool state) {
-    if (joysticks()->count() > abs (id)) {
-        if (joysticks()->at (id)->numButtons > button)
-            joysticks()->at (id)->buttons [abs (button)] = state;
+    if (id >= 0 && joystickCount() > id) {
+        JoystickState* joystick = &m_joystickTable.joysticks [id];
+
+        if (button >= 0 && joystick->numButtons > button) {
+            if (state)
+                joystick->buttons |= (1u << button);
+            else
+                joystick->buttons &= ~(1u << button);
+
+            publishJoysticks();
+        }
     }
 }
 
@@ -1262,7 +1693,7 @@ void DriverStation::updateButton (int id, int button, bool state) {
  */
 void DriverStation::setCustomFMSAddress (const QString& address) {
     m_customFMSAddress = address;
-    m_sockets->setFMSAddress (fmsAddress());
+    INVOKE (m_sockets, "setFMSAddress", Q_ARG (QString, fmsAddress()));
 }
 
 /**
@@ -1272,7 +1703,7 @@ void DriverStation::setCustomFMSAddress (const QString& address) {
  */
 void DriverStation::setCustomRadioAddress (const QString& address) {
     m_customRadioAddress = address;
-    m_sockets->setRadioAddress (radioAddress());
+    INVOKE (m_sockets, "setRadioAddress", Q_ARG (QString, radioAddress()));
 }
 
 /**
@@ -1285,7 +1716,7 @@ void DriverStation::setCustomRadioAddress (const QString& address) {
  */
 void DriverStation::setCustomRobotAddress (const QString& address) {
     m_customRobotAddress = address;
-    m_sockets->setRobotAddress (robotAddress());
+    INVOKE (m_sockets, "setRobotAddress", Q_ARG (QString, robotAddress()));
 }
 
 /**
@@ -1356,6 +1787,9 @@ void DriverStation::resetRobot() {
     config()->updateRobotCodeStatus (kCodeFailing);
     config()->updateRobotCommStatus (kCommsFailing);
 
+    /* Race the robot addresses again, the robot may have changed its link */
+    INVOKE (m_sockets, "restartRobotDiscovery");
+
     emit statusChanged (generalStatus());
 }
 
@@ -1374,8 +1808,6 @@ void DriverStation::finishInit() {
 void DriverStation::sendFMSPacket() {
     if (protocol() && running() && isConnectedToFMS())
         m_sockets->sendToFMS (protocol()->generateFMSPacket());
-
-    DS_Schedule (m_fmsInterval, this, SLOT (sendFMSPacket()));
 }
 
 /**
@@ -1383,9 +1815,9 @@ void DriverStation::sendFMSPacket() {
  * team number.
  */
 void DriverStation::updateAddresses() {
-    m_sockets->setFMSAddress (fmsAddress());
-    m_sockets->setRadioAddress (radioAddress());
-    m_sockets->setRobotAddress (robotAddress());
+    INVOKE (m_sockets, "setFMSAddress", Q_ARG (QString, fmsAddress()));
+    INVOKE (m_sockets, "setRadioAddress", Q_ARG (QString, radioAddress()));
+    INVOKE (m_sockets, "setRobotAddress", Q_ARG (QString, robotAddress()));
 }
 
 /**
@@ -1394,8 +1826,6 @@ void DriverStation::updateAddresses() {
 void DriverStation::sendRadioPacket() {
     if (protocol() && running())
         m_sockets->sendToRadio (protocol()->generateRadioPacket());
-
-    DS_Schedule (m_radioInterval, this, SLOT (sendRadioPacket()));
 }
 
 /**
@@ -1404,12 +1834,31 @@ void DriverStation::sendRadioPacket() {
 void DriverStation::sendRobotPacket() {
     if (protocol() && running())
         m_sockets->sendToRobot (protocol()->generateRobotPacket());
+}
 
-    DS_Schedule (m_robotInterval, this, SLOT (sendRobotPacket()));
+/**
+ * Called by the scheduler when the given packet \a stream reaches its
+ * deadline. This function generates and sends the appropiate packet.
+ */
+void DriverStation::sendPacket (int stream) {
+    switch (stream) {
+    case kFMSStream:
+        sendFMSPacket();
+        break;
+    case kRadioStream:
+        sendRadioPacket();
+        break;
+    case kRobotStream:
+        sendRobotPacket();
+        break;
+    default:
+        break;
+    }
 }
 
 /**
- * Calculates the current packet loss as a percent
+ * Calculates the current packet loss as a percent and obtains the quality
+ * figures of the robot link
  */
 void DriverStation::updatePacketLoss() {
     qreal loss = 0;
@@ -1432,6 +1881,15 @@ void DriverStation::updatePacketLoss() {
     m_packetLoss = static_cast<int> (loss);
     config()->logger()->registerPacketLoss (m_packetLoss);
 
+    /* Update round-trip time, jitter and loss bursts */
+    if (protocol()) {
+        LinkStatistics::Summary link = protocol()->robotLinkStatistics();
+        m_robotLinkStatistics = LINK_STATISTICS (link);
+        config()->logger()->registerRoundTripTime (link.rtt);
+        config()->logger()->registerLinkJitter (link.jitter);
+        emit robotLinkStatisticsChanged (m_robotLinkStatistics);
+    }
+
     /* Schedule next loss calculation */
     DS_Schedule (250, this, SLOT (updatePacketLoss()));
 }
@@ -1453,7 +1911,13 @@ void DriverStation::updateAddresses (int unused) {
  * Used to ensure that the log feed of the UI is constantly updated
  */
 void DriverStation::updateLogs (const QString& file) {
-    if (m_logDocumentPath.isEmpty() || file == m_logDocumentPath)
+    /* Only index the data that was appended to the log */
+    if (file == m_logDocumentPath && m_logReader->isOpen()) {
+        if (m_logReader->refresh())
+            emit logFileChanged();
+    }
+
+    else if (m_logDocumentPath.isEmpty() || file == m_logDocumentPath)
         openLog (file);
 }
 
@@ -1482,11 +1946,16 @@ void DriverStation::readRadioPacket (const QByteArray& data) {
 /**
  * Instructs the current protocol to interpret the given \a data, which
  * was sent by the robot controller.
+ *
+ * While the robot address is being discovered, the sender of the first
+ * packet that the protocol accepts is used as the robot address.
  */
 void DriverStation::readRobotPacket (const QByteArray& data) {
     if (protocol() && running()) {
-        if (protocol()->readRobotPacket (data))
+        if (protocol()->readRobotPacket (data)) {
             m_robotWatchdog->reset();
+            m_sockets->lockRobotAddress();
+        }
     }
 }
 
@@ -1512,6 +1981,36 @@ Protocol* DriverStation::protocol() const {
     return m_protocol;
 }
 
+/**
+ * Copies the joystick table into a new frame and hands it over to the thread
+ * that generates the packets.
+ *
+ * \note The joysticks must be managed by a single thread (e.g. the UI thread
+ *       or an input polling thread)
+ */
+void DriverStation::publishJoysticks() {
+    m_joystickFrames.back() = m_joystickTable;
+    m_joystickFrames.publish();
+}
+
+/**
+ * Moves the sockets, the packet scheduler and the watchdogs to a new thread
+ * with time-critical priority. The protocol is operated by the same thread,
+ * since it is called directly by these modules.
+ */
+void DriverStation::startNetworkThread() {
+    if (m_networkThread)
+        return;
+
+    m_networkThread = new QThread (this);
+    m_sockets->moveToThread (m_networkThread);
+    m_scheduler->moveToThread (m_networkThread);
+    m_watchdogManager->moveToThread (m_networkThread);
+    m_networkThread->start (QThread::TimeCriticalPriority);
+
+    qDebug() << "DS networking operations moved to network thread";
+}
+
 /*
  * This comment is not procesed by Doxygen. If you are reading this, it is
  * because you are reading the code and trying to understand how it works.
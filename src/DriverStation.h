@@ -10,12 +10,17 @@
 #define _LIB_DS_DRIVERSTATION_H
 
 #include <Core/DS_Base.h>
+#include <Utilities/TripleBuffer.h>
 
+class QThread;
 class Sockets;
 class Watchdog;
 class Protocol;
+class Scheduler;
 class DS_Config;
+class LogReader;
 class NetConsole;
+class WatchdogManager;
 
 /**
  * \brief Exposes the functionality of the LibDS to the application
@@ -40,6 +45,7 @@ class DriverStation : public DS_Base {
     void protocolChanged();
     void joystickCountChanged (int count);
     void newMessage (const QString& message);
+    void robotLinkStatisticsChanged (const QVariantMap& statistics);
 
   public:
     static DriverStation* getInstance();
@@ -75,21 +81,40 @@ class DriverStation : public DS_Base {
     Q_INVOKABLE bool isConnectedToRobot() const;
     Q_INVOKABLE bool isConnectedToRadio() const;
     Q_INVOKABLE bool isRobotCodeRunning() const;
+    Q_INVOKABLE bool networkThreadEnabled() const;
+    Q_INVOKABLE bool connectedSocketsEnabled() const;
 
     Q_INVOKABLE QString logsPath() const;
     Q_INVOKABLE QVariant logVariant() const;
     Q_INVOKABLE QStringList availableLogs() const;
+    Q_INVOKABLE QVariantMap logSummary (const QString& log) const;
+    Q_INVOKABLE QVariantMap robotLinkStatistics() const;
     Q_INVOKABLE QJsonDocument logDocument() const;
+    Q_INVOKABLE qint64 logDuration() const;
+    Q_INVOKABLE QVariantList logHistory (int series, int resolution) const;
+    Q_INVOKABLE QVariantList logRange (int series,
+                                       qint64 from, qint64 to) const;
+    Q_INVOKABLE QVariantList logDownsample (int series, int points,
+                                            qint64 from, qint64 to) const;
 
     Q_INVOKABLE qreal maxBatteryVoltage() const;
     Q_INVOKABLE qreal currentBatteryVoltage() const;
     Q_INVOKABLE qreal nominalBatteryAmperage() const;
 
+    Q_INVOKABLE qreal fmsPacketJitter() const;
+    Q_INVOKABLE qreal radioPacketJitter() const;
+    Q_INVOKABLE qreal robotPacketJitter() const;
+    Q_INVOKABLE qreal sendLatency() const;
+    Q_INVOKABLE qint64 robotDiscoveryTime() const;
+
     Q_INVOKABLE int team() const;
     Q_INVOKABLE int cpuUsage() const;
     Q_INVOKABLE int ramUsage() const;
     Q_INVOKABLE int diskUsage() const;
+    Q_INVOKABLE int canUsage() const;
     Q_INVOKABLE int packetLoss() const;
+    Q_INVOKABLE int sendSyscalls() const;
+    Q_INVOKABLE int sentDatagrams() const;
     Q_INVOKABLE int maxPOVCount() const;
     Q_INVOKABLE int maxAxisCount() const;
     Q_INVOKABLE int maxButtonCount() const;
@@ -132,6 +157,8 @@ class DriverStation : public DS_Base {
 
     Q_INVOKABLE bool registerJoystick (int axes, int buttons, int povs);
 
+    const JoystickFrame& joystickFrame();
+
   public slots:
     void init();
     void browseLogs();
@@ -149,7 +176,11 @@ class DriverStation : public DS_Base {
     void reconfigureJoysticks();
     void removeJoystick (int id);
     void setEnabled (bool enabled);
+    void setNetworkThreadEnabled (bool enabled);
+    void setConnectedSocketsEnabled (bool enabled);
     void setTeamStation (int station);
+    void setMaximumLogAge (int days);
+    void setMaximumLogsSize (qint64 bytes);
     void openLog (const QString& file);
     void setProtocolType (int protocol);
     void setAlliance (Alliance alliance);
@@ -176,6 +207,7 @@ class DriverStation : public DS_Base {
     void updateAddresses();
     void sendRadioPacket();
     void sendRobotPacket();
+    void sendPacket (int stream);
     void updatePacketLoss();
     void updateAddresses (int unused);
     void updateLogs (const QString& file);
@@ -197,8 +229,11 @@ class DriverStation : public DS_Base {
     int m_robotInterval;
 
     QString m_logDocumentPath;
+    QVariantMap m_robotLinkStatistics;
 
     DS_Joysticks m_joysticks;
+    JoystickFrame m_joystickTable;
+    TripleBuffer<JoystickFrame> m_joystickFrames;
     QString m_customFMSAddress;
     QJsonDocument m_logDocument;
     QString m_customRadioAddress;
@@ -206,14 +241,22 @@ class DriverStation : public DS_Base {
 
     Sockets* m_sockets;
     Protocol* m_protocol;
+    LogReader* m_logReader;
     NetConsole* m_console;
+    Scheduler* m_scheduler;
 
     Watchdog* m_fmsWatchdog;
     Watchdog* m_radioWatchdog;
     Watchdog* m_robotWatchdog;
+    WatchdogManager* m_watchdogManager;
+
+    bool m_useNetworkThread;
+    QThread* m_networkThread;
 
     DS_Config* config() const;
     Protocol* protocol() const;
+    void publishJoysticks();
+    void startNetworkThread();
 };
 
 #endif
@@ -8,6 +8,8 @@
 
 #include "FRC_2014.h"
 
+#include <Utilities/VoltageCodec.h>
+
 /**
  * Constants used to encode the control byte
  */
@@ -43,92 +45,82 @@ enum FMS {
 };
 
 /**
- * Implements the 2009-2014 FRC communication protocol
+ * Packet sizes and joystick limits of the protocol
  */
-FRC_2014::FRC_2014() {
-    m_resync = true;
-    m_restartCode = false;
-    m_rebootRobot = false;
-}
+const int PACKET_SIZE = FRC_2014_Descriptor::ROBOT_PACKET_SIZE;
+const int FMS_STATUS_SIZE = FRC_2014_Descriptor::FMS_STATUS_SIZE;
+const int ROBOT_STATUS_SIZE = FRC_2014_Descriptor::ROBOT_STATUS_SIZE;
+const int MAX_AXES = FRC_2014_Descriptor::MAX_AXIS_COUNT;
+const int MAX_BUTTONS = FRC_2014_Descriptor::MAX_BUTTON_COUNT;
+const int MAX_JOYSTICKS = FRC_2014_Descriptor::MAX_JOYSTICK_COUNT;
 
 /**
- * Returns the display name of the protocol
+ * Position and size of the data of each joystick in the robot packet
  */
-QString FRC_2014::name() {
-    return QObject::tr ("FRC 2014 Protocol");
-}
+const int JOYSTICK_OFFSET = 8;
+const int JOYSTICK_SIZE = MAX_AXES + 2;
 
 /**
- * Send 10 FMS packets per second
+ * Number of bytes that may change between robot packets (index, operation
+ * code, digital inputs, team, alliance, position and joystick data).
+ * The rest of the packet is constant, except for the checksum.
  */
-int FRC_2014::fmsFrequency() {
-    return 10;
-}
+const int DYNAMIC_SIZE = 40;
 
 /**
- * Send 50 robot packets per second
+ * Position of the CRC32 checksum in the robot packet
  */
-int FRC_2014::robotFrequency() {
-    return 50;
-}
+const int CHECKSUM_OFFSET = 1020;
 
 /**
- * We receive data from FMS at local port 1120
+ * Voltage reported by simulated robots (in centivolts)
  */
-int FRC_2014::fmsInputPort() {
-    return 1120;
-}
+const quint16 SIMULATED_VOLTAGE = 1243;
 
-/**
- * We send data to the FMS to remote port 1160
- */
-int FRC_2014::fmsOutputPort() {
-    return 1160;
-}
+/* Every joystick must fit in the dynamic part of the packet */
+Q_STATIC_ASSERT (JOYSTICK_OFFSET + MAX_JOYSTICKS * JOYSTICK_SIZE
+                 <= DYNAMIC_SIZE);
 
-/**
- * We receive data from the robot at local port 1150
- */
-int FRC_2014::robotInputPort() {
-    return 1150;
-}
+/* The checksum must be in the constant part of the packet */
+Q_STATIC_ASSERT (CHECKSUM_OFFSET >= DYNAMIC_SIZE);
+Q_STATIC_ASSERT (CHECKSUM_OFFSET + 4 <= PACKET_SIZE);
 
-/**
- * We send data to the robot at remote port 1110
- */
-int FRC_2014::robotOutputPort() {
-    return 1110;
-}
+/* Buttons are sent as a short, the echoed index is at bytes 30 and 31 */
+Q_STATIC_ASSERT (MAX_BUTTONS <= 16);
+Q_STATIC_ASSERT (ROBOT_STATUS_SIZE >= 32);
 
 /**
- * FRC 2014 protocol does not use POVs
+ * Implements the 2009-2014 FRC communication protocol
  */
-int FRC_2014::maxPOVCount() {
-    return 0;
-}
+FRC_2014::FRC_2014() {
+    m_resync = true;
+    m_restartCode = false;
+    m_rebootRobot = false;
 
-/**
- * FRC 2014 protocol supports a maximum of 6 axes.
- * Remaining axes will be ignored.
- */
-int FRC_2014::maxAxisCount() {
-    return 6;
-}
+    /* Setup the base packet */
+    m_robotPacket.fill (0x00, PACKET_SIZE);
 
-/**
- * FRC 2014 protocol supports a maximum of 12 buttons.
- * Remaining buttons will be ignored.
- */
-int FRC_2014::maxButtonCount() {
-    return 12;
+    /* Add FRC Driver Station version (same as the one sent by 16.0.1) */
+    m_robotPacket[72] = (DS_UByte) 0x30;
+    m_robotPacket[73] = (DS_UByte) 0x34;
+    m_robotPacket[74] = (DS_UByte) 0x30;
+    m_robotPacket[75] = (DS_UByte) 0x31;
+    m_robotPacket[76] = (DS_UByte) 0x31;
+    m_robotPacket[77] = (DS_UByte) 0x36;
+    m_robotPacket[78] = (DS_UByte) 0x30;
+    m_robotPacket[79] = (DS_UByte) 0x30;
+
+    /* Pre-calculate the checksum of the constant part of the packet */
+    m_tailChecksum = CRC32::checksum (m_robotPacket.constData() + DYNAMIC_SIZE,
+                                      PACKET_SIZE - DYNAMIC_SIZE);
+    m_combineOperator = CRC32::combineOperator (PACKET_SIZE - DYNAMIC_SIZE);
 }
 
 /**
- * FRC 2014 Protocol supports a maximum of 4 joysticks.
- * Remaining joysticks will be ignored.
+ * Returns the display name of the protocol
  */
-int FRC_2014::maxJoystickCount() {
-    return 4;
+QString FRC_2014::name() {
+    return QObject::tr ("FRC 2014 Protocol");
 }
 
 /**
@@ -157,34 +149,6 @@ void FRC_2014::onRobotWatchdogExpired() {
     m_rebootRobot = false;
 }
 
-/**
- * Returns the nominal/maximum voltage given by the robot battery.
- */
-qreal FRC_2014::nominalBatteryVoltage() {
-    return 12.8;
-}
-
-/**
- * Returns the nominal amperage given by the robot battery
- */
-qreal FRC_2014::nominalBatteryAmperage() {
-    return 17;
-}
-
-/**
- * FMS communications work with UDP datagrams
- */
-DS::SocketType FRC_2014::fmsSocketType() {
-    return DS::kSocketTypeUDP;
-}
-
-/**
- * Robot communications work with UDP datagrams
- */
-DS::SocketType FRC_2014::robotSocketType() {
-    return DS::kSocketTypeUDP;
-}
-
 /**
  * Radio is located at 10.TE.AM.1
  */
@@ -211,19 +175,16 @@ QByteArray FRC_2014::getFMSPacket() {
  * Generates a packet that the DS will send to the robot
  */
 QByteArray FRC_2014::getRobotPacket() {
-    QByteArray data;
-
-    /* Setup the base packet */
-    data.resize (1024);
-    data.fill   (0x00);
+    /* Only the first bytes of the base packet are re-written */
+    char* data = m_robotPacket.data();
 
     /* Add packet index */
     data[0] = (sentRobotPackets() & 0xff00) >> 8;
     data[1] = (sentRobotPackets() & 0xff);
 
     /* Add team number */
-    data[4] = (config()->team() & 0xff00) >> 8;
-    data[5] = (config()->team() & 0xff);
+    data[4] = (state().team & 0xff00) >> 8;
+    data[5] = (state().team & 0xff);
 
     /* Add operation code, empty digital input and alliance & position */
     data[2] = getOperationCode();
@@ -232,28 +193,21 @@ QByteArray FRC_2014::getRobotPacket() {
     data[7] = getPosition();
 
     /* Add joystick data */
-    QByteArray joysticks = getJoystickData();
-    data.replace (8, joysticks.length(), joysticks);
+    writeJoystickData (data + JOYSTICK_OFFSET);
 
-    /* Add FRC Driver Station version (same as the one sent by 16.0.1) */
-    data[72] = (DS_UByte) 0x30;
-    data[73] = (DS_UByte) 0x34;
-    data[74] = (DS_UByte) 0x30;
-    data[75] = (DS_UByte) 0x31;
-    data[76] = (DS_UByte) 0x31;
-    data[77] = (DS_UByte) 0x36;
-    data[78] = (DS_UByte) 0x30;
-    data[79] = (DS_UByte) 0x30;
-
-    /* Add CRC checksum */
-    m_crc32.update (data);
-    DS_UByte checksum = m_crc32.value();
-    data[1020] = (checksum & 0xff000000) >> 24;
-    data[1021] = (checksum & 0xff0000) >> 16;
-    data[1022] = (checksum & 0xff00) >> 8;
-    data[1023] = (checksum & 0xff);
+    /* Add CRC checksum (calculated with an empty checksum field), only the
+     * dynamic bytes are processed, the checksum of the constant bytes is
+     * appended to them */
+    quint32 checksum = CRC32::combine (CRC32::checksum (data, DYNAMIC_SIZE),
+                                       m_tailChecksum,
+                                       m_combineOperator);
 
-    return data;
+    data[CHECKSUM_OFFSET + 0] = (checksum & 0xff000000) >> 24;
+    data[CHECKSUM_OFFSET + 1] = (checksum & 0xff0000) >> 16;
+    data[CHECKSUM_OFFSET + 2] = (checksum & 0xff00) >> 8;
+    data[CHECKSUM_OFFSET + 3] = (checksum & 0xff);
+
+    return m_robotPacket;
 }
 
 /**
@@ -261,7 +215,7 @@ QByteArray FRC_2014::getRobotPacket() {
  */
 bool FRC_2014::interpretFMSPacket (const QByteArray& data) {
     /* The packet is smaller than what it should be */
-    if (data.length() < 74) {
+    if (data.length() < FMS_STATUS_SIZE) {
         qWarning() << name() << "received an invalid FMS packet";
         return false;
     }
@@ -317,7 +271,7 @@ bool FRC_2014::interpretFMSPacket (const QByteArray& data) {
  */
 bool FRC_2014::interpretRobotPacket (const QByteArray& data) {
     /* The packet is smaller than what it should be */
-    if (data.length() < 1024) {
+    if (data.length() < ROBOT_STATUS_SIZE) {
         qWarning() << name() << "received an invalid robot packet";
         return false;
     }
@@ -327,14 +281,8 @@ bool FRC_2014::interpretRobotPacket (const QByteArray& data) {
     DS_UByte integer = data.at (1);
     DS_UByte decimal = data.at (2);
 
-    /* Parse the voltage (which is stored in a strange format) */
-    QString voltage;
-    QByteArray hex = data.toHex();
-    voltage.append (hex.at (2));
-    voltage.append (hex.at (3));
-    voltage.append (".");
-    voltage.append (hex.at (4));
-    voltage.append (hex.at (5));
+    /* The voltage is sent in BCD (e.g. 0x12 0x43 is 12.43 V) */
+    quint16 voltage = VoltageCodec::decodeBCD (integer, decimal);
 
     /* The robot seems to be emergency stopped */
     if (opcode == cEmergencyStopOn && !config()->isEmergencyStopped())
@@ -343,21 +291,33 @@ bool FRC_2014::interpretRobotPacket (const QByteArray& data) {
     /* Update code status & voltage */
     bool hasCode = (integer != 0x37) && (decimal != 0x37);
     config()->setRobotCode (hasCode);
-    config()->updateVoltage (hasCode ? voltage.toDouble() : 0);
+    config()->updateVoltage (hasCode ? VoltageCodec::toVolts (voltage) : 0);
 
-    /* Update simulation status */
+    /* Update simulation status (simulated robots report 12.43 V) */
     if (receivedRobotPackets() > 10)
-        config()->updateSimulated (voltage == "12.43");
+        config()->updateSimulated (voltage == SIMULATED_VOLTAGE);
 
     /* Packet read successfully */
     return true;
 }
 
+/**
+ * Returns the index of the DS packet that the robot is answering to.
+ * The cRIO echoes the index of the DS packet in bytes 30 and 31 of its
+ * status packet.
+ */
+int FRC_2014::robotPacketIndex (const QByteArray& data) {
+    if (data.length() < ROBOT_STATUS_SIZE)
+        return -1;
+
+    return ((DS_UByte) data.at (30) << 8) | (DS_UByte) data.at (31);
+}
+
 /**
  * Returns the code that represents the current alliance color
  */
 DS_UByte FRC_2014::getAlliance() {
-    if (config()->alliance() == DS::kAllianceBlue)
+    if (state().alliance == DS::kAllianceBlue)
         return cAllianceBlue;
 
     return cAllianceRed;
@@ -367,13 +327,13 @@ DS_UByte FRC_2014::getAlliance() {
  * Returns the code that represents the current team position
  */
 DS_UByte FRC_2014::getPosition() {
-    if (config()->position() == DS::kPosition1)
+    if (state().position == DS::kPosition1)
         return cPosition1;
 
-    if (config()->position() == DS::kPosition2)
+    if (state().position == DS::kPosition2)
         return cPosition2;
 
-    if (config()->position() == DS::kPosition3)
+    if (state().position == DS::kPosition3)
         return cPosition3;
 
     return cPosition1;
@@ -392,10 +352,10 @@ DS_UByte FRC_2014::getDigitalInput() {
  */
 DS_UByte FRC_2014::getOperationCode() {
     DS_UByte code = cEmergencyStopOff;
-    DS_UByte enabled = config()->isEnabled() ? cEnabled : 0x00;
+    DS_UByte enabled = state().isEnabled() ? cEnabled : 0x00;
 
     /* Get the control mode (Test, Auto or TeleOp) */
-    switch (config()->controlMode()) {
+    switch (state().controlMode) {
     case DS::kControlTest:
         code |= enabled + cTestMode;
         break;
@@ -415,11 +375,11 @@ DS_UByte FRC_2014::getOperationCode() {
         code |= cResyncComms;
 
     /* Let robot know if we are connected to FMS */
-    if (config()->isFMSAttached())
+    if (state().isFMSAttached())
         code |= cFMS_Attached;
 
     /* Set the emergency stop state */
-    if (config()->isEmergencyStopped())
+    if (state().isEmergencyStopped())
         code = cEmergencyStopOn;
 
     /* Send the reboot code if required */
@@ -430,46 +390,32 @@ DS_UByte FRC_2014::getOperationCode() {
 }
 
 /**
- * Generates the joystick data. The FRC protocol defines joystick values
- * for all joysticks, regardless if all joysticks are connected or not.
+ * Writes the joystick data to the given \a data pointer. The FRC protocol
+ * defines joystick values for all joysticks, regardless if all joysticks are
+ * connected or not.
  *
  * In the case that a joystick is not connected, the protocol will send
  * a netrual value (e.g. \c 0 for each axis and \c false for each button).
  */
-QByteArray FRC_2014::getJoystickData() {
-    QByteArray data;
-
-    for (int i = 0; i < maxJoystickCount(); ++i) {
-        bool joystickExists = joysticks()->count() > i;
+void FRC_2014::writeJoystickData (char* data) {
+    const DS::JoystickFrame& frame = joystickFrame();
 
-        /* Get number of axes & buttons */
-        int numAxes = joystickExists ? joysticks()->at (i)->numAxes : 0;
-        int numButtons = joystickExists ? joysticks()->at (i)->numButtons : 0;
+    for (int i = 0; i < MAX_JOYSTICKS; ++i) {
+        char* joystickData = data + i * JOYSTICK_SIZE;
 
-        /* Add axis values */
-        for (int axis = 0; axis < maxAxisCount(); ++axis) {
-            /* Joystick connected, add real data */
-            if (joystickExists && axis < numAxes)
-                data.append ((DS_SByte) (joysticks()->at (i)->axes [axis] * 127));
+        /* Joystick connected, unused axes and buttons are already neutral */
+        if (i < frame.count) {
+            const DS::JoystickState* joystick = &frame.joysticks [i];
 
-            /* Joystick disconnected, add neutral data */
-            else
-                data.append (static_cast<char> (0x00));
+            memcpy (joystickData, joystick->axes, MAX_AXES);
+            joystickData [MAX_AXES + 0] = (joystick->buttons & 0xff00) >> 8;
+            joystickData [MAX_AXES + 1] = (joystick->buttons & 0xff);
         }
 
-        /* Calculate value of buttons */
-        int button_data = 0;
-        for (int button = 0; button < numButtons; ++button) {
-            if (joystickExists && joysticks()->at (i)->buttons [button])
-                button_data |= static_cast<int> (qPow (2, button));
-        }
-
-        /* Add button data */
-        data.append ((button_data & 0xff00) >> 8);
-        data.append ((button_data & 0xff));
+        /* Joystick disconnected, add neutral data */
+        else
+            memset (joystickData, 0, JOYSTICK_SIZE);
     }
-
-    return data;
 }
 
 /**
@@ -9,46 +9,48 @@
 #ifndef _LIB_DS_FRC_2014_H
 #define _LIB_DS_FRC_2014_H
 
-#include <Core/Protocol.h>
+#include <Core/ProtocolBase.h>
 #include <Utilities/CRC32.h>
 
+/**
+ * \brief Constants of the FRC 2014 communication protocol
+ */
+struct FRC_2014_Descriptor : public ProtocolDescriptor {
+    /* Send 10 FMS packets and 50 robot packets every second */
+    static constexpr int FMS_FREQUENCY = 10;
+    static constexpr int ROBOT_FREQUENCY = 50;
+
+    /* No POVs, 6 axes, 12 buttons and 4 joysticks are supported */
+    static constexpr int MAX_POV_COUNT = 0;
+    static constexpr int MAX_AXIS_COUNT = 6;
+    static constexpr int MAX_BUTTON_COUNT = 12;
+    static constexpr int MAX_JOYSTICK_COUNT = 4;
+
+    /* Network ports */
+    static constexpr int FMS_INPUT_PORT = 1120;
+    static constexpr int FMS_OUTPUT_PORT = 1160;
+    static constexpr int ROBOT_INPUT_PORT = 1150;
+    static constexpr int ROBOT_OUTPUT_PORT = 1110;
+
+    /* Robot packets always have the same size */
+    static constexpr int ROBOT_PACKET_SIZE = 1024;
+    static constexpr int FMS_STATUS_SIZE = 74;
+    static constexpr int ROBOT_STATUS_SIZE = 1024;
+};
+
 /**
  * \brief Implements the FRC 2009-2010 communication protocol
  */
-class FRC_2014 : public Protocol {
+class FRC_2014 : public ProtocolBase<FRC_2014_Descriptor> {
   public:
     explicit FRC_2014();
     virtual QString name();
 
-    /* Packet frequency definitions */
-    virtual int fmsFrequency();
-    virtual int robotFrequency();
-
-    /* Network ports information */
-    virtual int fmsInputPort();
-    virtual int fmsOutputPort();
-    virtual int robotInputPort();
-    virtual int robotOutputPort();
-
-    /* Joystick config */
-    virtual int maxPOVCount();
-    virtual int maxAxisCount();
-    virtual int maxButtonCount();
-    virtual int maxJoystickCount();
-
     /* Diagnostic functions */
     virtual void rebootRobot();
     virtual void restartRobotCode();
     virtual void onRobotWatchdogExpired();
 
-    /* Battery information */
-    virtual qreal nominalBatteryVoltage();
-    virtual qreal nominalBatteryAmperage();
-
-    /* Information regarding socket types */
-    virtual DS::SocketType fmsSocketType();
-    virtual DS::SocketType robotSocketType();
-
     /* Default addresses */
     virtual QString radioAddress();
     virtual QString robotAddress();
@@ -60,13 +62,14 @@ class FRC_2014 : public Protocol {
     /* Packet interpretation functions */
     virtual bool interpretFMSPacket (const QByteArray& data);
     virtual bool interpretRobotPacket (const QByteArray& data);
+    virtual int robotPacketIndex (const QByteArray& data);
 
   protected:
     virtual DS_UByte getAlliance();
     virtual DS_UByte getPosition();
     virtual DS_UByte getDigitalInput();
     virtual DS_UByte getOperationCode();
-    virtual QByteArray getJoystickData();
+    virtual void writeJoystickData (char* data);
     virtual DS::Alliance getAlliance (DS_UByte byte);
     virtual DS::Position getPosition (DS_UByte byte);
 
@@ -76,7 +79,9 @@ class FRC_2014 : public Protocol {
     bool m_restartCode;
     bool m_rebootRobot;
 
-    CRC32 m_crc32;
+    quint32 m_tailChecksum;
+    quint32 m_combineOperator;
+    QByteArray m_robotPacket;
 };
 
 #endif
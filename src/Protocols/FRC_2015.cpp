@@ -8,6 +8,40 @@
 
 #include "FRC_2015.h"
 
+#include <QtNumeric>
+#include <Utilities/PacketWriter.h>
+#include <Utilities/VoltageCodec.h>
+
+/**
+ * Packet sizes and joystick limits of the protocol
+ */
+const int ROBOT_PACKET_CAPACITY = FRC_2015_Descriptor::ROBOT_PACKET_SIZE;
+const int FMS_STATUS_SIZE = FRC_2015_Descriptor::FMS_STATUS_SIZE;
+const int ROBOT_STATUS_SIZE = FRC_2015_Descriptor::ROBOT_STATUS_SIZE;
+const int MAX_POVS = FRC_2015_Descriptor::MAX_POV_COUNT;
+const int MAX_AXES = FRC_2015_Descriptor::MAX_AXIS_COUNT;
+const int MAX_BUTTONS = FRC_2015_Descriptor::MAX_BUTTON_COUNT;
+const int MAX_JOYSTICKS = FRC_2015_Descriptor::MAX_JOYSTICK_COUNT;
+
+/**
+ * Size of the robot packet header (index, tag, control, request and station)
+ * and of the joystick section with every axis and POV supported
+ */
+const int ROBOT_HEADER_SIZE = 6;
+const int MAX_JOYSTICK_SIZE = 7 + MAX_AXES + 2 * MAX_POVS;
+
+/* The header and every joystick must fit in the robot packet buffer */
+Q_STATIC_ASSERT (ROBOT_HEADER_SIZE + MAX_JOYSTICKS * MAX_JOYSTICK_SIZE
+                 <= ROBOT_PACKET_CAPACITY);
+
+/* Joystick sections are sent with a single byte size and buttons as a short */
+Q_STATIC_ASSERT (MAX_JOYSTICK_SIZE <= 0xff);
+Q_STATIC_ASSERT (MAX_BUTTONS <= 16);
+
+/* The station and the robot status (up to the request byte) must be read */
+Q_STATIC_ASSERT (FMS_STATUS_SIZE > 5);
+Q_STATIC_ASSERT (ROBOT_STATUS_SIZE > 7);
+
 /**
  * Holds the control mode flags sent to the robot
  */
@@ -66,6 +100,7 @@ enum Stations {
  * Represents the tags that can be sent by the robot with the extended packets
  */
 enum Robot_Tags {
+    cRTagCanInfo     = 0x0e, /**< Robot program sends CAN metrics */
     cRTagCpuInfo     = 0x05, /**< Robot program sents CPU usage */
     cRTagMemInfo     = 0x06, /**< Robot program sends RAM usage */
     cRTagDiskInfo    = 0x04, /**< Robot program sends disk usage */
@@ -82,121 +117,165 @@ enum Robot_Data {
 };
 
 /**
- * \brief Holds a battery voltage bytes and resultant \c float
- */
-struct BatteryVoltage {
-    qreal voltage;
-    quint16 integer;
-    quint16 decimal;
+ * \brief Iterates over the tagged sections of an extended robot packet
+ *
+ * Each section starts with its size (which does not count the size byte),
+ * followed by its tag and its data. The sections are read in place, and the
+ * iteration stops at the first section that is empty or truncated.
+ */
+class TagIterator {
+  public:
+    TagIterator (const DS_UByte* data, int length) {
+        m_data = data;
+        m_length = 0;
+        m_remaining = length;
+    }
 
-    void updateValues (qreal volt) {
-        voltage = roundf (volt * 100) / 100;
-        integer = static_cast<int> (volt);
-        decimal = (volt - integer) * 100;
+    /**
+     * Moves to the next section, returns \c false if there are no more
+     * complete sections in the packet
+     */
+    bool next() {
+        m_data += m_length;
+        m_remaining -= m_length;
+
+        if (m_remaining < 2 || m_data [0] == 0)
+            return false;
+
+        m_length = m_data [0] + 1;
+        return m_length <= m_remaining;
+    }
+
+    /**
+     * Returns the tag of the current section
+     */
+    DS_UByte tag() const {
+        return m_data [1];
     }
 
-    void updateValues (DS_UByte a, DS_UByte b) {
-        integer = a;
-        decimal = (roundf ((static_cast<qreal> (b) / 255) * 100) / 100) * 100;
-        voltage = integer + (static_cast<qreal> (decimal) / 100);
+    /**
+     * Returns the current section, starting with its size byte
+     */
+    const DS_UByte* section() const {
+        return m_data;
     }
+
+    /**
+     * Returns the length of the current section, including its size byte
+     */
+    int length() const {
+        return m_length;
+    }
+
+  private:
+    int m_length;
+    int m_remaining;
+    const DS_UByte* m_data;
 };
 
 /**
- * Implements the 2015 FRC Communication protocol
+ * Reads a tagged \a section of the given \a length (see \c TagIterator)
  */
-FRC_2015::FRC_2015() {
-    m_restartCode = false;
-    m_rebootRobot = false;
-    m_sendDateTime = false;
-}
+typedef void (*TagReader) (DS_Config* config, const DS_UByte* section,
+                           int length);
 
 /**
- * Returns the display name of the protocol
+ * Used for the tags that are unknown or not supported by the LibDS
  */
-QString FRC_2015::name() {
-    return QObject::tr ("FRC 2015 Protocol");
+static void IGNORE_TAG (DS_Config* config, const DS_UByte* section,
+                        int length) {
+    Q_UNUSED (config);
+    Q_UNUSED (section);
+    Q_UNUSED (length);
 }
 
 /**
- * Send 2 FMS packets every second
+ * Reads the CPU usage, the value of the last CPU is used
  */
-int FRC_2015::fmsFrequency() {
-    return 2;
-}
+static void READ_CPU_INFO (DS_Config* config, const DS_UByte* section,
+                           int length) {
+    int count = length > 2 ? section [2] : 0;
+    int last = qMin (count, length - 12) - 1;
 
-/**
- * Send 50 robot packets every second
- */
-int FRC_2015::robotFrequency() {
-    return 50;
+    if (last >= 0)
+        config->updateCpuUsage (section [last + 12]);
 }
 
 /**
- * We receive data from FMS at local port 1120
+ * Reads the RAM usage
  */
-int FRC_2015::fmsInputPort() {
-    return 1120;
+static void READ_RAM_INFO (DS_Config* config, const DS_UByte* section,
+                           int length) {
+    if (length > 5)
+        config->updateRamUsage (section [5]);
 }
 
 /**
- * We send data to the FMS to remote port 1160
+ * Reads the disk usage
  */
-int FRC_2015::fmsOutputPort() {
-    return 1160;
+static void READ_DISK_INFO (DS_Config* config, const DS_UByte* section,
+                            int length) {
+    if (length > 5)
+        config->updateDiskUsage (section [5]);
 }
 
 /**
- * We receive data from the robot at local port 1150
+ * Reads the CAN bus utilization, which is sent as a big-endian float
+ * (in percent) before the other CAN metrics
  */
-int FRC_2015::robotInputPort() {
-    return 1150;
-}
+static void READ_CAN_INFO (DS_Config* config, const DS_UByte* section,
+                           int length) {
+    if (length < 6)
+        return;
 
-/**
- * We send data to the robot at remote port 1110
- */
-int FRC_2015::robotOutputPort() {
-    return 1110;
-}
+    float utilization;
+    quint32 bits = ((quint32) section [2] << 24) | (section [3] << 16)
+                   | (section [4] << 8) | section [5];
 
-/**
- * We received broadcasted messages from the robot in port 6666
- */
-int FRC_2015::netconsoleInputPort() {
-    return 6666;
+    memcpy (&utilization, &bits, sizeof (utilization));
+    if (!qIsNaN (utilization))
+        config->updateCanUsage (qRound (qBound (0.0f, utilization, 100.0f)));
 }
 
 /**
- * FRC 2015 protocol supports only 1 POV.
- * Remaining POVs will be ignored.
+ * \brief Holds the reader of every possible robot tag
  */
-int FRC_2015::maxPOVCount() {
-    return 1;
-}
+struct TagTable {
+    TagReader readers [256];
+
+    TagTable() {
+        for (int i = 0; i < 256; ++i)
+            readers [i] = IGNORE_TAG;
+
+        /* Joystick rumble is not supported by the LibDS yet */
+        readers [cRTagJoystickOut] = IGNORE_TAG;
+
+        readers [cRTagCanInfo] = READ_CAN_INFO;
+        readers [cRTagCpuInfo] = READ_CPU_INFO;
+        readers [cRTagMemInfo] = READ_RAM_INFO;
+        readers [cRTagDiskInfo] = READ_DISK_INFO;
+    }
+};
 
 /**
- * FRC 2015 protocol supports a maximum of 6 axes.
- * Remaining axes will be ignored.
+ * Dispatch table used to read the extended robot packets
  */
-int FRC_2015::maxAxisCount() {
-    return 6;
-}
+static const TagTable TAG_TABLE;
 
 /**
- * FRC 2015 protocol supports a maximum of 12 buttons.
- * Remaining buttons will be ignored.
+ * Implements the 2015 FRC Communication protocol
  */
-int FRC_2015::maxButtonCount() {
-    return 12;
+FRC_2015::FRC_2015() {
+    m_restartCode = false;
+    m_rebootRobot = false;
+    m_sendDateTime = false;
 }
 
 /**
- * FRC 2015 Protocol supports a maximum of 6 joysticks.
- * Remaining joysticks will be ignored.
+ * Returns the display name of the protocol
  */
-int FRC_2015::maxJoystickCount() {
-    return 6;
+QString FRC_2015::name() {
+    return QObject::tr ("FRC 2015 Protocol");
 }
 
 /**
@@ -223,34 +302,6 @@ void FRC_2015::onRobotWatchdogExpired() {
     m_sendDateTime = false;
 }
 
-/**
- * Returns the nominal/maximum voltage given by the robot battery.
- */
-qreal FRC_2015::nominalBatteryVoltage() {
-    return 12.8;
-}
-
-/**
- * Returns the nominal amperage given by the robot battery
- */
-qreal FRC_2015::nominalBatteryAmperage() {
-    return 17;
-}
-
-/**
- * FMS communications work with UDP datagrams
- */
-DS::SocketType FRC_2015::fmsSocketType() {
-    return DS::kSocketTypeUDP;
-}
-
-/**
- * Robot communications work with UDP datagrams
- */
-DS::SocketType FRC_2015::robotSocketType() {
-    return DS::kSocketTypeUDP;
-}
-
 /**
  * Default radio address is 10.TE.AM.1
  */
@@ -270,18 +321,16 @@ QString FRC_2015::robotAddress() {
  */
 QByteArray FRC_2015::getFMSPacket() {
     QByteArray data;
-    BatteryVoltage voltage;
-
-    voltage.updateValues (config()->voltage());
+    quint16 voltage = VoltageCodec::fromVolts (config()->voltage());
 
     data.append ((sentFMSPackets() & 0xff00) >> 8);
     data.append ((sentFMSPackets()) & 0xff);
     data.append (cFMS_DS_Version);
     data.append (getFMSControlCode());
-    data.append ((config()->team() & 0xff00) >> 8);
-    data.append ((config()->team()) & 0xff);
-    data.append (voltage.integer);
-    data.append (voltage.decimal);
+    data.append ((state().team & 0xff00) >> 8);
+    data.append ((state().team) & 0xff);
+    data.append (voltage / 100);
+    data.append (voltage % 100);
 
     return data;
 }
@@ -290,17 +339,23 @@ QByteArray FRC_2015::getFMSPacket() {
  * Generates a packet that the DS will send to the robot
  */
 QByteArray FRC_2015::getRobotPacket() {
-    QByteArray data;
-
-    data.append ((sentRobotPackets() & 0xff00) >> 8);
-    data.append ((sentRobotPackets()) & 0xff);
-    data.append (cTagGeneral);
-    data.append (getControlCode());
-    data.append (getRequestCode());
-    data.append (getTeamStationCode());
-    data.append (m_sendDateTime ? getTimezoneData() : getJoystickData());
+    /* Re-use the buffer of the previous packet */
+    {
+        PacketWriter writer (&m_robotPacket, ROBOT_PACKET_CAPACITY);
+
+        writer.writeShort (sentRobotPackets());
+        writer.writeByte (cTagGeneral);
+        writer.writeByte (getControlCode());
+        writer.writeByte (getRequestCode());
+        writer.writeByte (getTeamStationCode());
+
+        if (m_sendDateTime)
+            writeTimezoneData (writer);
+        else
+            writeJoystickData (writer);
+    }
 
-    return data;
+    return m_robotPacket;
 }
 
 /**
@@ -312,7 +367,7 @@ QByteArray FRC_2015::getRobotPacket() {
  *   - Change team position
  */
 bool FRC_2015::interpretFMSPacket (const QByteArray& data) {
-    if (data.length() >= 22) {
+    if (data.length() >= FMS_STATUS_SIZE) {
         DS_UByte control = data.at (3);
         DS_UByte station = data.at (5);
 
@@ -350,7 +405,7 @@ bool FRC_2015::interpretFMSPacket (const QByteArray& data) {
  */
 bool FRC_2015::interpretRobotPacket (const QByteArray& data) {
     /* Packet is invalid */
-    if (data.length() < 8) {
+    if (data.length() < ROBOT_STATUS_SIZE) {
         qWarning() << name() << "received an invalid robot packet";
         return false;
     }
@@ -373,19 +428,19 @@ bool FRC_2015::interpretRobotPacket (const QByteArray& data) {
     /* Update emergency stop state */
     config()->setEmergencyStop (e_stopped);
 
-    /* Calculate the voltage */
-    BatteryVoltage voltage;
-    voltage.updateValues (data.at (5), data.at (6));
-    config()->updateVoltage (voltage.voltage);
+    /* Calculate the voltage (sent in 1/256 V units) */
+    quint16 voltage = VoltageCodec::decodeFixedPoint (data.at (5), data.at (6));
+    config()->updateVoltage (VoltageCodec::toVolts (voltage));
 
     /* If voltage is 0, then robot is simulated */
     if (receivedRobotPackets() > 10)
-        config()->updateSimulated (voltage.voltage == 0.00);
+        config()->updateSimulated (voltage == 0);
 
-    /* This is an extended packet, read its extra data */
-    if (data.size() > 8) {
-        std::string extended = std::string (data.constData(), data.length());
-        readExtended (QString::fromStdString (extended.substr (8)).toUtf8());
+    /* This is an extended packet, read its tagged sections in place */
+    if (data.size() > ROBOT_STATUS_SIZE) {
+        const DS_UByte* bytes = (const DS_UByte*) data.constData();
+        readExtended (bytes + ROBOT_STATUS_SIZE,
+                      data.size() - ROBOT_STATUS_SIZE);
     }
 
     /* Packet read, feed the watchdog some meat */
@@ -393,17 +448,27 @@ bool FRC_2015::interpretRobotPacket (const QByteArray& data) {
 }
 
 /**
- * Returns information regarding the current date and time and the timezone
+ * Returns the index of the DS packet that the robot is answering to.
+ * The roboRIO echoes the index of the DS packet in the first two bytes of
+ * its status packet.
+ */
+int FRC_2015::robotPacketIndex (const QByteArray& data) {
+    if (data.length() < ROBOT_STATUS_SIZE)
+        return -1;
+
+    return ((DS_UByte) data.at (0) << 8) | (DS_UByte) data.at (1);
+}
+
+/**
+ * Writes information regarding the current date and time and the timezone
  * of the client computer.
  *
  * The robot may ask for this information in some cases (e.g. when initializing
  * the robot code).
  */
-QByteArray FRC_2015::getTimezoneData() {
-    QByteArray data;
-
+void FRC_2015::writeTimezoneData (PacketWriter& writer) {
     /* Add size (always 11) */
-    data.append (0x0B);
+    writer.writeByte (0x0B);
 
     /* Get current date/time */
     QDateTime dt = QDateTime::currentDateTime();
@@ -411,74 +476,61 @@ QByteArray FRC_2015::getTimezoneData() {
     QTime time = dt.time();
 
     /* Add current date/time */
-    data.append (cTagDate);
-    data.append ((time.msec() & 0xff00) >> 8);
-    data.append ((time.msec()) & 0xff);
-    data.append (time.second());
-    data.append (time.minute());
-    data.append (time.hour());
-    data.append (date.day());
-    data.append (date.month());
-    data.append (date.year() - 1900);
+    writer.writeByte (cTagDate);
+    writer.writeShort (time.msec());
+    writer.writeByte (time.second());
+    writer.writeByte (time.minute());
+    writer.writeByte (time.hour());
+    writer.writeByte (date.day());
+    writer.writeByte (date.month());
+    writer.writeByte (date.year() - 1900);
 
     /* Add timezone data */
-    data.append (DS::timezone().length() + 1);
-    data.append (cTagTimezone);
-    data.append (DS::timezone());
-
-    return data;
+    QByteArray timezone = DS::timezone().toUtf8();
+    writer.writeByte (timezone.length() + 1);
+    writer.writeByte (cTagTimezone);
+    writer.writeBytes (timezone.constData(), timezone.length());
 }
 
 /**
- * Constructs a joystick information structure for every attached joystick.
+ * Writes a joystick information structure for every attached joystick.
  * Unlike the 2014 protocol, the 2015 protocol only generates joystick data
  * for the attached joysticks.
  *
  * This information is separated with a joystick header code (specified at the
  * top of this file).
  */
-QByteArray FRC_2015::getJoystickData() {
-    QByteArray data;
-
+void FRC_2015::writeJoystickData (PacketWriter& writer) {
     /* Do not send joystick data on DS init */
     if (sentRobotPackets() <= 5)
-        return data;
+        return;
 
     /* Generate data for each joystick */
-    for (int i = 0; i < joysticks()->count(); ++i) {
-        int numAxes    = joysticks()->at (i)->numAxes;
-        int numPOVs    = joysticks()->at (i)->numPOVs;
-        int numButtons = joysticks()->at (i)->numButtons;
+    const DS::JoystickFrame& frame = joystickFrame();
+    for (int i = 0; i < frame.count; ++i) {
+        const DS::JoystickState* joystick = &frame.joysticks [i];
 
-        /* Add joystick information and put the section header */
-        data.append (getJoystickSize (*joysticks()->at (i)) - 1);
-        data.append (cTagJoystick);
+        int numAxes    = joystick->numAxes;
+        int numPOVs    = joystick->numPOVs;
+        int numButtons = joystick->numButtons;
 
-        /* Add axis data */
-        data.append (numAxes);
-        for (int axis = 0; axis < numAxes; ++axis)
-            data.append ((DS_SByte) (joysticks()->at (i)->axes [axis] * 127));
+        /* Add joystick information and put the section header */
+        writer.writeByte (getJoystickSize (*joystick) - 1);
+        writer.writeByte (cTagJoystick);
 
-        /* Generate button data */
-        int buttonData = 0;
-        for (int button = 0; button < numButtons; ++button)
-            buttonData += joysticks()->at (i)->buttons [button] ?
-                          qPow (2, button) : 0;
+        /* Add axis data, the axes are already quantized */
+        writer.writeByte (numAxes);
+        writer.writeBytes ((const char*) joystick->axes, numAxes);
 
-        /* Add button data */
-        data.append (numButtons);
-        data.append ((buttonData & 0xff00) >> 8);
-        data.append ((buttonData & 0xff));
+        /* Add button data, the buttons are already packed */
+        writer.writeByte (numButtons);
+        writer.writeShort (joystick->buttons & 0xffff);
 
         /* Add hat/pov data */
-        data.append (numPOVs);
-        for (int hat = 0; hat < numPOVs; ++hat) {
-            data.append ((joysticks()->at (i)->povs [hat] & 0xff00) >> 8);
-            data.append ((joysticks()->at (i)->povs [hat] & 0xff));
-        }
+        writer.writeByte (numPOVs);
+        for (int hat = 0; hat < numPOVs; ++hat)
+            writer.writeShort (joystick->povs [hat]);
     }
-
-    return data;
 }
 
 /**
@@ -520,39 +572,14 @@ DS::Position FRC_2015::getPosition (DS_UByte station) {
 
 /**
  * Sometimes, the roboRIO will send us additional information, such as CPU
- * usage and CAN metrics. This function is in charge of extracting this
- * information from the packet and updating DS values accordingly.
+ * usage and CAN metrics. This function reads every tagged section of the
+ * given \a data and updates the DS values accordingly.
  */
-void FRC_2015::readExtended (const QByteArray& data) {
-    if (data.isEmpty() || data.length() < 2)
-        return;
-
-    DS_UByte tag = data.at (1);
-
-    /* Robot wants to "rumble" the joystick */
-    if (tag == cRTagJoystickOut) {
-        /* TODO */
-    }
-
-    /* Packet contains information about the CPU */
-    else if (tag == cRTagCpuInfo) {
-        int count = data.at (2);
-        for (int i = 0; i < count; ++i)
-            if (data.length() > i + 12)
-                config()->updateCpuUsage (data.at (i + 12));
-    }
-
-    /* Packet contains information about the RAM */
-    else if (tag == cRTagMemInfo) {
-        if (data.length() > 5)
-            config()->updateRamUsage (data.at (5));
-    }
-
-    /* Packat contains information about the CANBUS */
-    else if (tag == cRTagDiskInfo) {
-        if (data.length() > 5)
-            config()->updateDiskUsage (data.at (5));
-    }
+void FRC_2015::readExtended (const DS_UByte* data, int length) {
+    TagIterator tags (data, length);
+    while (tags.next())
+        TAG_TABLE.readers [tags.tag()] (config(), tags.section(),
+                                        tags.length());
 }
 
 /**
@@ -567,7 +594,7 @@ DS_UByte FRC_2015::getControlCode() {
     DS_UByte code = 0;
 
     /* Get current control mode (Test, Auto or Teleop) */
-    switch (config()->controlMode()) {
+    switch (state().controlMode) {
     case DS::kControlTest:
         code |= cTest;
         break;
@@ -582,15 +609,15 @@ DS_UByte FRC_2015::getControlCode() {
     }
 
     /* Let the robot know if we are connected to the FMS */
-    if (config()->isFMSAttached())
+    if (state().isFMSAttached())
         code |= cFMS_Attached;
 
     /* Let the robot know if it should e-stop right now */
-    if (config()->isEmergencyStopped())
+    if (state().isEmergencyStopped())
         code |= cEmergencyStop;
 
     /* Append the robot enabled state */
-    if (config()->isEnabled())
+    if (state().isEnabled())
         code |= cEnabled;
 
     return code;
@@ -607,15 +634,15 @@ DS_UByte FRC_2015::getRequestCode() {
     DS_UByte code = cRequestUnconnected;
 
     /* Send a normal-operation status byte to the robot */
-    if (config()->isConnectedToRobot())
+    if (state().isConnectedToRobot())
         code = cRequestNormal;
 
     /* Send a reboot request byte to the robot */
-    if (config()->isConnectedToRobot() && m_rebootRobot)
+    if (state().isConnectedToRobot() && m_rebootRobot)
         code |= cRequestReboot;
 
     /* Send a restart code request byte to the robot */
-    if (config()->isConnectedToRobot() && m_restartCode)
+    if (state().isConnectedToRobot() && m_restartCode)
         code |= cRequestRestartCode;
 
     return code;
@@ -637,7 +664,7 @@ DS_UByte FRC_2015::getFMSControlCode() {
     DS_UByte code = 0x00;
 
     /* Let the FMS know the operational status of the robot */
-    switch (config()->controlMode()) {
+    switch (state().controlMode) {
     case DS::kControlTest:
         code |= cTest;
         break;
@@ -652,19 +679,19 @@ DS_UByte FRC_2015::getFMSControlCode() {
     }
 
     /* Let the FMS know if robot is e-stopped */
-    if (config()->isEmergencyStopped())
+    if (state().isEmergencyStopped())
         code |= cEmergencyStop;
 
     /* Let the FMS know if the robot is enabled */
-    if (config()->isEnabled())
+    if (state().isEnabled())
         code |= cEnabled;
 
     /* Let the FMS know if we are connected to radio */
-    if (config()->isConnectedToRadio())
+    if (state().isConnectedToRadio())
         code |= cFMS_RadioPing;
 
     /* Let the FMS know if we are connected to robot */
-    if (config()->isConnectedToRobot()) {
+    if (state().isConnectedToRobot()) {
         code |= cFMS_RobotComms;
         code |= cFMS_RobotPing;
     }
@@ -679,24 +706,24 @@ DS_UByte FRC_2015::getFMSControlCode() {
  */
 DS_UByte FRC_2015::getTeamStationCode() {
     /* Current config is set to position 1 */
-    if (config()->position() == DS::kPosition1) {
-        if (config()->alliance() == DS::kAllianceRed)
+    if (state().position == DS::kPosition1) {
+        if (state().alliance == DS::kAllianceRed)
             return cRed1;
         else
             return cBlue1;
     }
 
     /* Current config is set to position 2 */
-    if (config()->position() == DS::kPosition2) {
-        if (config()->alliance() == DS::kAllianceRed)
+    if (state().position == DS::kPosition2) {
+        if (state().alliance == DS::kAllianceRed)
             return cRed2;
         else
             return cBlue2;
     }
 
     /* Current config is set to position 3 */
-    if (config()->position() == DS::kPosition3) {
-        if (config()->alliance() == DS::kAllianceRed)
+    if (state().position == DS::kPosition3) {
+        if (state().alliance == DS::kAllianceRed)
             return cRed3;
         else
             return cBlue3;
@@ -713,7 +740,7 @@ DS_UByte FRC_2015::getTeamStationCode() {
  * This information will help the robot decide where a information starts and
  * ends for each attached joystick.
  */
-DS_UByte FRC_2015::getJoystickSize (const DS::Joystick& joystick) {
+DS_UByte FRC_2015::getJoystickSize (const DS::JoystickState& joystick) {
     return  5
             + (joystick.numAxes > 0 ? joystick.numAxes : 0)
             + (joystick.numButtons / 8)
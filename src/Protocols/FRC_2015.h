@@ -10,46 +10,50 @@
 #define _LIB_DS_FRC_2015_H
 
 #include <QTime>
-#include <Core/Protocol.h>
+#include <Core/ProtocolBase.h>
+
+class PacketWriter;
+
+/**
+ * \brief Constants of the FRC 2015-2019 communication protocol
+ */
+struct FRC_2015_Descriptor : public ProtocolDescriptor {
+    /* Send 2 FMS packets and 50 robot packets every second */
+    static constexpr int FMS_FREQUENCY = 2;
+    static constexpr int ROBOT_FREQUENCY = 50;
+
+    /* Only 1 POV, 6 axes, 12 buttons and 6 joysticks are supported */
+    static constexpr int MAX_POV_COUNT = 1;
+    static constexpr int MAX_AXIS_COUNT = 6;
+    static constexpr int MAX_BUTTON_COUNT = 12;
+    static constexpr int MAX_JOYSTICK_COUNT = 6;
+
+    /* Robot messages are broadcasted to port 6666 */
+    static constexpr int FMS_INPUT_PORT = 1120;
+    static constexpr int FMS_OUTPUT_PORT = 1160;
+    static constexpr int ROBOT_INPUT_PORT = 1150;
+    static constexpr int ROBOT_OUTPUT_PORT = 1110;
+    static constexpr int NETCONSOLE_INPUT_PORT = 6666;
+
+    /* Robot packets are re-used, this is the size of their buffer */
+    static constexpr int ROBOT_PACKET_SIZE = 512;
+    static constexpr int FMS_STATUS_SIZE = 22;
+    static constexpr int ROBOT_STATUS_SIZE = 8;
+};
 
 /**
  * \brief Implements the FRC 2015-2019 communication protocol
  */
-class FRC_2015 : public Protocol {
+class FRC_2015 : public ProtocolBase<FRC_2015_Descriptor> {
   public:
     explicit FRC_2015();
     virtual QString name();
 
-    /* Packet frequency definitions */
-    virtual int fmsFrequency();
-    virtual int robotFrequency();
-
-    /* Network ports information */
-    virtual int fmsInputPort();
-    virtual int fmsOutputPort();
-    virtual int robotInputPort();
-    virtual int robotOutputPort();
-    virtual int netconsoleInputPort();
-
-    /* Joystick config */
-    virtual int maxPOVCount();
-    virtual int maxAxisCount();
-    virtual int maxButtonCount();
-    virtual int maxJoystickCount();
-
     /* Diagnostic functions */
     virtual void rebootRobot();
     virtual void restartRobotCode();
     virtual void onRobotWatchdogExpired();
 
-    /* Battery information */
-    virtual qreal nominalBatteryVoltage();
-    virtual qreal nominalBatteryAmperage();
-
-    /* Information regarding socket types */
-    virtual DS::SocketType fmsSocketType();
-    virtual DS::SocketType robotSocketType();
-
     /* Default addresses */
     virtual QString radioAddress();
     virtual QString robotAddress();
@@ -61,26 +65,29 @@ class FRC_2015 : public Protocol {
     /* Packet interpretation functions */
     virtual bool interpretFMSPacket (const QByteArray& data);
     virtual bool interpretRobotPacket (const QByteArray& data);
+    virtual int robotPacketIndex (const QByteArray& data);
 
   protected:
-    virtual QByteArray getTimezoneData();
-    virtual QByteArray getJoystickData();
+    virtual void writeTimezoneData (PacketWriter& writer);
+    virtual void writeJoystickData (PacketWriter& writer);
 
     virtual DS::Alliance getAlliance (DS_UByte station);
     virtual DS::Position getPosition (DS_UByte station);
 
-    virtual void readExtended (const QByteArray& data);
+    virtual void readExtended (const DS_UByte* data, int length);
 
     virtual DS_UByte getControlCode();
     virtual DS_UByte getRequestCode();
     virtual DS_UByte getFMSControlCode();
     virtual DS_UByte getTeamStationCode();
-    virtual DS_UByte getJoystickSize (const DS::Joystick& joystick);
+    virtual DS_UByte getJoystickSize (const DS::JoystickState& joystick);
 
   private:
     bool m_restartCode;
     bool m_rebootRobot;
     bool m_sendDateTime;
+
+    QByteArray m_robotPacket;
 };
 
 #endif
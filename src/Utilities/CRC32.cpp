@@ -8,58 +8,433 @@
 
 #include "CRC32.h"
 
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#    define CRC32_X86_PCLMUL
+#    include <cpuid.h>
+#    include <smmintrin.h>
+#    include <wmmintrin.h>
+#elif defined (__ARM_FEATURE_CRC32)
+#    define CRC32_ARM
+#    include <arm_acle.h>
+#endif
+
+/**
+ * Reversed representation of the CRC32 polynomial
+ */
+const quint32 POLYNOMIAL = 0xEDB88320;
+
+/**
+ * Minimum number of bytes that are worth processing with the PCLMULQDQ
+ * instruction (the folding algorithm works with blocks of 64 bytes)
+ */
+const int PCLMUL_MIN_LENGTH = 64;
+
+//==============================================================================
+// Compile-time table generation
+//==============================================================================
+
+/**
+ * Processes a single bit of the checksum
+ */
+static constexpr quint32 CRC_BIT (quint32 crc) {
+    return (crc & 1) ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+}
+
+/**
+ * Processes the given number of \a bits of the checksum
+ */
+static constexpr quint32 CRC_BITS (quint32 crc, int bits) {
+    return bits == 0 ? crc : CRC_BITS (CRC_BIT (crc), bits - 1);
+}
+
+/**
+ * Advances the given table \a entry by an additional (zero) byte
+ */
+static constexpr quint32 CRC_SHIFT (quint32 entry) {
+    return (entry >> 8) ^ CRC_BITS (entry & 0xff, 8);
+}
+
+/**
+ * Returns the entry \a n of the slicing-by-8 table \a k. The first table is
+ * the classic byte-wise table, each table after it advances the checksum by
+ * an additional byte.
+ */
+static constexpr quint32 CRC_SLICE (quint32 n, int k) {
+    return k == 0 ? CRC_BITS (n, 8) : CRC_SHIFT (CRC_SLICE (n, k - 1));
+}
+
+#define CRC_ENTRIES_2(n,k)   CRC_SLICE ((n), k), CRC_SLICE ((n) + 1, k)
+#define CRC_ENTRIES_4(n,k)   CRC_ENTRIES_2 ((n), k), CRC_ENTRIES_2 ((n) + 2, k)
+#define CRC_ENTRIES_8(n,k)   CRC_ENTRIES_4 ((n), k), CRC_ENTRIES_4 ((n) + 4, k)
+#define CRC_ENTRIES_16(n,k)  CRC_ENTRIES_8 ((n), k), CRC_ENTRIES_8 ((n) + 8, k)
+#define CRC_ENTRIES_32(n,k)  CRC_ENTRIES_16 ((n), k), CRC_ENTRIES_16 ((n) + 16, k)
+#define CRC_ENTRIES_64(n,k)  CRC_ENTRIES_32 ((n), k), CRC_ENTRIES_32 ((n) + 32, k)
+#define CRC_ENTRIES_128(n,k) CRC_ENTRIES_64 ((n), k), CRC_ENTRIES_64 ((n) + 64, k)
+#define CRC_TABLE(k)         { CRC_ENTRIES_128 (0, k), CRC_ENTRIES_128 (128, k) }
+
+/**
+ * Slicing-by-8 lookup tables, shared by every \c CRC32 instance and
+ * generated by the compiler
+ */
+static constexpr quint32 TABLES [8][256] = {
+    CRC_TABLE (0), CRC_TABLE (1), CRC_TABLE (2), CRC_TABLE (3),
+    CRC_TABLE (4), CRC_TABLE (5), CRC_TABLE (6), CRC_TABLE (7),
+};
+
+//==============================================================================
+// Software implementation
+//==============================================================================
+
+/**
+ * Reads a 32-bit little-endian word from the given \a data
+ */
+static inline quint32 READ_LE32 (const quint8* data) {
+    return static_cast<quint32> (data [0])
+           | static_cast<quint32> (data [1]) << 8
+           | static_cast<quint32> (data [2]) << 16
+           | static_cast<quint32> (data [3]) << 24;
+}
+
+/**
+ * Updates the (inverted) \a crc with the given \a data, one byte at a time
+ */
+static inline quint32 CRC_BYTEWISE (quint32 crc, const quint8* data,
+                                    qint64 length) {
+    while (length-- > 0)
+        crc = TABLES [0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+
+    return crc;
+}
+
+/**
+ * Updates the (inverted) \a crc with the given \a data, eight bytes at a time
+ */
+static quint32 CRC_SLICING_BY_8 (quint32 crc, const quint8* data,
+                                 qint64 length) {
+    while (length >= 8) {
+        quint32 one = crc ^ READ_LE32 (data);
+        quint32 two = READ_LE32 (data + 4);
+
+        crc = TABLES [7][one & 0xff]
+              ^ TABLES [6][(one >> 8) & 0xff]
+              ^ TABLES [5][(one >> 16) & 0xff]
+              ^ TABLES [4][one >> 24]
+              ^ TABLES [3][two & 0xff]
+              ^ TABLES [2][(two >> 8) & 0xff]
+              ^ TABLES [1][(two >> 16) & 0xff]
+              ^ TABLES [0][two >> 24];
+
+        data += 8;
+        length -= 8;
+    }
+
+    return CRC_BYTEWISE (crc, data, length);
+}
+
+//==============================================================================
+// x86 implementation (PCLMULQDQ folding)
+//==============================================================================
+
+#ifdef CRC32_X86_PCLMUL
+
+/**
+ * Updates the (inverted) \a crc with the given \a data by folding 64 bytes at
+ * a time with carry-less multiplications. The \a length must be at least 64
+ * and a multiple of 16.
+ *
+ * Based on "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction" (V. Gopal, E. Ozturk, et al., Intel, 2009), the constants
+ * are the bit-reflected values given at the end of the paper.
+ */
+__attribute__ ((target ("sse4.1,pclmul")))
+static quint32 CRC_PCLMUL_FOLD (quint32 crc, const quint8* data,
+                                qint64 length) {
+    alignas (16) static const quint64 k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+    alignas (16) static const quint64 k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+    alignas (16) static const quint64 k5k0[] = { 0x0163cd6124, 0x0000000000 };
+    alignas (16) static const quint64 poly[] = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    /* Load the first block of 64 bytes */
+    x1 = _mm_loadu_si128 ((const __m128i*) (data + 0x00));
+    x2 = _mm_loadu_si128 ((const __m128i*) (data + 0x10));
+    x3 = _mm_loadu_si128 ((const __m128i*) (data + 0x20));
+    x4 = _mm_loadu_si128 ((const __m128i*) (data + 0x30));
+    x1 = _mm_xor_si128 (x1, _mm_cvtsi32_si128 (crc));
+    x0 = _mm_load_si128 ((const __m128i*) k1k2);
+
+    data += 64;
+    length -= 64;
+
+    /* Fold blocks of 64 bytes in parallel */
+    while (length >= 64) {
+        x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128 (x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128 (x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128 (x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128 (x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128 (x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128 (x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128 ((const __m128i*) (data + 0x00));
+        y6 = _mm_loadu_si128 ((const __m128i*) (data + 0x10));
+        y7 = _mm_loadu_si128 ((const __m128i*) (data + 0x20));
+        y8 = _mm_loadu_si128 ((const __m128i*) (data + 0x30));
+
+        x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x5), y5);
+        x2 = _mm_xor_si128 (_mm_xor_si128 (x2, x6), y6);
+        x3 = _mm_xor_si128 (_mm_xor_si128 (x3, x7), y7);
+        x4 = _mm_xor_si128 (_mm_xor_si128 (x4, x8), y8);
+
+        data += 64;
+        length -= 64;
+    }
+
+    /* Fold the four 128-bit lanes into one */
+    x0 = _mm_load_si128 ((const __m128i*) k3k4);
+
+    x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+    x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+    x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+    x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x4), x5);
+
+    /* Fold the remaining blocks of 16 bytes */
+    while (length >= 16) {
+        x2 = _mm_loadu_si128 ((const __m128i*) data);
+
+        x5 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128 (x1, x0, 0x11);
+        x1 = _mm_xor_si128 (_mm_xor_si128 (x1, x2), x5);
+
+        data += 16;
+        length -= 16;
+    }
+
+    /* Fold 128 bits into 64 bits */
+    x2 = _mm_clmulepi64_si128 (x1, x0, 0x10);
+    x3 = _mm_setr_epi32 (~0, 0, ~0, 0);
+    x1 = _mm_srli_si128 (x1, 8);
+    x1 = _mm_xor_si128 (x1, x2);
+
+    x0 = _mm_loadl_epi64 ((const __m128i*) k5k0);
+
+    x2 = _mm_srli_si128 (x1, 4);
+    x1 = _mm_and_si128 (x1, x3);
+    x1 = _mm_clmulepi64_si128 (x1, x0, 0x00);
+    x1 = _mm_xor_si128 (x1, x2);
+
+    /* Barrett reduction to 32 bits */
+    x0 = _mm_load_si128 ((const __m128i*) poly);
+
+    x2 = _mm_and_si128 (x1, x3);
+    x2 = _mm_clmulepi64_si128 (x2, x0, 0x10);
+    x2 = _mm_and_si128 (x2, x3);
+    x2 = _mm_clmulepi64_si128 (x2, x0, 0x00);
+    x1 = _mm_xor_si128 (x1, x2);
+
+    return static_cast<quint32> (_mm_extract_epi32 (x1, 1));
+}
+
+/**
+ * Returns \c true if the CPU supports the PCLMULQDQ and SSE 4.1 instructions
+ */
+static bool CPU_HAS_PCLMUL() {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    return (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+}
+
+/**
+ * Updates the (inverted) \a crc with the given \a data, using the PCLMULQDQ
+ * instruction for the bulk of the data and slicing-by-8 for the rest
+ */
+static quint32 CRC_HARDWARE (quint32 crc, const quint8* data, qint64 length) {
+    if (length >= PCLMUL_MIN_LENGTH) {
+        qint64 bulk = length & ~static_cast<qint64> (15);
+        crc = CRC_PCLMUL_FOLD (crc, data, bulk);
+        data += bulk;
+        length -= bulk;
+    }
+
+    return CRC_SLICING_BY_8 (crc, data, length);
+}
+
+#endif
+
+//==============================================================================
+// ARM implementation (ARMv8 CRC32 extension)
+//==============================================================================
+
+#ifdef CRC32_ARM
+
+/**
+ * Updates the (inverted) \a crc with the given \a data, using the CRC32
+ * instructions of the ARMv8 CPU
+ */
+static quint32 CRC_HARDWARE (quint32 crc, const quint8* data, qint64 length) {
+    while (length >= 8) {
+        quint64 word = static_cast<quint64> (READ_LE32 (data))
+                       | static_cast<quint64> (READ_LE32 (data + 4)) << 32;
+
+        crc = __crc32d (crc, word);
+        data += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0)
+        crc = __crc32b (crc, *data++);
+
+    return crc;
+}
+
+#endif
+
+//==============================================================================
+// Kernel selection
+//==============================================================================
+
+/**
+ * Function used to update the checksum with a buffer
+ */
+typedef quint32 (*Kernel) (quint32 crc, const quint8* data, qint64 length);
+
+/**
+ * Returns the fastest kernel supported by the current CPU
+ */
+static Kernel SELECT_KERNEL() {
+#if defined (CRC32_X86_PCLMUL)
+    if (CPU_HAS_PCLMUL())
+        return &CRC_HARDWARE;
+#elif defined (CRC32_ARM)
+    return &CRC_HARDWARE;
+#endif
+
+    return &CRC_SLICING_BY_8;
+}
+
 /**
- * Generates the CRC table during initialization
+ * Updates the (inverted) \a crc with the given \a data using the fastest
+ * kernel available (which is selected once, the first time that a checksum
+ * is calculated)
  */
+static quint32 CRC_UPDATE (quint32 crc, const char* data, qint64 length) {
+    static const Kernel kernel = SELECT_KERNEL();
+
+    if (!data || length <= 0)
+        return crc;
+
+    return kernel (crc, reinterpret_cast<const quint8*> (data), length);
+}
+
+//==============================================================================
+// Polynomial arithmetic
+//==============================================================================
+
+/**
+ * Multiplies the polynomials \a a and \a b modulo the CRC32 polynomial.
+ * Both polynomials use the reflected bit order of the checksum, in which
+ * \c x^0 is represented by the most significant bit.
+ */
+static quint32 MULTIPLY (quint32 a, quint32 b) {
+    quint32 m = 1u << 31;
+    quint32 product = 0;
+
+    while (m) {
+        if (a & m)
+            product ^= b;
+
+        m >>= 1;
+        b = CRC_BIT (b);
+    }
+
+    return product;
+}
+
+//==============================================================================
+// CRC32 class
+//==============================================================================
+
 CRC32::CRC32() {
-    make_crc_table();
+    reset();
 }
 
 /**
  * Returns the CRC32 data checksum computed so far.
  */
-long CRC32::value() {
-    return (long) m_crc & 0xFFFFFFFFL;
+quint32 CRC32::value() const {
+    return ~m_crc;
+}
+
+/**
+ * Discards the checksum computed so far
+ */
+void CRC32::reset() {
+    m_crc = 0xFFFFFFFF;
 }
 
 /**
  * Overloaded function. Adds the byte array to the data checksum.
- *
- * @param buf the data buffer
  */
-void CRC32::update (QByteArray buf) {
-    update (buf, 0, buf.length());
+void CRC32::update (const QByteArray& data) {
+    update (data.constData(), data.length());
+}
+
+/**
+ * Adds \a length bytes from the given \a data to the data checksum.
+ */
+void CRC32::update (const char* data, int length) {
+    m_crc = CRC_UPDATE (m_crc, data, length);
+}
+
+/**
+ * Returns the checksum of \a length bytes from the given \a data
+ */
+quint32 CRC32::checksum (const char* data, int length) {
+    return ~CRC_UPDATE (0xFFFFFFFF, data, length);
 }
 
 /**
- * Adds the byte array to the data checksum.
+ * Returns the operator used by \c combine() to append the checksum of a
+ * block of \a length bytes to another checksum (that is, \c x^(8*length)
+ * modulo the CRC32 polynomial).
  *
- * @param buf the data buffer
- * @param off the offset in the buffer where the data starts
- * @param len the length of the data
- */
-void CRC32::update (QByteArray buf, int off, int len) {
-    m_crc = 0;
-    int c = ~m_crc;
-    while (--len >= 0)
-        c = m_crc_table[ (c ^ buf[off++]) & 0xff] ^ (((quint32) c) >> 8);
-    m_crc = ~c;
-}
-
-/**
- * Generates a table for fast CRC
- */
-void CRC32::make_crc_table() {
-    m_crc = 0;
-    m_crc_table = new int[256];
-    for (int n = 0; n < 256; n++) {
-        int c = n;
-        for (int k = 8; --k >= 0;) {
-            if ((c & 1) != 0)
-                c = 0xEDB88320 ^ (((quint32) c) >> 1);
-            else
-                c = ((quint32) c) >> 1;
-        }
-        m_crc_table[n] = c;
+ * This operator only depends on the \a length, so it can be calculated once
+ * for blocks that always have the same size.
+ */
+quint32 CRC32::combineOperator (qint64 length) {
+    quint32 power = 1u << 30;
+    quint32 result = 1u << 31;
+
+    for (qint64 bits = length * 8; bits > 0; bits >>= 1) {
+        if (bits & 1)
+            result = MULTIPLY (power, result);
+
+        power = MULTIPLY (power, power);
     }
+
+    return result;
+}
+
+/**
+ * Returns the checksum of two concatenated blocks, given the checksum of the
+ * \a first block, the checksum of the \a second block and the operator
+ * obtained with \c combineOperator() for the length of the second block.
+ *
+ * This allows calculating the checksum of a packet that only changes in its
+ * first bytes without processing the bytes that never change.
+ */
+quint32 CRC32::combine (quint32 first, quint32 second, quint32 op) {
+    return MULTIPLY (op, first) ^ second;
 }
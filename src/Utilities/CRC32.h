@@ -15,23 +15,31 @@
  * \brief Computes the CRC32 data checksum of a data stream.
  *
  * Can be used to get the CRC32 over a stream if used with checked input/output
- * streams.
+ * streams. Each call to \c update() continues the checksum calculated so far,
+ * call \c reset() to start a new checksum.
+ *
+ * The lookup tables are generated at compile time and shared by all the
+ * instances. Large buffers are processed eight bytes at a time (slicing-by-8),
+ * or with the CRC instructions of the CPU when they are available (PCLMULQDQ
+ * on x86 processors, checked at runtime, and the ARMv8 CRC32 extension when
+ * the library is compiled for it).
  */
 class CRC32 {
   public:
     explicit CRC32();
 
-    long value();
-    void update (QByteArray buf);
-    void update (QByteArray buf, int off, int len);
+    quint32 value() const;
 
-  private:
-    int m_crc;
-    int* m_crc_table;
+    void reset();
+    void update (const QByteArray& data);
+    void update (const char* data, int length);
+
+    static quint32 checksum (const char* data, int length);
+    static quint32 combineOperator (qint64 length);
+    static quint32 combine (quint32 first, quint32 second, quint32 op);
 
   private:
-    void make_crc_table();
+    quint32 m_crc;
 };
 
-
 #endif
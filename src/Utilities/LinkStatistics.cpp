@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "LinkStatistics.h"
+
+#include <QtMath>
+
+/*
+ * Histogram definitions
+ */
+const int SUB_BUCKET_BITS = 4;
+const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+/*
+ * Weight of each sample in the jitter estimate (see RFC 3550, A.8)
+ */
+const qreal JITTER_GAIN = 1.0 / 16;
+
+/**
+ * Returns the index of the most significant bit of the given \a value
+ */
+static inline int MSB (quint64 value) {
+    int msb = 0;
+    while (value >>= 1)
+        ++msb;
+
+    return msb;
+}
+
+LinkStatistics::Histogram::Histogram() {
+    reset();
+}
+
+/**
+ * Removes every recorded value
+ */
+void LinkStatistics::Histogram::reset() {
+    m_sum = 0;
+    m_count = 0;
+    m_minimum = 0;
+    m_maximum = 0;
+
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+        m_buckets [i] = 0;
+}
+
+/**
+ * Records the given \a value, negative values are recorded as zero
+ */
+void LinkStatistics::Histogram::record (qint64 value) {
+    value = qMax (value, (qint64) 0);
+
+    if (m_count == 0 || value < m_minimum)
+        m_minimum = value;
+    if (m_count == 0 || value > m_maximum)
+        m_maximum = value;
+
+    ++m_count;
+    m_sum += value;
+    ++m_buckets [bucket (value)];
+}
+
+/**
+ * Returns the number of recorded values
+ */
+qint64 LinkStatistics::Histogram::count() const {
+    return m_count;
+}
+
+/**
+ * Returns the smallest recorded value
+ */
+qint64 LinkStatistics::Histogram::minimum() const {
+    return m_minimum;
+}
+
+/**
+ * Returns the largest recorded value
+ */
+qint64 LinkStatistics::Histogram::maximum() const {
+    return m_maximum;
+}
+
+/**
+ * Returns the average of the recorded values
+ */
+qreal LinkStatistics::Histogram::average() const {
+    if (m_count > 0)
+        return (qreal) m_sum / m_count;
+
+    return 0;
+}
+
+/**
+ * Returns the value below which the given \a percent of the recorded values
+ * fall. The value is the middle of the bucket that holds the percentile, so
+ * it is as precise as the bucket itself.
+ */
+qint64 LinkStatistics::Histogram::percentile (qreal percent) const {
+    if (m_count == 0)
+        return 0;
+
+    qint64 target = qCeil (qBound (0.0, percent, 100.0) * m_count / 100);
+    target = qMax (target, (qint64) 1);
+
+    qint64 total = 0;
+    for (int i = 0; i < BUCKET_COUNT - 1; ++i) {
+        total += m_buckets [i];
+
+        if (total >= target) {
+            qint64 lower = lowerBound (i);
+            qint64 upper = lowerBound (i + 1) - 1;
+            return qBound (m_minimum, lower + (upper - lower) / 2, m_maximum);
+        }
+    }
+
+    return m_maximum;
+}
+
+/**
+ * Returns the bucket in which the given \a value is recorded
+ */
+int LinkStatistics::Histogram::bucket (qint64 value) {
+    if (value < SUB_BUCKETS)
+        return qMax (value, (qint64) 0);
+
+    int msb = MSB (value);
+    int shift = msb - SUB_BUCKET_BITS;
+    int index = (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS
+                + ((value >> shift) & (SUB_BUCKETS - 1));
+
+    return qMin (index, BUCKET_COUNT - 1);
+}
+
+/**
+ * Returns the smallest value that is recorded in the given \a bucket
+ */
+qint64 LinkStatistics::Histogram::lowerBound (int bucket) {
+    if (bucket < SUB_BUCKETS)
+        return qMax (bucket, 0);
+
+    int shift = bucket / SUB_BUCKETS - 1;
+    qint64 mantissa = SUB_BUCKETS + bucket % SUB_BUCKETS;
+    return mantissa << shift;
+}
+
+LinkStatistics::LinkStatistics() {
+    reset();
+}
+
+/**
+ * Removes every registered packet, this should be called when the link is
+ * re-established
+ */
+void LinkStatistics::reset() {
+    QMutexLocker locker (&m_mutex);
+
+    m_sent = 0;
+    m_lost = 0;
+    m_jitter = 0;
+    m_received = 0;
+    m_lastSent = 0;
+    m_reordered = 0;
+    m_duplicated = 0;
+    m_previousRtt = -1;
+    m_highestReceived = -1;
+
+    m_rtt.reset();
+    m_delta.reset();
+    m_bursts.reset();
+
+    for (int i = 0; i < WINDOW; ++i) {
+        m_slots [i].time = 0;
+        m_slots [i].sequence = -1;
+        m_slots [i].received = false;
+    }
+}
+
+/**
+ * Returns the current link quality figures
+ */
+LinkStatistics::Summary LinkStatistics::summary() const {
+    QMutexLocker locker (&m_mutex);
+
+    Summary summary;
+    summary.sent = m_sent;
+    summary.received = m_received;
+    summary.lost = m_lost;
+    summary.bursts = m_bursts.count();
+    summary.maxBurst = m_bursts.maximum();
+    summary.reordered = m_reordered;
+    summary.duplicated = m_duplicated;
+    summary.rtt = m_rtt.percentile (50) / 1000.0;
+    summary.rtt99 = m_rtt.percentile (99) / 1000.0;
+    summary.rttMax = m_rtt.maximum() / 1000.0;
+    summary.jitter = m_jitter / 1000.0;
+    summary.jitter99 = m_delta.percentile (99) / 1000.0;
+
+    return summary;
+}
+
+/**
+ * Registers that the packet with the given (16-bit) \a index was sent at the
+ * given time (in microseconds)
+ */
+void LinkStatistics::registerSent (quint16 index, qint64 usecs) {
+    QMutexLocker locker (&m_mutex);
+
+    /* Extend the index so that it does not wrap around */
+    if (m_sent == 0)
+        m_lastSent = index;
+    else
+        m_lastSent += (qint16) (index - (quint16) m_lastSent);
+
+    Slot& slot = m_slots [m_lastSent & (WINDOW - 1)];
+    slot.sequence = m_lastSent;
+    slot.time = usecs;
+    slot.received = false;
+
+    ++m_sent;
+}
+
+/**
+ * Registers that the remote end echoed the given (16-bit) packet \a index at
+ * the given time (in microseconds). Indexes of packets that were not sent
+ * recently are ignored.
+ */
+void LinkStatistics::registerReceived (quint16 index, qint64 usecs) {
+    QMutexLocker locker (&m_mutex);
+
+    if (m_sent == 0)
+        return;
+
+    /* Find the packet that the remote end is answering to */
+    qint64 sequence = m_lastSent + (qint16) (index - (quint16) m_lastSent);
+    if (sequence > m_lastSent || sequence <= m_lastSent - WINDOW)
+        return;
+
+    Slot& slot = m_slots [sequence & (WINDOW - 1)];
+    if (slot.sequence != sequence)
+        return;
+
+    if (slot.received) {
+        ++m_duplicated;
+        return;
+    }
+
+    slot.received = true;
+    ++m_received;
+
+    /* Update round-trip time and jitter */
+    qint64 rtt = usecs - slot.time;
+    m_rtt.record (rtt);
+
+    if (m_previousRtt >= 0) {
+        qint64 delta = qAbs (rtt - m_previousRtt);
+        m_delta.record (delta);
+        m_jitter += (delta - m_jitter) * JITTER_GAIN;
+    }
+
+    m_previousRtt = rtt;
+
+    /* A gap in the indexes is a loss burst, an old index is a late packet */
+    if (m_highestReceived < 0)
+        m_highestReceived = sequence;
+
+    else if (sequence > m_highestReceived) {
+        qint64 gap = sequence - m_highestReceived - 1;
+        if (gap > 0) {
+            m_lost += gap;
+            m_bursts.record (gap);
+        }
+
+        m_highestReceived = sequence;
+    }
+
+    else {
+        ++m_reordered;
+        m_lost = qMax (m_lost - 1, (qint64) 0);
+    }
+}
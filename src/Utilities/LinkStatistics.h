@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_LINK_STATISTICS_H
+#define _LIB_DS_LINK_STATISTICS_H
+
+#include <QMutex>
+
+/**
+ * \brief Measures the quality of a link from the packet indexes echoed by the
+ *        remote end
+ *
+ * Each sent packet is registered with its index and its send time, and each
+ * received packet with the index that the remote end echoed back. From that,
+ * the class measures:
+ *
+ *   - The round-trip time of each packet
+ *   - The inter-arrival jitter, estimated as in RFC 3550
+ *   - The length of each burst of lost packets
+ *   - The number of reordered and duplicated packets
+ *
+ * A field network problem usually shows up as bursts of lost packets, while
+ * a stalled robot CPU shows up as a round-trip time spike with few losses.
+ *
+ * The round-trip times, jitter and burst lengths are kept in fixed-size,
+ * log-linear histograms, so that their percentiles can be obtained at any
+ * time without storing the individual samples.
+ *
+ * \note Packets are registered by the network thread and the summary can be
+ *       obtained from any thread
+ */
+class LinkStatistics {
+  public:
+    /**
+     * \brief Log-linear histogram with a fixed number of buckets
+     *
+     * Values below 16 have their own bucket. Above that, every power of two
+     * is split in 16 buckets, so that each value is stored with a relative
+     * error of 6% at most.
+     */
+    class Histogram {
+      public:
+        static const int BUCKET_COUNT = 384;
+
+        explicit Histogram();
+
+        void reset();
+        void record (qint64 value);
+
+        qint64 count() const;
+        qint64 minimum() const;
+        qint64 maximum() const;
+        qreal average() const;
+        qint64 percentile (qreal percent) const;
+
+        static int bucket (qint64 value);
+        static qint64 lowerBound (int bucket);
+
+      private:
+        qint64 m_count;
+        qint64 m_sum;
+        qint64 m_minimum;
+        qint64 m_maximum;
+        quint32 m_buckets [BUCKET_COUNT];
+    };
+
+    /**
+     * \brief Holds the current link quality figures
+     */
+    struct Summary {
+        qint64 sent = 0;        /**< Number of registered sent packets */
+        qint64 received = 0;    /**< Number of matched received packets */
+        qint64 lost = 0;        /**< Number of packets that never arrived */
+        qint64 bursts = 0;      /**< Number of loss bursts */
+        qint64 maxBurst = 0;    /**< Length of the longest loss burst */
+        qint64 reordered = 0;   /**< Number of packets that arrived late */
+        qint64 duplicated = 0;  /**< Number of packets received twice */
+        qreal rtt = 0;          /**< Median round-trip time in ms */
+        qreal rtt99 = 0;        /**< 99th percentile round-trip time in ms */
+        qreal rttMax = 0;       /**< Maximum round-trip time in ms */
+        qreal jitter = 0;       /**< RFC 3550 jitter estimate in ms */
+        qreal jitter99 = 0;     /**< 99th percentile RTT variation in ms */
+    };
+
+    static const int WINDOW = 1024;
+
+    explicit LinkStatistics();
+
+    void reset();
+    Summary summary() const;
+
+    void registerSent (quint16 index, qint64 usecs);
+    void registerReceived (quint16 index, qint64 usecs);
+
+  private:
+    struct Slot {
+        qint64 sequence;
+        qint64 time;
+        bool received;
+    };
+
+    mutable QMutex m_mutex;
+
+    Slot m_slots [WINDOW];
+    qint64 m_sent;
+    qint64 m_received;
+    qint64 m_lost;
+    qint64 m_reordered;
+    qint64 m_duplicated;
+    qint64 m_lastSent;
+    qint64 m_highestReceived;
+    qint64 m_previousRtt;
+    qreal m_jitter;
+
+    Histogram m_rtt;
+    Histogram m_delta;
+    Histogram m_bursts;
+};
+
+#endif
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "LogCompactor.h"
+#include "LogReader.h"
+#include "LogWriter.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QJsonDocument>
+
+#include <limits>
+
+/* Series IDs used in the summary */
+const int ELAPSED_TIME = 0;
+const int CPU_USAGE    = 1;
+const int RAM_USAGE    = 2;
+const int PACKET_LOSS  = 3;
+const int VOLTAGE      = 4;
+const int RTT          = 14;
+const int LINK_JITTER  = 15;
+
+/* Number of elements of the JSON log array (legacy logs only have 14) */
+const int JSON_SERIES = 16;
+
+/**
+ * Holds every record of a log, grouped by series
+ */
+struct LogData {
+    QVector<int> types;
+    QVector<QByteArray> texts;
+    QVector<QVector<LogReader::Point>> points;
+};
+
+/**
+ * Reads all the records of the binary log at the given \a path
+ */
+static bool READ_BINARY (const QString& path, LogData* data, bool* compact) {
+    LogReader reader;
+    if (!reader.open (path))
+        return false;
+
+    *compact = reader.isCompressed();
+
+    int count = reader.seriesCount();
+    data->types.fill (-1, count);
+    data->texts.resize (count);
+    data->points.resize (count);
+
+    for (int i = 0; i < count; ++i) {
+        data->types [i] = reader.type (i);
+
+        if (data->types [i] == LogWriter::kText)
+            data->texts [i] = reader.text (i);
+
+        else if (data->types [i] >= 0)
+            data->points [i] = reader.range (
+                                   i,
+                                   std::numeric_limits<qint64>::min(),
+                                   std::numeric_limits<qint64>::max());
+    }
+
+    return true;
+}
+
+/**
+ * Reads all the records of the legacy JSON log at the given \a path
+ */
+static bool READ_JSON (const QString& path, LogData* data) {
+    QFile file (path);
+    if (!file.open (QFile::ReadOnly))
+        return false;
+
+    QJsonArray array = QJsonDocument::fromJson (file.readAll()).array();
+    file.close();
+
+    if (array.isEmpty())
+        return false;
+
+    data->types.fill (-1, JSON_SERIES);
+    data->texts.resize (JSON_SERIES);
+    data->points.resize (JSON_SERIES);
+
+    /* Elapsed time */
+    LogReader::Point elapsed;
+    elapsed.time = (qint64) array.at (0).toDouble();
+    elapsed.value = elapsed.time;
+    data->types [ELAPSED_TIME] = LogWriter::kInteger;
+    data->points [ELAPSED_TIME].append (elapsed);
+
+    /* Event series and texts */
+    for (int i = 1; i < qMin (array.count(), JSON_SERIES); ++i) {
+        if (array.at (i).isString()) {
+            data->types [i] = LogWriter::kText;
+            data->texts [i] = array.at (i).toString().toUtf8();
+            continue;
+        }
+
+        bool real = (i == VOLTAGE || i == RTT || i == LINK_JITTER);
+        data->types [i] = real ? LogWriter::kReal : LogWriter::kInteger;
+
+        foreach (const QJsonValue& value, array.at (i).toArray()) {
+            LogReader::Point point;
+            point.time = (qint64) value.toObject().value ("t").toDouble();
+            point.value = value.toObject().value ("d").toDouble();
+            data->points [i].append (point);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Reads all the records of the (binary or legacy) log at the given \a path
+ */
+static bool READ_LOG (const QString& path, LogData* data, bool* compact) {
+    *compact = false;
+
+    if (LogReader::isBinaryLog (path))
+        return READ_BINARY (path, data, compact);
+
+    return READ_JSON (path, data);
+}
+
+/**
+ * Returns the minimum, maximum and average values of the given \a series
+ */
+static QJsonObject STATISTICS (const LogData& data, int series) {
+    QJsonObject object;
+    if (series >= data.points.count() || data.points.at (series).isEmpty())
+        return object;
+
+    qreal sum = 0;
+    qreal min = data.points.at (series).first().value;
+    qreal max = min;
+    foreach (const LogReader::Point& point, data.points.at (series)) {
+        sum += point.value;
+        min = qMin (min, point.value);
+        max = qMax (max, point.value);
+    }
+
+    object.insert ("min", min);
+    object.insert ("max", max);
+    object.insert ("avg", sum / data.points.at (series).count());
+    return object;
+}
+
+/**
+ * Generates the summary of the given log \a data
+ */
+static QJsonObject SUMMARY (const LogData& data) {
+    QJsonObject summary;
+
+    qint64 duration = 0;
+    if (!data.points.isEmpty() && !data.points.first().isEmpty())
+        duration = (qint64) data.points.first().last().value;
+
+    summary.insert ("duration", (double) duration);
+    summary.insert ("voltage", STATISTICS (data, VOLTAGE));
+    summary.insert ("cpuUsage", STATISTICS (data, CPU_USAGE));
+    summary.insert ("ramUsage", STATISTICS (data, RAM_USAGE));
+    summary.insert ("packetLoss", STATISTICS (data, PACKET_LOSS));
+    summary.insert ("roundTripTime", STATISTICS (data, RTT));
+    summary.insert ("linkJitter", STATISTICS (data, LINK_JITTER));
+    return summary;
+}
+
+/**
+ * Rewrites the log at the given \a path in its compact form and returns its
+ * summary. Logs that are already compact are not modified. If the log cannot
+ * be read or written, an empty object is returned.
+ */
+QJsonObject LogCompactor::compact (const QString& path) {
+    LogData data;
+    bool compact = false;
+    if (!READ_LOG (path, &data, &compact))
+        return QJsonObject();
+
+    if (compact)
+        return SUMMARY (data);
+
+    /* Write one chunk per series to a temporary file */
+    QString temp = path + ".tmp";
+    QFile::remove (temp);
+
+    LogWriter writer;
+    if (!writer.open (temp))
+        return QJsonObject();
+
+    for (int i = 0; i < data.types.count(); ++i) {
+        if (data.types.at (i) == LogWriter::kText) {
+            if (!data.texts.at (i).isEmpty())
+                writer.append (i, 0, data.texts.at (i));
+        }
+
+        else if (data.types.at (i) == LogWriter::kReal) {
+            foreach (const LogReader::Point& point, data.points.at (i))
+                writer.append (i, point.time, point.value);
+        }
+
+        else if (data.types.at (i) == LogWriter::kInteger) {
+            foreach (const LogReader::Point& point, data.points.at (i))
+                writer.append (i, point.time, (qint64) point.value);
+        }
+    }
+
+    bool written = writer.flush();
+    writer.close();
+
+    /* Compress the chunks */
+    QByteArray chunks;
+    QFile file (temp);
+    if (written && file.open (QFile::ReadOnly)) {
+        chunks = file.readAll();
+        file.close();
+    }
+
+    QFile::remove (temp);
+    if (!LogReader::isBinaryLog (chunks))
+        return QJsonObject();
+
+    QByteArray header = chunks.left (LogWriter::MAGIC_SIZE + 2);
+    header [LogWriter::MAGIC_SIZE + 1] = (char) LogWriter::kCompressed;
+
+    /* Replace the original log */
+    QSaveFile output (path);
+    if (!output.open (QFile::WriteOnly))
+        return QJsonObject();
+
+    output.write (header);
+    output.write (qCompress (chunks.mid (header.size()), 9));
+    if (!output.commit())
+        return QJsonObject();
+
+    return SUMMARY (data);
+}
+
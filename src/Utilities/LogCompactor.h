@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_LOG_COMPACTOR_H
+#define _LIB_DS_LOG_COMPACTOR_H
+
+#include <QJsonObject>
+
+/**
+ * \brief Converts finished logs into their compact form
+ *
+ * A live log is written as a sequence of small chunks (one per series every
+ * time that the log is saved). Compacting a log rewrites it with a single
+ * chunk per series, so that the records of each series are stored together
+ * (in columns), and compresses all the chunks with \c qCompress().
+ *
+ * Legacy (JSON) logs are converted to the same compact binary form.
+ *
+ * The compactor also generates a summary of the log (duration, voltage,
+ * packet loss, CPU and RAM usage statistics), which is stored in the log
+ * manifest so that clients can describe the logs without opening them.
+ */
+class LogCompactor {
+  public:
+    static QJsonObject compact (const QString& path);
+};
+
+#endif
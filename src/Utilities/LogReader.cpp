@@ -0,0 +1,645 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "LogReader.h"
+#include "LogWriter.h"
+#include "CRC32.h"
+
+#include <QJsonArray>
+#include <QVariantMap>
+
+#include <limits.h>
+#include <string.h>
+
+/* JSON logger keys */
+const QString TIME = "t";
+const QString DATA = "d";
+
+/* Number of elements of the JSON log array (legacy logs only have 14) */
+const int JSON_SERIES = 16;
+
+/* Indexes of the text series of the JSON log array */
+const int CONSOLE_DUMP = 12;
+const int NET_CONSOLE = 13;
+
+/* Size of the file header */
+const int HEADER_SIZE = LogWriter::MAGIC_SIZE + 2;
+
+/**
+ * Reads an unsigned LEB128 varint from the first \a size bytes of \a data
+ * and advances the \a offset. Returns \c false if the varint is not complete.
+ */
+static bool READ_VARINT (const uchar* data, qint64 size,
+                         qint64* offset, quint64* value) {
+    *value = 0;
+
+    for (int shift = 0; shift < 64 && *offset < size; shift += 7) {
+        uchar byte = data [(*offset)++];
+        *value |= (quint64) (byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Reads a zig-zag encoded varint from the first \a size bytes of \a data and
+ * advances the \a offset
+ */
+static bool READ_SIGNED (const uchar* data, qint64 size,
+                         qint64* offset, qint64* value) {
+    quint64 raw = 0;
+    if (!READ_VARINT (data, size, offset, &raw))
+        return false;
+
+    *value = (qint64) (raw >> 1) ^ - (qint64) (raw & 1);
+    return true;
+}
+
+/**
+ * Returns \c true if the CRC32 that follows the \a size bytes of the given
+ * chunk \a payload matches the payload
+ */
+static bool VALID_PAYLOAD (const uchar* payload, int size) {
+    quint32 crc = 0;
+    for (int j = 0; j < 4; ++j)
+        crc |= (quint32) payload [size + j] << (8 * j);
+
+    return crc == CRC32::checksum ((const char*) payload, size);
+}
+
+/**
+ * Returns \c true if the given \a data begins with a supported file header
+ */
+static bool VALID_HEADER (const uchar* data, qint64 size) {
+    if (!data || size < HEADER_SIZE)
+        return false;
+
+    return memcmp (data, LogWriter::MAGIC, LogWriter::MAGIC_SIZE) == 0 &&
+           data [LogWriter::MAGIC_SIZE] == LogWriter::VERSION;
+}
+
+LogReader::LogReader() {
+    m_ignored = 0;
+    m_compressed = false;
+    m_size = 0;
+    m_offset = 0;
+    m_data = Q_NULLPTR;
+}
+
+LogReader::~LogReader() {
+    close();
+}
+
+/**
+ * Returns \c true if a log file (or log data) is open
+ */
+bool LogReader::isOpen() const {
+    return m_data != Q_NULLPTR;
+}
+
+/**
+ * Returns \c true if the open log was compacted (and compressed)
+ */
+bool LogReader::isCompressed() const {
+    return m_compressed;
+}
+
+/**
+ * Returns the last elapsed time registered in the log. Only the last chunk of
+ * the elapsed time series is decoded.
+ */
+qint64 LogReader::duration() const {
+    if (count (0) <= 0 || type (0) != LogWriter::kInteger)
+        return 0;
+
+    QVector<Point> points;
+    decode (m_series.at (0).chunks.last(), LogWriter::kInteger, &points,
+            Q_NULLPTR);
+
+    return points.isEmpty() ? 0 : (qint64) points.last().value;
+}
+
+/**
+ * Returns the number of chunks that were ignored while indexing the log,
+ * because their data is corrupt or because their type differs from the type
+ * of the previous chunks of their series. A corrupt region of the log is
+ * counted as a single chunk.
+ */
+int LogReader::ignoredChunks() const {
+    return m_ignored;
+}
+
+/**
+ * Returns the number of series that have been indexed
+ */
+int LogReader::seriesCount() const {
+    return m_series.count();
+}
+
+/**
+ * Returns the type of the given \a series, or \c -1 if the series does not
+ * exist in the log
+ */
+int LogReader::type (int series) const {
+    if (series >= 0 && series < m_series.count())
+        if (!m_series.at (series).chunks.isEmpty())
+            return m_series.at (series).type;
+
+    return -1;
+}
+
+/**
+ * Returns the number of records of the given \a series
+ */
+int LogReader::count (int series) const {
+    if (series >= 0 && series < m_series.count())
+        return m_series.at (series).count;
+
+    return 0;
+}
+
+/**
+ * Returns the concatenated fragments of the given text \a series
+ */
+QByteArray LogReader::text (int series) const {
+    QByteArray text;
+
+    if (type (series) == LogWriter::kText) {
+        foreach (const Chunk& chunk, m_series.at (series).chunks)
+            decode (chunk, LogWriter::kText, Q_NULLPTR, &text);
+    }
+
+    return text;
+}
+
+/**
+ * Returns the records of the given numeric \a series that were registered
+ * between the \a from and \a to times (inclusive). Only the chunks that
+ * overlap with the given time range are decoded.
+ */
+QVector<LogReader::Point> LogReader::range (int series,
+                                            qint64 from, qint64 to) const {
+    QVector<Point> points;
+    int seriesType = type (series);
+    if (seriesType != LogWriter::kInteger && seriesType != LogWriter::kReal)
+        return points;
+
+    /* Find the last chunk that begins before the time range */
+    const QVector<Chunk>& chunks = m_series.at (series).chunks;
+    int low = 0;
+    int high = chunks.count();
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (chunks.at (mid).time <= from)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    /* Decode the chunks until the end of the time range */
+    QVector<Point> buffer;
+    for (int i = qMax (0, low - 1); i < chunks.count(); ++i) {
+        if (chunks.at (i).time > to)
+            break;
+
+        buffer.resize (0);
+        decode (chunks.at (i), seriesType, &buffer, Q_NULLPTR);
+
+        foreach (const Point& point, buffer) {
+            if (point.time >= from && point.time <= to)
+                points.append (point);
+        }
+    }
+
+    return points;
+}
+
+/**
+ * Returns at most the given number of \a points of the given \a series
+ * between the \a from and \a to times, for plotting.
+ *
+ * The time range is divided in buckets and the minimum and maximum records
+ * of each bucket are kept, so that spikes (e.g. voltage drops) remain
+ * visible in the plot.
+ */
+QVector<LogReader::Point> LogReader::downsample (int series, int points,
+                                                 qint64 from,
+                                                 qint64 to) const {
+    QVector<Point> data = range (series, from, to);
+    if (points < 2 || data.count() <= points)
+        return data;
+
+    QVector<Point> result;
+    result.reserve (points);
+
+    qint64 buckets = points / 2;
+    qint64 start = data.first().time;
+    qint64 span = data.last().time - start + 1;
+
+    int i = 0;
+    while (i < data.count()) {
+        qint64 bucket = (data.at (i).time - start) * buckets / span;
+
+        /* Find the extremes of the bucket */
+        int min = i;
+        int max = i;
+        for (++i; i < data.count(); ++i) {
+            if ((data.at (i).time - start) * buckets / span != bucket)
+                break;
+
+            if (data.at (i).value < data.at (min).value)
+                min = i;
+            if (data.at (i).value > data.at (max).value)
+                max = i;
+        }
+
+        /* Add them in chronological order */
+        result.append (data.at (qMin (min, max)));
+        if (min != max)
+            result.append (data.at (qMax (min, max)));
+    }
+
+    return result;
+}
+
+/**
+ * Decodes all the records of the log and returns them in the legacy JSON log
+ * structure. The round trip time and link jitter series (which the legacy
+ * logs do not have) are appended after the legacy elements, so that the
+ * clients that read the array by index are not affected.
+ */
+QJsonDocument LogReader::document() const {
+    QJsonArray array;
+    array.append (QJsonValue::fromVariant (duration()));
+
+    for (int i = 1; i < JSON_SERIES; ++i) {
+        int seriesType = type (i);
+
+        /* Text series */
+        if (seriesType == LogWriter::kText)
+            array.append (QJsonValue (QString::fromUtf8 (text (i))));
+
+        /* Text series without records */
+        else if (seriesType < 0 && (i == CONSOLE_DUMP || i == NET_CONSOLE))
+            array.append (QJsonValue (QString ("")));
+
+        /* Numeric series */
+        else {
+            QVariantList list;
+            QVector<Point> points;
+            if (seriesType >= 0)
+                foreach (const Chunk& chunk, m_series.at (i).chunks)
+                    decode (chunk, seriesType, &points, Q_NULLPTR);
+
+            foreach (const Point& point, points) {
+                QVariantMap map;
+                map.insert (TIME, point.time);
+                if (seriesType == LogWriter::kInteger)
+                    map.insert (DATA, (qint64) point.value);
+                else
+                    map.insert (DATA, point.value);
+
+                list.append (map);
+            }
+
+            array.append (QJsonValue::fromVariant (list));
+        }
+    }
+
+    QJsonDocument document;
+    document.setArray (array);
+    return document;
+}
+
+/**
+ * Memory-maps the log file at the given \a path and indexes its chunks
+ */
+bool LogReader::open (const QString& path) {
+    close();
+
+    m_file.setFileName (path);
+    if (!m_file.open (QFile::ReadOnly))
+        return false;
+
+    /* Compressed logs cannot be mapped */
+    QByteArray header = m_file.peek (HEADER_SIZE);
+    if (header.size() == HEADER_SIZE) {
+        if (header.at (HEADER_SIZE - 1) & LogWriter::kCompressed) {
+            QByteArray data = m_file.readAll();
+            m_file.close();
+            return open (data);
+        }
+    }
+
+    if (refresh() || isOpen())
+        return true;
+
+    close();
+    return false;
+}
+
+/**
+ * Indexes the chunks of the given log \a data, which is kept by the reader
+ * (or decompressed, if the log was compacted)
+ */
+bool LogReader::open (const QByteArray& data) {
+    close();
+
+    if (!VALID_HEADER ((const uchar*) data.constData(), data.size()))
+        return false;
+
+    m_buffer = data;
+
+    /* Decompress the chunks of compacted logs */
+    if (data.at (HEADER_SIZE - 1) & LogWriter::kCompressed) {
+        m_buffer = data.left (HEADER_SIZE);
+        m_buffer.append (qUncompress (data.mid (HEADER_SIZE)));
+        m_buffer [HEADER_SIZE - 1] = 0;
+        m_compressed = true;
+    }
+
+    m_size = m_buffer.size();
+    m_offset = HEADER_SIZE;
+    m_data = (const uchar*) m_buffer.constData();
+
+    index();
+    return true;
+}
+
+/**
+ * Maps and indexes the data that was appended to the log file since it was
+ * opened (or last refreshed). Returns \c true if new chunks were found.
+ */
+bool LogReader::refresh() {
+    if (m_file.isOpen()) {
+        qint64 size = m_file.size();
+        if (size <= m_size)
+            return false;
+
+        if (m_data)
+            m_file.unmap ((uchar*) m_data);
+
+        m_data = m_file.map (0, size);
+        m_size = m_data ? size : 0;
+
+        if (!VALID_HEADER (m_data, m_size)) {
+            m_file.unmap ((uchar*) m_data);
+            m_size = 0;
+            m_data = Q_NULLPTR;
+            return false;
+        }
+
+        if (m_offset < HEADER_SIZE)
+            m_offset = HEADER_SIZE;
+    }
+
+    return index();
+}
+
+/**
+ * Unmaps the log file and clears the index
+ */
+void LogReader::close() {
+    if (m_file.isOpen()) {
+        if (m_data)
+            m_file.unmap ((uchar*) m_data);
+
+        m_file.close();
+    }
+
+    m_size = 0;
+    m_offset = 0;
+    m_ignored = 0;
+    m_data = Q_NULLPTR;
+    m_compressed = false;
+
+    m_buffer.clear();
+    m_series.clear();
+}
+
+/**
+ * Returns \c true if the file at the given \a path is a binary log file
+ */
+bool LogReader::isBinaryLog (const QString& path) {
+    QFile file (path);
+    if (file.open (QFile::ReadOnly))
+        return isBinaryLog (file.read (LogWriter::MAGIC_SIZE));
+
+    return false;
+}
+
+/**
+ * Returns \c true if the given \a data begins with the binary log header
+ */
+bool LogReader::isBinaryLog (const QByteArray& data) {
+    return data.startsWith (QByteArray (LogWriter::MAGIC,
+                                        LogWriter::MAGIC_SIZE));
+}
+
+/**
+ * Reads the binary log file at the given \a path and returns its records
+ * in the legacy JSON log structure
+ */
+QJsonDocument LogReader::read (const QString& path) {
+    LogReader reader;
+    if (reader.open (path))
+        return reader.document();
+
+    return QJsonDocument();
+}
+
+/**
+ * Decodes the given binary log \a data and returns its records in the legacy
+ * JSON log structure
+ */
+QJsonDocument LogReader::read (const QByteArray& data) {
+    LogReader reader;
+    if (reader.open (data))
+        return reader.document();
+
+    return QJsonDocument();
+}
+
+/**
+ * Reads the headers of the chunks that have not been indexed yet. Indexing
+ * stops at the first incomplete chunk (e.g. the last chunk of a log that is
+ * still being written), which is indexed by a later call to this function.
+ *
+ * Corrupt data is skipped until the next sync byte, and the chunks that are
+ * found after corrupt data are only indexed if their checksum is valid (the
+ * sync byte may also appear inside the corrupt data).
+ */
+bool LogReader::index() {
+    bool indexed = false;
+    bool resync = false;
+
+    while (m_offset + 3 <= m_size) {
+        qint64 offset = m_offset;
+
+        /* Corrupt data, skip it until the next sync byte */
+        if (m_data [offset] != LogWriter::CHUNK_SYNC) {
+            const void* sync = memchr (m_data + offset, LogWriter::CHUNK_SYNC,
+                                       (size_t) (m_size - offset));
+
+            m_offset = sync ? (const uchar*) sync - m_data : m_size;
+            m_ignored += !resync;
+            resync = true;
+            continue;
+        }
+
+        int id = m_data [offset + 1];
+        int seriesType = m_data [offset + 2];
+        offset += 3;
+
+        /* Unknown series type, the sync byte is part of corrupt data */
+        if (seriesType != LogWriter::kInteger &&
+                seriesType != LogWriter::kReal &&
+                seriesType != LogWriter::kText) {
+            m_offset += 1;
+            m_ignored += !resync;
+            resync = true;
+            continue;
+        }
+
+        /* Read chunk header */
+        quint64 count = 0;
+        quint64 size = 0;
+        if (!READ_VARINT (m_data, m_size, &offset, &count) ||
+                !READ_VARINT (m_data, m_size, &offset, &size))
+            break;
+
+        /* Chunk is incomplete (or its header is corrupt) */
+        quint64 available = (quint64) (m_size - offset);
+        if (available < 4 || size > available - 4)
+            break;
+
+        /* Chunk sizes must fit in the chunk index */
+        if (size > INT_MAX || count > INT_MAX) {
+            m_offset += 1;
+            m_ignored += !resync;
+            resync = true;
+            continue;
+        }
+
+        /* After corrupt data, only trust the chunks with a valid checksum */
+        if (resync && !VALID_PAYLOAD (m_data + offset, (int) size)) {
+            m_offset += 1;
+            continue;
+        }
+
+        /* The first timestamp of a chunk is not delta-encoded */
+        Chunk chunk;
+        chunk.time = 0;
+        chunk.offset = offset;
+        chunk.size = (int) size;
+        chunk.count = (int) count;
+        READ_SIGNED (m_data, offset + chunk.size, &offset, &chunk.time);
+
+        /* Register the chunk */
+        if (id >= m_series.count())
+            m_series.resize (id + 1);
+
+        Series& series = m_series [id];
+        if (series.chunks.isEmpty())
+            series.type = seriesType;
+
+        if (series.type != seriesType)
+            ++m_ignored;
+
+        else if (chunk.count > 0) {
+            series.chunks.append (chunk);
+            series.count += chunk.count;
+        }
+
+        m_offset = chunk.offset + chunk.size + 4;
+        resync = false;
+        indexed = true;
+    }
+
+    return indexed;
+}
+
+/**
+ * Decodes the records of the given \a chunk and appends them to the list of
+ * \a points (for numeric series) or to the \a text (for text series).
+ * Chunks with an invalid checksum are ignored.
+ */
+void LogReader::decode (const Chunk& chunk, int type,
+                        QVector<Point>* points, QByteArray* text) const {
+    const uchar* payload = m_data + chunk.offset;
+    const char* data = (const char*) payload;
+
+    /* Verify payload checksum */
+    if (!VALID_PAYLOAD (payload, chunk.size))
+        return;
+
+    qint64 offset = 0;
+    qint64 time = 0;
+    qint64 integer = 0;
+    quint64 bits = 0;
+
+    for (int i = 0; i < chunk.count; ++i) {
+        qint64 delta = 0;
+        if (!READ_SIGNED (payload, chunk.size, &offset, &delta))
+            break;
+
+        time += delta;
+
+        /* Integer value */
+        if (type == LogWriter::kInteger && points) {
+            if (!READ_SIGNED (payload, chunk.size, &offset, &delta))
+                break;
+
+            integer += delta;
+
+            Point point;
+            point.time = time;
+            point.value = integer;
+            points->append (point);
+        }
+
+        /* Real value */
+        else if (type == LogWriter::kReal && points) {
+            if (offset >= chunk.size)
+                break;
+
+            int leading = payload [offset] >> 4;
+            int trailing = payload [offset++] & 0x0f;
+            int bytes = 8 - leading - trailing;
+            if (bytes < 0 || offset + bytes > chunk.size)
+                break;
+
+            for (int j = trailing; j < 8 - leading; ++j)
+                bits ^= (quint64) payload [offset++] << (8 * j);
+
+            Point point;
+            point.time = time;
+            memcpy (&point.value, &bits, sizeof (point.value));
+            points->append (point);
+        }
+
+        /* Text fragment */
+        else if (type == LogWriter::kText && text) {
+            quint64 length = 0;
+            if (!READ_VARINT (payload, chunk.size, &offset, &length))
+                break;
+
+            if (length > (quint64) (chunk.size - offset))
+                break;
+
+            text->append (data + offset, (int) length);
+            offset += (int) length;
+        }
+
+        else
+            break;
+    }
+}
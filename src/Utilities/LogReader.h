@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_LOG_READER_H
+#define _LIB_DS_LOG_READER_H
+
+#include <QFile>
+#include <QVector>
+#include <QJsonDocument>
+
+/**
+ * \brief Reads the binary log files generated by the \c LogWriter
+ *
+ * The file is memory-mapped and only the chunk headers are read when the
+ * file is opened, which builds an index with the position and the first
+ * timestamp of every chunk of every series. Records are only decoded when
+ * they are requested, so queries such as "voltage between t0 and t1" or
+ * "CPU usage downsampled to 500 points" only touch the chunks they need.
+ *
+ * Calling \c refresh() indexes the chunks that were appended to the file
+ * since it was opened (or refreshed), without reading the old data again.
+ * Compacted (compressed) logs are decompressed in memory when opened.
+ *
+ * The records can also be converted to the JSON structure used by the legacy
+ * (JSON) log files, so that existing clients can open both kinds of files in
+ * the same way.
+ */
+class LogReader {
+  public:
+    /**
+     * \brief A single record of a numeric series
+     */
+    struct Point {
+        qint64 time;
+        qreal value;
+    };
+
+    explicit LogReader();
+    ~LogReader();
+
+    bool isOpen() const;
+    bool isCompressed() const;
+    qint64 duration() const;
+    int seriesCount() const;
+    int type (int series) const;
+    int count (int series) const;
+    int ignoredChunks() const;
+
+    QByteArray text (int series) const;
+    QVector<Point> range (int series, qint64 from, qint64 to) const;
+    QVector<Point> downsample (int series, int points,
+                               qint64 from, qint64 to) const;
+    QJsonDocument document() const;
+
+    bool open (const QString& path);
+    bool open (const QByteArray& data);
+    bool refresh();
+    void close();
+
+    static bool isBinaryLog (const QString& path);
+    static bool isBinaryLog (const QByteArray& data);
+    static QJsonDocument read (const QString& path);
+    static QJsonDocument read (const QByteArray& data);
+
+  private:
+    struct Chunk {
+        qint64 offset;
+        qint64 time;
+        int size;
+        int count;
+    };
+
+    struct Series {
+        int type = 0;
+        int count = 0;
+        QVector<Chunk> chunks;
+    };
+
+    bool index();
+    void decode (const Chunk& chunk, int type,
+                 QVector<Point>* points, QByteArray* text) const;
+
+  private:
+    QFile m_file;
+    QByteArray m_buffer;
+    bool m_compressed;
+    int m_ignored;
+
+    qint64 m_size;
+    qint64 m_offset;
+    const uchar* m_data;
+
+    QVector<Series> m_series;
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "LogWriter.h"
+#include "CRC32.h"
+
+#include <string.h>
+
+/*
+ * File format definitions
+ */
+const char LogWriter::MAGIC [] = "QDSLOG";
+const int LogWriter::MAGIC_SIZE = 6;
+const quint8 LogWriter::VERSION = 1;
+const quint8 LogWriter::CHUNK_SYNC = 0xc5;
+
+/**
+ * Appends the given \a value as an unsigned LEB128 varint
+ */
+static void WRITE_VARINT (QByteArray* data, quint64 value) {
+    while (value >= 0x80) {
+        data->append ((char) ((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+
+    data->append ((char) value);
+}
+
+/**
+ * Appends the given signed \a value as a zig-zag encoded varint
+ */
+static void WRITE_SIGNED (QByteArray* data, qint64 value) {
+    WRITE_VARINT (data, ((quint64) value << 1) ^ (quint64) (value >> 63));
+}
+
+LogWriter::LogWriter() {
+    m_chunk.reserve (1024);
+}
+
+LogWriter::~LogWriter() {
+    close();
+}
+
+/**
+ * Returns \c true if the log file is open
+ */
+bool LogWriter::isOpen() const {
+    return m_file.isOpen();
+}
+
+/**
+ * Returns the current size of the log file (including the flushed data only)
+ */
+qint64 LogWriter::fileSize() const {
+    return m_file.size();
+}
+
+/**
+ * Opens the log file at the given \a path for appending. If the file is new,
+ * the file header is written. Records appended before opening the file are
+ * kept and written with the next call to \c flush().
+ */
+bool LogWriter::open (const QString& path) {
+    if (isOpen())
+        close();
+
+    m_file.setFileName (path);
+    if (!m_file.open (QFile::WriteOnly | QFile::Append))
+        return false;
+
+    if (m_file.size() == 0) {
+        QByteArray header (MAGIC, MAGIC_SIZE);
+        header.append ((char) VERSION);
+        header.append ((char) 0);
+        m_file.write (header);
+    }
+
+    return true;
+}
+
+/**
+ * Writes the pending records and closes the log file
+ */
+void LogWriter::close() {
+    if (m_file.isOpen()) {
+        flush();
+        m_file.close();
+    }
+
+    m_series.clear();
+}
+
+/**
+ * Writes one chunk for every series that received new records since the
+ * last call to this function and flushes the file to disk.
+ */
+bool LogWriter::flush() {
+    if (!m_file.isOpen())
+        return false;
+
+    bool ok = true;
+    for (int i = 0; i < m_series.count(); ++i) {
+        Series& s = m_series [i];
+        if (s.count <= 0)
+            continue;
+
+        /* Generate the chunk */
+        m_chunk.resize (0);
+        m_chunk.append ((char) CHUNK_SYNC);
+        m_chunk.append ((char) i);
+        m_chunk.append ((char) s.type);
+        WRITE_VARINT (&m_chunk, s.count);
+        WRITE_VARINT (&m_chunk, s.payload.size());
+        m_chunk.append (s.payload);
+
+        /* Add the checksum of the payload */
+        quint32 crc = CRC32::checksum (s.payload.constData(),
+                                       s.payload.size());
+        for (int j = 0; j < 4; ++j)
+            m_chunk.append ((char) ((crc >> (8 * j)) & 0xff));
+
+        ok &= (m_file.write (m_chunk) == m_chunk.size());
+
+        /* Begin a new chunk, but keep the buffer memory */
+        s.count = 0;
+        s.time = 0;
+        s.value = 0;
+        s.payload.resize (0);
+    }
+
+    ok &= m_file.flush();
+    return ok;
+}
+
+/**
+ * Appends an integer \a value registered at the given \a time to the given
+ * \a series
+ */
+void LogWriter::append (int series, qint64 time, qint64 value) {
+    Series* s = this->series (series, kInteger);
+    if (!s)
+        return;
+
+    WRITE_SIGNED (&s->payload, time - s->time);
+    WRITE_SIGNED (&s->payload, value - (qint64) s->value);
+
+    s->count += 1;
+    s->time = time;
+    s->value = (quint64) value;
+}
+
+/**
+ * Appends a real \a value registered at the given \a time to the given
+ * \a series
+ */
+void LogWriter::append (int series, qint64 time, qreal value) {
+    Series* s = this->series (series, kReal);
+    if (!s)
+        return;
+
+    quint64 bits = 0;
+    memcpy (&bits, &value, sizeof (bits));
+
+    /* Nearby values only differ in the middle bytes (the mantissa MSBs) */
+    quint64 delta = bits ^ s->value;
+    int leading = 8;
+    int trailing = 0;
+    if (delta != 0) {
+        leading = 0;
+        while ((delta >> (8 * (7 - leading))) == 0)
+            ++leading;
+        while (((delta >> (8 * trailing)) & 0xff) == 0)
+            ++trailing;
+    }
+
+    /* Write the zero byte counts, then the bytes between them */
+    WRITE_SIGNED (&s->payload, time - s->time);
+    s->payload.append ((char) ((leading << 4) | trailing));
+    for (int i = trailing; i < 8 - leading; ++i)
+        s->payload.append ((char) ((delta >> (8 * i)) & 0xff));
+
+    s->count += 1;
+    s->time = time;
+    s->value = bits;
+}
+
+/**
+ * Appends the given \a text registered at the given \a time to the given
+ * \a series
+ */
+void LogWriter::append (int series, qint64 time, const QByteArray& text) {
+    Series* s = this->series (series, kText);
+    if (!s)
+        return;
+
+    WRITE_SIGNED (&s->payload, time - s->time);
+    WRITE_VARINT (&s->payload, text.size());
+    s->payload.append (text);
+
+    s->count += 1;
+    s->time = time;
+}
+
+/**
+ * Returns the pending chunk of the given series \a id, or \c NULL if the
+ * series ID is invalid or if the series already holds values of another
+ * \a type in the pending chunk.
+ */
+LogWriter::Series* LogWriter::series (int id, int type) {
+    if (id < 0 || id > 0xff)
+        return Q_NULLPTR;
+
+    if (id >= m_series.count())
+        m_series.resize (id + 1);
+
+    Series* s = &m_series [id];
+    if (s->count > 0 && s->type != type)
+        return Q_NULLPTR;
+
+    s->type = type;
+    return s;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_LOG_WRITER_H
+#define _LIB_DS_LOG_WRITER_H
+
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+
+/**
+ * \brief Writes append-only, chunked binary log files
+ *
+ * A log file is made of a small header followed by a sequence of chunks.
+ * Each chunk holds the records of a single series that were appended between
+ * two calls to \c flush(), so saving the log only writes the new data, no
+ * matter how long the log already is.
+ *
+ * The records of a chunk are delta-encoded against the previous record of
+ * the same chunk (the first record is encoded against zero), which keeps the
+ * chunks independent from each other:
+ *
+ *   - Timestamps are written as zig-zag varints of their difference
+ *   - Integers are written as zig-zag varints of their difference
+ *   - Reals are XOR-ed with the previous value, and only the bytes between
+ *     the leading and trailing zero bytes of the result are written (after
+ *     a byte with the leading count in its high nibble and the trailing
+ *     count in its low nibble)
+ *   - Texts are written as a varint length followed by the UTF-8 data
+ *
+ * Chunk layout: sync byte, series ID, series type, record count (varint),
+ * payload size (varint), payload and the CRC32 of the payload. A chunk that
+ * was not completely written (e.g. after a crash) is ignored by the reader.
+ *
+ * Header layout: magic, version and flags. Finished logs can be compacted
+ * (see \c LogCompactor), in which case every chunk after the header is
+ * compressed as a single block.
+ */
+class LogWriter {
+  public:
+    /**
+     * \brief Defines the type of the values of a series
+     */
+    enum SeriesType {
+        kInteger = 0, /**< Series of integer values */
+        kReal    = 1, /**< Series of floating point values */
+        kText    = 2, /**< Series of text fragments */
+    };
+
+    /**
+     * \brief Defines the flags of the file header
+     */
+    enum HeaderFlags {
+        kCompressed = 0x01, /**< The chunks are compressed with qCompress() */
+    };
+
+    static const char MAGIC [];
+    static const int MAGIC_SIZE;
+    static const quint8 VERSION;
+    static const quint8 CHUNK_SYNC;
+
+    explicit LogWriter();
+    ~LogWriter();
+
+    bool isOpen() const;
+    qint64 fileSize() const;
+
+    bool open (const QString& path);
+    void close();
+    bool flush();
+
+    void append (int series, qint64 time, qint64 value);
+    void append (int series, qint64 time, qreal value);
+    void append (int series, qint64 time, const QByteArray& text);
+
+  private:
+    struct Series {
+        int type = kInteger;
+        int count = 0;
+        qint64 time = 0;
+        quint64 value = 0;
+        QByteArray payload;
+    };
+
+    Series* series (int id, int type);
+
+  private:
+    QFile m_file;
+    QByteArray m_chunk;
+    QVector<Series> m_series;
+};
+
+#endif
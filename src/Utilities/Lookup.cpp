@@ -6,87 +6,191 @@
  * of this project.
  */
 
-#include <QTimer>
 #include <qMDNS.h>
 
 #include "Lookup.h"
 
+/* Time (in milliseconds) in which unanswered lookups are not repeated */
+const qint64 NEGATIVE_TTL = 5000;
+
+/* Maximum number of hosts in the cache, expired entries are only removed
+ * when the cache is full */
+const int MAX_CACHE_SIZE = 32;
+
 Lookup::Lookup() {
-    clearCache();
-    connect (qMDNS::getInstance(), &qMDNS::hostFound,
-             this,                 &Lookup::onLookupFinished);
+    m_hits = 0;
+    m_misses = 0;
+    m_clock.start();
+
+    connect (qMDNS::getInstance(), &qMDNS::recordFound,
+             this,                 &Lookup::onRecordFound);
 }
 
 /**
- * Performs a lookup of the given \a host name
- *
- * \note If the host \a name has already been found, the lookup will be
- *       canceled, but a signal will be emitted for the client to use
- * \warning If the host \a name is empty, the lookup will be canceled
+ * Returns the number of lookups that were answered by the cache (including
+ * the lookups that were canceled because the host did not answer recently)
  */
-void Lookup::lookup (const QString& name) {
-    if (name.isEmpty())
-        return;
+int Lookup::hits() const {
+    return m_hits;
+}
 
-    if (isOnCache (name)) {
-        emit lookupFinished (name, getAddress (name));
-        return;
-    }
+/**
+ * Returns the number of lookups that were sent to the network
+ */
+int Lookup::misses() const {
+    return m_misses;
+}
 
-    qMDNS::getInstance()->lookup (name);
+/**
+ * Returns the number of hosts in the cache (including expired entries that
+ * have not been removed yet)
+ */
+int Lookup::cacheSize() const {
+    return m_hosts.count();
 }
 
 /**
- * Removes the host list cache periodically (every 10 seconds)
+ * Returns the cache key of the given host \a name. Host names are not case
+ * sensitive, the root dot is optional and names without a domain are mDNS
+ * names (e.g. "roboRIO-3794-FRC." and "roborio-3794-frc" are the same host
+ * as "roborio-3794-frc.local").
+ */
+QString Lookup::normalize (const QString& name) {
+    QString host = name.trimmed().toLower();
+
+    while (host.endsWith ("."))
+        host.chop (1);
+
+    if (!host.isEmpty() && !host.contains ("."))
+        host.append (".local");
+
+    return host;
+}
+
+/**
+ * Removes all the hosts from the cache
  */
 void Lookup::clearCache() {
     m_hosts.clear();
-    QTimer::singleShot (10000, Qt::CoarseTimer, this, SLOT (clearCache()));
 }
 
 /**
- * Called when a lookup request is finished. This function will notify the
- * client when a host name has been resolved into a valid IP address and will
- * update the 'found hosts' list.
+ * Performs a lookup of the given \a host name
  *
- * \note If the address stored in the given host \a info is empty, this
- *       function will not emit a signal nor update the found hosts list.
+ * \note If the host \a name is in the cache, the lookup will be canceled, but
+ *       a signal will be emitted for the client to use
+ * \note If the host \a name did not answer a recent lookup, the lookup will be
+ *       canceled and no signal will be emitted
+ * \warning If the host \a name is empty, the lookup will be canceled
  */
-void Lookup::onLookupFinished (const QHostInfo& info) {
-    QHostAddress address = info.addresses().first();
+void Lookup::lookup (const QString& name) {
+    QString key = normalize (name);
+    if (key.isEmpty())
+        return;
+
+    /* Host is in the cache and its record did not expire */
+    QHash<QString, Entry>::const_iterator entry = m_hosts.constFind (key);
+    if (entry != m_hosts.constEnd() && entry->expiry > m_clock.elapsed()) {
+        ++m_hits;
+
+        if (!entry->address.isNull())
+            emit lookupFinished (name, entry->address);
 
-    if (address.isNull())
         return;
+    }
 
-    if (!isOnCache (info.hostName()))
-        m_hosts.append (qMakePair (info.hostName(), address));
+    /* Do not query the host again until the negative TTL expires */
+    if (entry == m_hosts.constEnd())
+        trimCache();
 
-    emit lookupFinished (info.hostName(), address);
+    Entry pending;
+    pending.expiry = m_clock.elapsed() + NEGATIVE_TTL;
+    m_hosts.insert (key, pending);
+    ++m_misses;
+
+    /* Let the mDNS client handle the request in its own thread, the client
+     * does not accept some of the spellings of the name (e.g. a root dot) */
+    QMetaObject::invokeMethod (qMDNS::getInstance(), "lookup",
+                               Q_ARG (QString, key));
 }
 
 /**
- * Returns \c true if the given host \a name has already been found by the
- * lookup mechanism(s).
+ * Called when a DNS/mDNS record is received. This function will update the
+ * cache with the given record (which is valid for \a ttl seconds) and will
+ * notify the client when a host name has been resolved into a valid IP
+ * address.
+ *
+ * \note If the given host \a info has no addresses, the host is kept in the
+ *       cache as unresolved (for a short time)
  */
-bool Lookup::isOnCache (const QString& name) {
-    return !getAddress (name).isNull();
+void Lookup::onRecordFound (const QHostInfo& info, quint32 ttl) {
+    QString key = normalize (info.hostName());
+    if (key.isEmpty())
+        return;
+
+    /* Get the first usable address */
+    QHostAddress address;
+    foreach (const QHostAddress& ip, info.addresses()) {
+        if (!ip.isNull()) {
+            address = ip;
+            break;
+        }
+    }
+
+    /* The host is leaving the network */
+    if (ttl == 0 && !address.isNull()) {
+        m_hosts.remove (key);
+        return;
+    }
+
+    /* Update the cache */
+    if (!m_hosts.contains (key))
+        trimCache();
+
+    Entry entry;
+    entry.address = address;
+    entry.expiry = m_clock.elapsed();
+    entry.expiry += address.isNull() ? NEGATIVE_TTL : ttl * 1000LL;
+    m_hosts.insert (key, entry);
+
+    if (!address.isNull())
+        emit lookupFinished (info.hostName(), address);
 }
 
 /**
- * Returns the IP address associated with the given host \a name.
- *
- * If the host \a name is not on the found hosts list, then this function will
- * return an empty IP address (which will prompt the \c lookup() function to
- * find the given host \a name).
+ * Makes room in the cache for a new host. The expired entries are removed
+ * and, if the cache is still full, the entries that expire the soonest are
+ * evicted.
  */
-QHostAddress Lookup::getAddress (const QString& name) {
-    if (!name.isEmpty()) {
-        for (int i = 0; i > m_hosts.count(); ++i) {
-            QPair<QString, QHostAddress> pair = m_hosts.at (i);
-            if (pair.first == name)
-                return pair.second;
+void Lookup::trimCache() {
+    if (m_hosts.count() < MAX_CACHE_SIZE)
+        return;
+
+    removeExpiredEntries();
+
+    while (m_hosts.count() >= MAX_CACHE_SIZE) {
+        QHash<QString, Entry>::iterator soonest = m_hosts.begin();
+        QHash<QString, Entry>::iterator entry = m_hosts.begin();
+        for (; entry != m_hosts.end(); ++entry) {
+            if (entry->expiry < soonest->expiry)
+                soonest = entry;
         }
+
+        m_hosts.erase (soonest);
     }
+}
+
+/**
+ * Removes the entries whose records have expired from the cache
+ */
+void Lookup::removeExpiredEntries() {
+    qint64 now = m_clock.elapsed();
 
-    return QHostAddress ("");
+    QHash<QString, Entry>::iterator entry = m_hosts.begin();
+    while (entry != m_hosts.end()) {
+        if (entry->expiry <= now)
+            entry = m_hosts.erase (entry);
+        else
+            ++entry;
+    }
 }
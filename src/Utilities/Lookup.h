@@ -6,12 +6,19 @@
  * of this project.
  */
 
-#include <QPair>
+#include <QHash>
 #include <QObject>
 #include <QHostInfo>
+#include <QElapsedTimer>
 
 /**
  * @brief Performs host lookups to obtain socket-usable IP addresses
+ *
+ * Resolved hosts are cached (by their normalized name) until the TTL of their
+ * DNS/mDNS record expires, so that repeated lookups of the same host do not
+ * generate network traffic. Lookups that were not answered are also cached
+ * for a short time (negative caching), so that unreachable hosts are not
+ * queried again and again.
  */
 class Lookup : public QObject {
     Q_OBJECT
@@ -22,17 +29,34 @@ class Lookup : public QObject {
   public:
     explicit Lookup();
 
+    int hits() const;
+    int misses() const;
+    int cacheSize() const;
+
+    static QString normalize (const QString& name);
+
   public slots:
+    void clearCache();
     void lookup (const QString& name);
 
   private slots:
-    void clearCache();
-    void onLookupFinished (const QHostInfo& info);
+    void onRecordFound (const QHostInfo& info, quint32 ttl);
 
   private:
-    bool isOnCache (const QString& name);
-    QHostAddress getAddress (const QString& name);
+    /**
+     * Cached result of a host lookup
+     */
+    struct Entry {
+        qint64 expiry;
+        QHostAddress address;
+    };
+
+    void trimCache();
+    void removeExpiredEntries();
 
   private:
-    QList<QPair<QString, QHostAddress>> m_hosts;
+    int m_hits;
+    int m_misses;
+    QElapsedTimer m_clock;
+    QHash<QString, Entry> m_hosts;
 };
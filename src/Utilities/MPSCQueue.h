@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_MPSC_QUEUE_H
+#define _LIB_DS_MPSC_QUEUE_H
+
+#include <QAtomicPointer>
+
+/**
+ * \brief Lock-free, unbounded queue with many producers and a single consumer
+ *
+ * Any thread can call \c push() at any time, which only allocates a node and
+ * exchanges one pointer (producers never wait for each other or for the
+ * consumer). A single thread at a time may call \c pop().
+ *
+ * This is the queue described by Dmitry Vyukov. The queue always
+ * holds one node (the last node that was consumed) so that the producers and
+ * the consumer never modify the same node.
+ *
+ * \note A value pushed by a producer can be temporarily invisible to the
+ *       consumer while another producer is in the middle of a push, the
+ *       consumer will obtain it in a later call to \c pop().
+ */
+template <typename T>
+class MPSCQueue {
+  public:
+    explicit MPSCQueue() {
+        m_tail = new Node;
+        m_head.store (m_tail);
+    }
+
+    ~MPSCQueue() {
+        T value;
+        while (pop (&value));
+
+        delete m_tail;
+    }
+
+    /**
+     * Adds the given \a value to the queue, can be called from any thread
+     */
+    void push (const T& value) {
+        Node* node = new Node;
+        node->value = value;
+
+        Node* previous = m_head.fetchAndStoreOrdered (node);
+        previous->next.storeRelease (node);
+    }
+
+    /**
+     * Removes the oldest value of the queue and copies it to the given
+     * \a value. Returns \c false if the queue is empty.
+     */
+    bool pop (T* value) {
+        Node* next = m_tail->next.loadAcquire();
+        if (!next)
+            return false;
+
+        *value = next->value;
+        next->value = T();
+
+        delete m_tail;
+        m_tail = next;
+        return true;
+    }
+
+  private:
+    struct Node {
+        Node() : next (Q_NULLPTR) {}
+
+        T value;
+        QAtomicPointer<Node> next;
+    };
+
+    Node* m_tail;
+    QAtomicPointer<Node> m_head;
+
+    Q_DISABLE_COPY (MPSCQueue)
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "PacketWriter.h"
+
+#include <string.h>
+
+/**
+ * Prepares the given \a buffer to hold up to \a capacity bytes.
+ *
+ * \note Reserving the capacity marks the buffer so that Qt does not release
+ *       its memory when it is truncated later on
+ */
+PacketWriter::PacketWriter (QByteArray* buffer, int capacity) {
+    m_size = 0;
+    m_buffer = buffer;
+    m_overflow = false;
+    m_capacity = qMax (capacity, 0);
+
+    m_buffer->reserve (m_capacity);
+    m_buffer->resize (m_capacity);
+    m_data = m_buffer->data();
+}
+
+/**
+ * Truncates the buffer to the number of bytes that have been written
+ */
+PacketWriter::~PacketWriter() {
+    m_buffer->resize (m_size);
+}
+
+/**
+ * Returns the number of bytes written so far
+ */
+int PacketWriter::size() const {
+    return m_size;
+}
+
+/**
+ * Returns \c true if some of the bytes did not fit in the buffer
+ */
+bool PacketWriter::overflow() const {
+    return m_overflow;
+}
+
+/**
+ * Writes a single \a byte
+ */
+void PacketWriter::writeByte (quint8 byte) {
+    if (m_size < m_capacity)
+        m_data [m_size++] = static_cast<char> (byte);
+    else
+        m_overflow = true;
+}
+
+/**
+ * Writes the given 16-bit \a value in network (big-endian) byte order
+ */
+void PacketWriter::writeShort (quint16 value) {
+    writeByte ((value & 0xff00) >> 8);
+    writeByte ((value & 0xff));
+}
+
+/**
+ * Writes \a length bytes from the given \a data
+ */
+void PacketWriter::writeBytes (const char* data, int length) {
+    if (length <= 0)
+        return;
+
+    if (m_size + length > m_capacity) {
+        length = m_capacity - m_size;
+        m_overflow = true;
+    }
+
+    memcpy (m_data + m_size, data, length);
+    m_size += length;
+}
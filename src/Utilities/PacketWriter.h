@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_PACKET_WRITER_H
+#define _LIB_DS_PACKET_WRITER_H
+
+#include <QByteArray>
+
+/**
+ * \brief Writes a packet into a reusable, preallocated buffer
+ *
+ * The writer reserves the given capacity in the buffer and writes the packet
+ * bytes directly into its memory. When the writer is destroyed, the buffer is
+ * truncated to the number of bytes written, without releasing its memory.
+ *
+ * If the buffer is kept between packets (e.g. as a class member) and nobody
+ * holds a copy of it when the next packet is written, generating a packet
+ * does not perform any heap allocation.
+ *
+ * \note Bytes that do not fit in the capacity are dropped, and the
+ *       \c overflow() function will return \c true.
+ */
+class PacketWriter {
+  public:
+    explicit PacketWriter (QByteArray* buffer, int capacity);
+    ~PacketWriter();
+
+    int size() const;
+    bool overflow() const;
+
+    void writeByte (quint8 byte);
+    void writeShort (quint16 value);
+    void writeBytes (const char* data, int length);
+
+  private:
+    int m_size;
+    int m_capacity;
+    bool m_overflow;
+
+    char* m_data;
+    QByteArray* m_buffer;
+};
+
+#endif
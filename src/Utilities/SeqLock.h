@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_SEQ_LOCK_H
+#define _LIB_DS_SEQ_LOCK_H
+
+#include <atomic>
+#include <string.h>
+#include <QAtomicInteger>
+
+/**
+ * \brief Lock-free, versioned value that can be read from any thread
+ *
+ * The writer increments the sequence number before and after changing the
+ * value, so the sequence is odd while the value is being written. Readers
+ * copy the value and retry if the sequence was odd or changed during the
+ * copy, so they always obtain a complete value and never block the writer.
+ *
+ * The value is stored as a set of atomic words, so that concurrent reads
+ * and writes are well defined. Because of that, \c T must be a plain struct
+ * that can be copied with \c memcpy().
+ *
+ * \note Only one thread can write at a time, writers must be serialized by
+ *       the caller
+ */
+template <typename T>
+class SeqLock {
+  public:
+    explicit SeqLock() : m_sequence (0) {
+        store (T());
+    }
+
+    /**
+     * Returns the number of times that the value has been stored
+     */
+    quint32 version() const {
+        return m_sequence.loadAcquire() / 2;
+    }
+
+    /**
+     * Returns a consistent copy of the value, the copy is retried while the
+     * writer is changing the value
+     */
+    T load() const {
+        quint32 words [WORDS];
+        quint32 before, after;
+
+        do {
+            before = m_sequence.loadAcquire();
+            for (int i = 0; i < WORDS; ++i)
+                words [i] = m_words [i].load();
+
+            std::atomic_thread_fence (std::memory_order_acquire);
+            after = m_sequence.load();
+        } while ((before & 1) || before != after);
+
+        T value;
+        memcpy (&value, words, sizeof (T));
+        return value;
+    }
+
+    /**
+     * Replaces the value and increments its version
+     */
+    void store (const T& value) {
+        quint32 words [WORDS];
+        memset (words, 0, sizeof (words));
+        memcpy (words, &value, sizeof (T));
+
+        quint32 sequence = m_sequence.load();
+        m_sequence.store (sequence + 1);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        for (int i = 0; i < WORDS; ++i)
+            m_words [i].store (words [i]);
+
+        m_sequence.storeRelease (sequence + 2);
+    }
+
+  private:
+    enum {
+        WORDS = (sizeof (T) + sizeof (quint32) - 1) / sizeof (quint32),
+    };
+
+    QAtomicInteger<quint32> m_sequence;
+    QAtomicInteger<quint32> m_words [WORDS];
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "TimeSeries.h"
+
+/**
+ * Returns the average value of the samples of the bucket
+ */
+qreal TimeSeries::Bucket::average() const {
+    return count > 0 ? sum / count : 0;
+}
+
+/**
+ * Creates a series that holds the given number of \a raw samples, one second
+ * buckets and one minute buckets
+ */
+TimeSeries::TimeSeries (int raw, int seconds, int minutes) {
+    m_tiers [kRaw].interval = 0;
+    m_tiers [kSeconds].interval = 1000;
+    m_tiers [kMinutes].interval = 60 * 1000;
+
+    m_tiers [kRaw].data.resize (qMax (raw, 1));
+    m_tiers [kSeconds].data.resize (qMax (seconds, 1));
+    m_tiers [kMinutes].data.resize (qMax (minutes, 1));
+
+    clear();
+}
+
+/**
+ * Returns the number of samples (or buckets) stored with the given
+ * \a resolution
+ */
+int TimeSeries::count (Resolution resolution) const {
+    return m_tiers [resolution].count;
+}
+
+/**
+ * Returns the stored samples (or buckets) with the given \a resolution, from
+ * the oldest to the newest one. The samples of the raw resolution are
+ * returned as buckets with a single sample.
+ */
+QVector<TimeSeries::Bucket> TimeSeries::buckets (Resolution resolution) const {
+    return buckets (m_tiers [resolution]);
+}
+
+/**
+ * Removes all the samples of the series, the memory is kept
+ */
+void TimeSeries::clear() {
+    for (int i = 0; i < 3; ++i)
+        clear (&m_tiers [i]);
+}
+
+/**
+ * Registers the given \a value at the given \a time (in milliseconds).
+ * Samples must be appended in chronological order.
+ */
+void TimeSeries::append (qint64 time, qreal value) {
+    for (int i = 0; i < 3; ++i)
+        append (&m_tiers [i], time, value);
+}
+
+/**
+ * Removes all the buckets of the given \a ring
+ */
+void TimeSeries::clear (Ring* ring) {
+    ring->head = 0;
+    ring->count = 0;
+}
+
+/**
+ * Adds the given sample to the newest bucket of the \a ring, or opens a new
+ * bucket (overwriting the oldest one when the ring is full) if the sample
+ * does not belong to the interval of the newest bucket
+ */
+void TimeSeries::append (Ring* ring, qint64 time, qreal value) {
+    int size = ring->data.count();
+    qint64 start = time;
+    if (ring->interval > 0)
+        start = time - (time % ring->interval);
+
+    /* Update the newest bucket */
+    if (ring->count > 0 && ring->interval > 0) {
+        Bucket& last = ring->data [(ring->head + size - 1) % size];
+        if (last.time == start) {
+            last.min = qMin (last.min, value);
+            last.max = qMax (last.max, value);
+            last.sum += value;
+            last.count += 1;
+            return;
+        }
+    }
+
+    /* Open a new bucket */
+    Bucket& bucket = ring->data [ring->head];
+    bucket.time = start;
+    bucket.min = value;
+    bucket.max = value;
+    bucket.sum = value;
+    bucket.count = 1;
+
+    ring->head = (ring->head + 1) % size;
+    ring->count = qMin (ring->count + 1, size);
+}
+
+/**
+ * Returns the buckets of the given \a ring in chronological order
+ */
+QVector<TimeSeries::Bucket> TimeSeries::buckets (const Ring& ring) {
+    QVector<Bucket> list;
+    list.reserve (ring.count);
+
+    int size = ring.data.count();
+    int first = (ring.head + size - ring.count) % size;
+    for (int i = 0; i < ring.count; ++i)
+        list.append (ring.data.at ((first + i) % size));
+
+    return list;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_TIME_SERIES_H
+#define _LIB_DS_TIME_SERIES_H
+
+#include <QVector>
+
+/**
+ * \brief Fixed-memory store of a time series at several resolutions
+ *
+ * The series keeps three ring buffers, whose sizes are set when the series is
+ * created and never change:
+ *
+ *   - The most recent samples, as they were appended
+ *   - One bucket per second with the minimum, maximum and average values
+ *   - One bucket per minute with the minimum, maximum and average values
+ *
+ * When a ring buffer is full, its oldest entries are overwritten. With the
+ * default sizes, the series holds the raw data of the last samples, the last
+ * 15 minutes at one second resolution and the last 24 hours at one minute
+ * resolution, no matter how long the application runs.
+ *
+ * \note The averages are the averages of the appended samples (they are not
+ *       weighted by the time that each value was held)
+ */
+class TimeSeries {
+  public:
+    /**
+     * \brief Defines the available resolutions of the series
+     */
+    enum Resolution {
+        kRaw     = 0, /**< Samples as they were appended */
+        kSeconds = 1, /**< One bucket per second */
+        kMinutes = 2, /**< One bucket per minute */
+    };
+
+    /**
+     * \brief Holds the statistics of the samples of a time interval
+     */
+    struct Bucket {
+        qint64 time;
+        qreal min;
+        qreal max;
+        qreal sum;
+        int count;
+
+        qreal average() const;
+    };
+
+    explicit TimeSeries (int raw = 512, int seconds = 900, int minutes = 1440);
+
+    int count (Resolution resolution) const;
+    QVector<Bucket> buckets (Resolution resolution) const;
+
+    void clear();
+    void append (qint64 time, qreal value);
+
+  private:
+    /**
+     * Fixed-size ring of buckets, the newest bucket may still be open
+     */
+    struct Ring {
+        int head;
+        int count;
+        qint64 interval;
+        QVector<Bucket> data;
+    };
+
+    static void clear (Ring* ring);
+    static void append (Ring* ring, qint64 time, qreal value);
+    static QVector<Bucket> buckets (const Ring& ring);
+
+  private:
+    Ring m_tiers [3];
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_TRIPLE_BUFFER_H
+#define _LIB_DS_TRIPLE_BUFFER_H
+
+#include <QAtomicInt>
+
+/**
+ * \brief Lock-free channel that passes whole frames from one thread to another
+ *
+ * The producer writes a complete frame into \c back() and calls \c publish().
+ * The consumer calls \c update() and reads the newest published frame with
+ * \c front(). Neither side ever waits for the other one: the producer can
+ * publish as often as it wants, and the consumer always sees a consistent
+ * frame (intermediate frames that were never read are simply skipped).
+ *
+ * Three buffers are used, one owned by each side and one in the middle. Both
+ * sides exchange their buffer with the middle one atomically, the middle
+ * index carries a flag that tells the consumer if it holds a new frame.
+ *
+ * \note There must be only one producer thread and one consumer thread
+ */
+template <typename T>
+class TripleBuffer {
+  public:
+    explicit TripleBuffer() : m_middle (2) {
+        m_back = 0;
+        m_front = 1;
+    }
+
+    /**
+     * Returns the frame that is written by the producer. Its contents are
+     * undefined after calling \c publish(), so the producer must write the
+     * whole frame every time.
+     */
+    T& back() {
+        return m_buffers [m_back];
+    }
+
+    /**
+     * Returns the newest frame obtained with \c update()
+     */
+    const T& front() const {
+        return m_buffers [m_front];
+    }
+
+    /**
+     * Makes the frame written in \c back() available to the consumer
+     */
+    void publish() {
+        m_back = m_middle.fetchAndStoreOrdered (m_back | kNewFrame) & kIndex;
+    }
+
+    /**
+     * Obtains the newest published frame (if any), returns \c true if the
+     * frame returned by \c front() changed.
+     */
+    bool update() {
+        if (!(m_middle.loadAcquire() & kNewFrame))
+            return false;
+
+        m_front = m_middle.fetchAndStoreOrdered (m_front) & kIndex;
+        return true;
+    }
+
+  private:
+    enum {
+        kIndex = 0x03,
+        kNewFrame = 0x04,
+    };
+
+    int m_back;
+    int m_front;
+    T m_buffers [3];
+    QAtomicInt m_middle;
+};
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#include "VoltageCodec.h"
+
+/**
+ * Decodes a voltage sent in BCD (e.g. \c 0x12 \c 0x43 is 12.43 V).
+ * If any of the digits is not a decimal digit, the voltage is 0.
+ */
+quint16 VoltageCodec::decodeBCD (quint8 integer, quint8 decimal) {
+    quint32 word = ((quint32) integer << 8) | decimal;
+    quint32 units = word & 0x0f0f;
+    quint32 tens = (word >> 4) & 0x0f0f;
+
+    /* A digit above 9 sets bit 4 of its byte when 6 is added to it */
+    quint32 invalid = ((units + 0x0606) | (tens + 0x0606)) & 0x1010;
+    quint32 mask = (quint32) (invalid != 0) - 1;
+
+    quint32 centivolts = (tens >> 8) * 1000 + (units >> 8) * 100
+                         + (tens & 0xff) * 10 + (units & 0xff);
+
+    return centivolts & mask;
+}
+
+/**
+ * Decodes a voltage sent in 1/256 V units, the result is rounded to the
+ * nearest centivolt
+ */
+quint16 VoltageCodec::decodeFixedPoint (quint8 integer, quint8 fraction) {
+    quint32 word = ((quint32) integer << 8) | fraction;
+    return (word * 100 + 128) >> 8;
+}
+
+/**
+ * Returns the given \a centivolts in volts
+ */
+qreal VoltageCodec::toVolts (quint16 centivolts) {
+    return centivolts / 100.0;
+}
+
+/**
+ * Returns the given \a voltage in centivolts, bounded between 0 and the
+ * largest voltage whose integer part fits in a byte
+ */
+quint16 VoltageCodec::fromVolts (qreal voltage) {
+    return qRound (qBound (0.0, voltage * 100, (qreal) MAX_CENTIVOLTS));
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef _LIB_DS_VOLTAGE_CODEC_H
+#define _LIB_DS_VOLTAGE_CODEC_H
+
+#include <QtGlobal>
+
+/**
+ * \brief Converts battery voltages between the formats used by the robot
+ *        controllers and centivolts (hundredths of a volt)
+ *
+ * The robot controllers send the voltage in two bytes, using one of these
+ * formats:
+ *   - BCD: the cRIO sends each digit as a nibble (12.43 V is \c 0x12 \c 0x43)
+ *   - Fixed point: the roboRIO sends the voltage in 1/256 V units, with the
+ *     integer part in the first byte and the fraction in the second one
+ *
+ * Both formats are decoded with integer arithmetic and without branches.
+ * Voltages are kept as centivolts, so that they can be compared exactly.
+ */
+class VoltageCodec {
+  public:
+    static const quint16 MAX_CENTIVOLTS = 25599;
+
+    static quint16 decodeBCD (quint8 integer, quint8 decimal);
+    static quint16 decodeFixedPoint (quint8 integer, quint8 fraction);
+
+    static qreal toVolts (quint16 centivolts);
+    static quint16 fromVolts (qreal voltage);
+};
+
+#endif
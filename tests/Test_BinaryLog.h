@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_BINARY_LOG
+#define TEST_BINARY_LOG
+
+#include <QtTest>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <Utilities/CRC32.h>
+#include <Utilities/LogReader.h>
+#include <Utilities/LogCompactor.h>
+#include <Utilities/LogWriter.h>
+
+//==============================================================================
+// BINARY LOG TEST
+//==============================================================================
+
+class Test_BinaryLog : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        QVERIFY (m_dir.isValid());
+        m_path = m_dir.path() + "/test.qdslog";
+
+        /* Write the records in two chunks */
+        LogWriter writer;
+        QVERIFY (writer.open (m_path));
+
+        writer.append (1, 10, (qint64) 40);
+        writer.append (1, 1000, (qint64) -7);
+        writer.append (4, 10, (qreal) 12.5);
+        writer.append (4, 20, (qreal) 12.25);
+        writer.append (12, 50, QByteArray ("Hello "));
+        writer.append (14, 30, (qreal) 4.5);
+        QVERIFY (writer.flush());
+
+        writer.append (4, 35, (qreal) -3.0);
+        writer.append (12, 60, QByteArray ("World"));
+        writer.append (0, 2000, (qint64) 2000);
+        writer.close();
+    }
+
+    void checkHeader() {
+        QVERIFY (LogReader::isBinaryLog (m_path));
+        QVERIFY (!LogReader::isBinaryLog (QByteArray ("[0,[],[]]")));
+    }
+
+    void checkRecords() {
+        QJsonArray array = LogReader::read (m_path).array();
+        QCOMPARE (array.count(), 16);
+        QCOMPARE (array.at (0).toVariant().toLongLong(), 2000LL);
+
+        /* Integer series */
+        QJsonArray cpu = array.at (1).toArray();
+        QCOMPARE (cpu.count(), 2);
+        QCOMPARE (cpu.at (1).toObject().value ("t").toInt(), 1000);
+        QCOMPARE (cpu.at (1).toObject().value ("d").toInt(), -7);
+
+        /* Real series (spread over two chunks) */
+        QJsonArray voltage = array.at (4).toArray();
+        QCOMPARE (voltage.count(), 3);
+        QCOMPARE (voltage.at (0).toObject().value ("d").toDouble(), 12.5);
+        QCOMPARE (voltage.at (1).toObject().value ("d").toDouble(), 12.25);
+        QCOMPARE (voltage.at (2).toObject().value ("t").toInt(), 35);
+        QCOMPARE (voltage.at (2).toObject().value ("d").toDouble(), -3.0);
+
+        /* Text series */
+        QCOMPARE (array.at (12).toString(), QString ("Hello World"));
+        QCOMPARE (array.at (13).toString(), QString (""));
+
+        /* Series that the legacy logs do not have */
+        QJsonArray rtt = array.at (14).toArray();
+        QCOMPARE (rtt.count(), 1);
+        QCOMPARE (rtt.at (0).toObject().value ("d").toDouble(), 4.5);
+        QVERIFY (array.at (15).toArray().isEmpty());
+    }
+
+    void checkTruncatedFile() {
+        QFile file (m_path);
+        QVERIFY (file.open (QFile::ReadOnly));
+        QByteArray data = file.readAll();
+        file.close();
+
+        /* The incomplete chunk is ignored, the previous chunks are kept */
+        QJsonArray array = LogReader::read (data.left (data.size() - 2)).array();
+        QCOMPARE (array.count(), 16);
+        QCOMPARE (array.at (1).toArray().count(), 2);
+        QCOMPARE (array.at (4).toArray().count(), 3);
+        QCOMPARE (array.at (12).toString(), QString ("Hello "));
+    }
+
+    void checkCorruptChunk() {
+        QFile file (m_path);
+        QVERIFY (file.open (QFile::ReadOnly));
+        QByteArray data = file.readAll();
+        file.close();
+
+        /* Append a chunk whose size (2^64 - 3) wraps around when padded */
+        data.append ((char) LogWriter::CHUNK_SYNC);
+        data.append ((char) 4);
+        data.append ((char) LogWriter::kReal);
+        data.append ((char) 1);
+        data.append ((char) 0xfd);
+        data.append (QByteArray (8, (char) 0xff));
+        data.append ((char) 0x01);
+        data.append (QByteArray (8, (char) 0xaa));
+
+        /* The corrupt chunk is ignored, the previous chunks are kept */
+        QJsonArray array = LogReader::read (data).array();
+        QCOMPARE (array.count(), 16);
+        QCOMPARE (array.at (4).toArray().count(), 3);
+        QCOMPARE (array.at (12).toString(), QString ("Hello World"));
+    }
+
+    void checkCorruptData() {
+        QFile file (m_path);
+        QVERIFY (file.open (QFile::ReadOnly));
+        QByteArray data = file.readAll();
+        file.close();
+
+        /* Overwrite the sync byte of the first chunk (CPU usage) */
+        data [LogWriter::MAGIC_SIZE + 2] = 0x00;
+
+        /* The reader skips the corrupt chunk and indexes the next ones */
+        LogReader reader;
+        QVERIFY (reader.open (data));
+        QCOMPARE (reader.count (1), 0);
+        QCOMPARE (reader.count (4), 3);
+        QCOMPARE (reader.text (12), QByteArray ("Hello World"));
+        QCOMPARE (reader.ignoredChunks(), 1);
+    }
+
+    void checkMismatchedType() {
+        QFile file (m_path);
+        QVERIFY (file.open (QFile::ReadOnly));
+        QByteArray data = file.readAll();
+        file.close();
+
+        /* Append a valid integer chunk to the (real) voltage series */
+        QByteArray payload (2, (char) 0x00);
+        quint32 crc = CRC32::checksum (payload.constData(), payload.size());
+        data.append ((char) LogWriter::CHUNK_SYNC);
+        data.append ((char) 4);
+        data.append ((char) LogWriter::kInteger);
+        data.append ((char) 1);
+        data.append ((char) payload.size());
+        data.append (payload);
+        for (int i = 0; i < 4; ++i)
+            data.append ((char) ((crc >> (8 * i)) & 0xff));
+
+        /* The chunk is counted, but not added to the series */
+        LogReader reader;
+        QVERIFY (reader.open (data));
+        QCOMPARE (reader.count (4), 3);
+        QCOMPARE (reader.ignoredChunks(), 1);
+    }
+
+    void checkRange() {
+        LogReader reader;
+        QVERIFY (reader.open (m_path));
+        QCOMPARE (reader.duration(), 2000LL);
+        QCOMPARE (reader.count (4), 3);
+
+        /* Only the records inside the time range are obtained */
+        QVector<LogReader::Point> points = reader.range (4, 15, 40);
+        QCOMPARE (points.count(), 2);
+        QCOMPARE (points.at (0).time, 20LL);
+        QCOMPARE (points.at (1).value, -3.0);
+
+        /* Text series are not numeric */
+        QVERIFY (reader.range (12, 0, 100).isEmpty());
+    }
+
+    void checkDownsample() {
+        QString path = m_dir.path() + "/downsample.qdslog";
+
+        LogWriter writer;
+        QVERIFY (writer.open (path));
+        for (int i = 0; i < 1000; ++i)
+            writer.append (4, i * 20, (qreal) (i == 500 ? 6.5 : 12.5));
+        writer.close();
+
+        LogReader reader;
+        QVERIFY (reader.open (path));
+
+        /* The voltage drop must survive the downsampling */
+        QVector<LogReader::Point> points = reader.downsample (4, 50, 0, 20000);
+        QVERIFY (points.count() <= 50);
+
+        bool drop = false;
+        for (int i = 0; i < points.count(); ++i) {
+            drop |= (points.at (i).value == 6.5);
+            if (i > 0)
+                QVERIFY (points.at (i).time > points.at (i - 1).time);
+        }
+
+        QVERIFY (drop);
+    }
+
+    void checkRealCompression() {
+        QString path = m_dir.path() + "/real.qdslog";
+
+        /* A slowly changing voltage only changes the high mantissa bytes */
+        LogWriter writer;
+        QVERIFY (writer.open (path));
+        for (int i = 0; i < 1000; ++i)
+            writer.append (4, i * 20, (qreal) (12.5 - i / 256.0));
+        QVERIFY (writer.flush());
+
+        /* Each record needs about four bytes, not the ten of a raw double */
+        QVERIFY (writer.fileSize() < 4 * 1000);
+        writer.close();
+
+        LogReader reader;
+        QVERIFY (reader.open (path));
+        QVector<LogReader::Point> points = reader.range (4, 0, 20000);
+        QCOMPARE (points.count(), 1000);
+        for (int i = 0; i < points.count(); ++i)
+            QCOMPARE (points.at (i).value, 12.5 - i / 256.0);
+    }
+
+    void checkRefresh() {
+        QString path = m_dir.path() + "/refresh.qdslog";
+
+        LogWriter writer;
+        QVERIFY (writer.open (path));
+        writer.append (3, 10, (qint64) 1);
+        QVERIFY (writer.flush());
+
+        LogReader reader;
+        QVERIFY (reader.open (path));
+        QCOMPARE (reader.count (3), 1);
+        QVERIFY (!reader.refresh());
+
+        /* Only the appended chunk is indexed */
+        writer.append (3, 20, (qint64) 2);
+        QVERIFY (writer.flush());
+        QVERIFY (reader.refresh());
+        QCOMPARE (reader.count (3), 2);
+        QCOMPARE (reader.range (3, 0, 100).last().value, 2.0);
+    }
+
+    void checkCompaction() {
+        QString path = m_dir.path() + "/compact.qdslog";
+
+        /* Save the log many times */
+        LogWriter writer;
+        QVERIFY (writer.open (path));
+        for (int i = 0; i < 100; ++i) {
+            writer.append (4, i * 100, (qreal) (12 - (i % 4) * 0.5));
+            writer.append (0, i * 100, (qint64) i * 100);
+            QVERIFY (writer.flush());
+        }
+        writer.close();
+
+        /* Compact it and check the summary */
+        QJsonObject summary = LogCompactor::compact (path);
+        QCOMPARE (summary.value ("duration").toInt(), 9900);
+        QCOMPARE (summary.value ("voltage").toObject().value ("min").toDouble(),
+                  10.5);
+
+        /* The compacted log holds the same records */
+        LogReader reader;
+        QVERIFY (reader.open (path));
+        QVERIFY (reader.isCompressed());
+        QCOMPARE (reader.count (4), 100);
+        QCOMPARE (reader.range (4, 500, 500).first().value, 11.5);
+        QCOMPARE (reader.duration(), 9900LL);
+    }
+
+    void checkLegacyCompaction() {
+        QString path = m_dir.path() + "/legacy.qdslog";
+
+        QFile file (path);
+        QVERIFY (file.open (QFile::WriteOnly));
+        file.write ("[1500,[],[],[{\"t\":10,\"d\":4}],"
+                    "[{\"t\":10,\"d\":12.5},{\"t\":20,\"d\":7.25}],"
+                    "[],[],[],[],[],[],[],\"Console\",\"\"]");
+        file.close();
+
+        QJsonObject summary = LogCompactor::compact (path);
+        QCOMPARE (summary.value ("duration").toInt(), 1500);
+        QCOMPARE (summary.value ("packetLoss").toObject().value ("max").toInt(),
+                  4);
+
+        /* The legacy log is now a binary log */
+        QJsonArray array = LogReader::read (path).array();
+        QCOMPARE (array.count(), 16);
+        QCOMPARE (array.at (4).toArray().count(), 2);
+        QCOMPARE (array.at (12).toString(), QString ("Console"));
+    }
+
+  private:
+    QString m_path;
+    QTemporaryDir m_dir;
+};
+
+#endif
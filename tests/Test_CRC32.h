@@ -25,7 +25,85 @@ class Test_CRC32 : public QObject {
         crc32.update (QString ("@Ahead)Together!FRC^2016").toUtf8());
 
         QVERIFY (crc32.value() == 0x0C5455B1);
+
+        /* Generate the table used by the previous implementation */
+        for (int n = 0; n < 256; n++) {
+            int c = n;
+            for (int k = 8; --k >= 0;) {
+                if ((c & 1) != 0)
+                    c = 0xEDB88320 ^ (((quint32) c) >> 1);
+                else
+                    c = ((quint32) c) >> 1;
+            }
+            table [n] = c;
+        }
+
+        /* Generate the buffer used by the comparison and benchmarks */
+        data.resize (1024);
+        for (int i = 0; i < data.length(); ++i)
+            data [i] = static_cast<char> ((i * 131) ^ (i >> 3));
+    }
+
+    void checkStreaming() {
+        CRC32 crc32;
+        crc32.update (data.constData(), 100);
+        crc32.update (data.constData() + 100, data.length() - 100);
+        QVERIFY (crc32.value() == legacyChecksum (data.constData(), 1024));
+
+        crc32.reset();
+        crc32.update (data.constData(), 8);
+        QVERIFY (crc32.value() == legacyChecksum (data.constData(), 8));
+    }
+
+    void checkAgainstBytewise() {
+        /* Check every length and alignment used by the fast kernels */
+        for (int offset = 0; offset < 16; ++offset) {
+            for (int length = 0; length < 300; ++length) {
+                const char* buffer = data.constData() + offset;
+                QVERIFY (CRC32::checksum (buffer, length)
+                         == legacyChecksum (buffer, length));
+            }
+        }
+    }
+
+    void checkCombine() {
+        QByteArray message = QString ("@Ahead)Together!FRC^2016").toUtf8();
+
+        quint32 first = CRC32::checksum (message.constData(), 8);
+        quint32 second = CRC32::checksum (message.constData() + 8,
+                                          message.length() - 8);
+
+        quint32 op = CRC32::combineOperator (message.length() - 8);
+        QVERIFY (CRC32::combine (first, second, op) == 0x0C5455B1);
+    }
+
+    void benchmarkChecksum() {
+        QBENCHMARK {
+            CRC32::checksum (data.constData(), data.length());
+        }
+    }
+
+    void benchmarkLegacyChecksum() {
+        QBENCHMARK {
+            legacyChecksum (data.constData(), data.length());
+        }
     }
+
+  private:
+    /**
+     * Byte-wise algorithm used by the previous implementation of the
+     * \c CRC32 class
+     */
+    quint32 legacyChecksum (const char* buf, int len) {
+        int c = ~0;
+        while (--len >= 0)
+            c = table [(c ^ *buf++) & 0xff] ^ (((quint32) c) >> 8);
+
+        return ~c;
+    }
+
+    int table [256];
+    QByteArray data;
 };
 
 #endif
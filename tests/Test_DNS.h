@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_DNS
+#define TEST_DNS
+
+#include <QtTest>
+#include <DNSMessage.h>
+
+//==============================================================================
+// DNS MESSAGE TEST
+//==============================================================================
+
+class Test_DNS : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        char ipv6 [16];
+        memset (ipv6, 0xab, sizeof (ipv6));
+
+        /* Build a response with one question, one A and one AAAA record */
+        DNSBuilder builder (buffer, sizeof (buffer));
+        builder.header (0x1234, 0x8000, 1, 1, 0, 1);
+        builder.name ("roboRIO-3794-FRC.local.", 23);
+        builder.write16 (0x0001);
+        builder.write16 (0x0001);
+        builder.pointer (DNSView::HEADER_SIZE);
+        builder.write16 (0x0001);
+        builder.write16 (0x8001);
+        builder.write32 (120);
+        builder.write16 (4);
+        builder.write32 (0x0a250e02);
+        builder.pointer (DNSView::HEADER_SIZE);
+        builder.write16 (0x001c);
+        builder.write16 (0x8001);
+        builder.write32 (120);
+        builder.write16 (sizeof (ipv6));
+        builder.write (ipv6, sizeof (ipv6));
+
+        QVERIFY (builder.isValid());
+        size = builder.size();
+    }
+
+    void checkView() {
+        DNSView view (buffer, size);
+        QVERIFY (view.isValid());
+        QVERIFY (view.isResponse());
+        QCOMPARE (view.id(), (quint16) 0x1234);
+        QCOMPARE (view.count(), 3);
+
+        QCOMPARE (view.entry (0).section, (int) DNSView::kQuestion);
+        QCOMPARE (view.entry (1).section, (int) DNSView::kAnswer);
+        QCOMPARE (view.entry (2).section, (int) DNSView::kAdditional);
+
+        QCOMPARE (view.entry (1).ttl, (quint32) 120);
+        QCOMPARE (view.entry (1).length, 4);
+        QCOMPARE (view.read32 (view.entry (1).data), (quint32) 0x0a250e02);
+        QCOMPARE (view.entry (2).type, (quint16) 0x001c);
+        QCOMPARE (view.entry (2).length, 16);
+    }
+
+    void checkNames() {
+        DNSView view (buffer, size);
+
+        /* Compressed names are followed */
+        char name [DNSView::MAX_NAME_LENGTH + 1];
+        int length = view.readName (view.entry (2).name, name, sizeof (name));
+        QCOMPARE (QByteArray (name, length),
+                  QByteArray ("roboRIO-3794-FRC.local"));
+
+        QVERIFY (view.namesEqual (view.entry (0).name, view.entry (2).name));
+        QVERIFY (view.nameEquals (view.entry (1).name,
+                                  "ROBORIO-3794-frc.local", 22));
+        QVERIFY (!view.nameEquals (view.entry (1).name,
+                                   "roborio-3794-frc.loc", 20));
+        QVERIFY (!view.nameEquals (view.entry (1).name,
+                                   "roborio-3794-frc.local.x", 24));
+    }
+
+    void checkPointerLoop() {
+        const char data [] = {
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, (char) 0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01
+        };
+
+        /* The name points to itself, it must be rejected */
+        char name [DNSView::MAX_NAME_LENGTH + 1];
+        DNSView view (data, sizeof (data));
+        QVERIFY (view.isValid());
+        QCOMPARE (view.readName (view.entry (0).name, name, sizeof (name)), -1);
+        QVERIFY (!view.nameEquals (view.entry (0).name, "a", 1));
+    }
+
+    void checkBuilderOverflow() {
+        char small [16];
+        DNSBuilder builder (small, sizeof (small));
+        builder.header (0, 0, 1, 0, 0, 0);
+        builder.name ("roborio-3794-frc.local", 22);
+        QVERIFY (!builder.isValid());
+
+        DNSBuilder invalid (buffer, sizeof (buffer));
+        invalid.name ("empty..label", 12);
+        QVERIFY (!invalid.isValid());
+    }
+
+    void checkFuzz() {
+        qsrand (3794);
+        char name [DNSView::MAX_NAME_LENGTH + 1];
+
+        /* Mutated and truncated messages must never be read out of bounds */
+        for (int i = 0; i < 100000; ++i) {
+            QByteArray data (buffer, size);
+            for (int j = qrand() % 4; j >= 0; --j)
+                data [qrand() % size] = (char) qrand();
+
+            if (qrand() % 4 == 0)
+                data.truncate (qrand() % size);
+
+            DNSView view (data.constData(), data.length());
+            for (int j = 0; j < view.count(); ++j) {
+                const DNSView::Entry& entry = view.entry (j);
+                view.readName (entry.name, name, sizeof (name));
+                view.namesEqual (entry.name, view.entry (0).name);
+                QVERIFY (entry.data + entry.length <= data.length());
+            }
+        }
+    }
+
+    void benchmarkView() {
+        char name [DNSView::MAX_NAME_LENGTH + 1];
+
+        QBENCHMARK {
+            DNSView view (buffer, size);
+            view.readName (view.entry (1).name, name, sizeof (name));
+        }
+    }
+
+  private:
+    int size;
+    char buffer [512];
+};
+
+#endif
@@ -10,9 +10,72 @@
 #define TEST_DS_CONFIG
 
 #include <QtTest>
+#include <Core/DS_Config.h>
 
 class Test_DS_Config : public QObject {
     Q_OBJECT
+
+  private slots:
+    void checkBatch() {
+        DS_Config* config = DS_Config::getInstance();
+        config->updateCpuUsage (0);
+        config->updateRamUsage (0);
+
+        QSignalSpy state (config, SIGNAL (stateChanged (int)));
+        QSignalSpy cpu (config, SIGNAL (cpuUsageChanged (int)));
+        QSignalSpy ram (config, SIGNAL (ramUsageChanged (int)));
+
+        /* Every change of the batch is reported once */
+        config->beginBatch();
+        config->updateCpuUsage (10);
+        config->updateCpuUsage (20);
+        config->updateRamUsage (30);
+        QCOMPARE (state.count(), 0);
+        config->endBatch();
+
+        QCOMPARE (cpu.count(), 1);
+        QCOMPARE (ram.count(), 1);
+        QCOMPARE (cpu.first().at (0).toInt(), 20);
+        QCOMPARE (state.count(), 1);
+        QCOMPARE (state.first().at (0).toInt(),
+                  (int) (DS::kCpuUsageChanged | DS::kRamUsageChanged));
+    }
+
+    void checkUnchangedBatch() {
+        DS_Config* config = DS_Config::getInstance();
+        config->updateCpuUsage (50);
+
+        QSignalSpy state (config, SIGNAL (stateChanged (int)));
+        QSignalSpy cpu (config, SIGNAL (cpuUsageChanged (int)));
+
+        /* Values that did not change do not generate any signal */
+        config->beginBatch();
+        config->beginBatch();
+        config->updateCpuUsage (50);
+        config->endBatch();
+        config->endBatch();
+
+        QCOMPARE (cpu.count(), 0);
+        QCOMPARE (state.count(), 0);
+    }
+
+    void checkStateSnapshot() {
+        DS_Config* config = DS_Config::getInstance();
+        config->updateCpuUsage (0);
+        quint32 version = config->state().version;
+
+        /* A batch publishes a single snapshot */
+        config->beginBatch();
+        config->updateCpuUsage (60);
+        config->updateRamUsage (70);
+        QCOMPARE (config->state().version, version);
+        config->endBatch();
+
+        DS_Config::State state = config->state();
+        QCOMPARE (state.version, version + 1);
+        QCOMPARE (state.cpuUsage, 60);
+        QCOMPARE (state.ramUsage, 70);
+    }
 };
 
 #endif
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_FRC_2015
+#define TEST_FRC_2015
+
+#include <QtTest>
+#include <DriverStation.h>
+#include <Protocols/FRC_2015.h>
+
+//==============================================================================
+// FRC 2015 ROBOT PACKET TEST
+//==============================================================================
+
+class Test_FRC_2015 : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        DriverStation* ds = DriverStation::getInstance();
+        ds->setProtocolType (DriverStation::kFRC2015);
+        ds->registerJoystick (6, 12, 1);
+        ds->updateButton (0, 0, true);
+        ds->updateButton (0, 11, true);
+
+        /* Skip the first packets, which do not contain joystick data */
+        for (int i = 0; i < 10; ++i)
+            protocol.generateRobotPacket();
+    }
+
+    void checkDescriptor() {
+        /* The protocol constants come from its descriptor */
+        QCOMPARE (protocol.fmsFrequency(), 2);
+        QCOMPARE (protocol.robotFrequency(), 50);
+        QCOMPARE (protocol.robotOutputPort(), 1110);
+        QCOMPARE (protocol.netconsoleInputPort(), 6666);
+        QCOMPARE (protocol.radioInputPort(), DS_DISABLED_PORT);
+        QCOMPARE (protocol.maxPOVCount(), 1);
+        QCOMPARE (protocol.maxJoystickCount(), 6);
+        QCOMPARE (protocol.robotSocketType(), DS::kSocketTypeUDP);
+    }
+
+    void checkJoystickData() {
+        QByteArray packet = protocol.generateRobotPacket();
+
+        /* Header, 6 axes, 12 buttons and 1 POV */
+        QCOMPARE (packet.size(), 21);
+        QCOMPARE ((quint8) packet.at (7), (quint8) 0x0c);
+        QCOMPARE ((quint8) packet.at (15), (quint8) 12);
+        QCOMPARE ((quint8) packet.at (16), (quint8) 0x08);
+        QCOMPARE ((quint8) packet.at (17), (quint8) 0x01);
+    }
+
+    void checkAxisData() {
+        DriverStation* ds = DriverStation::getInstance();
+        ds->updateAxis (0, 0, 1);
+        ds->updateAxis (0, 5, -2);
+
+        /* Axes are sent as quantized signed bytes */
+        QByteArray packet = protocol.generateRobotPacket();
+        QCOMPARE ((qint8) packet.at (9), (qint8) 127);
+        QCOMPARE ((qint8) packet.at (14), (qint8) -127);
+
+        ds->updateAxis (0, 0, 0);
+        ds->updateAxis (0, 5, 0);
+    }
+
+    void checkBufferReuse() {
+        QByteArray first = protocol.generateRobotPacket();
+        const char* buffer = first.constData();
+        first = QByteArray();
+
+        /* Every packet must be written in the same memory block */
+        for (int i = 0; i < 1000; ++i) {
+            QByteArray packet = protocol.generateRobotPacket();
+            QVERIFY (packet.constData() == buffer);
+        }
+    }
+
+    void checkSynthesizedPackets() {
+        DS_Config* config = DS_Config::getInstance();
+        QList<QByteArray> packets = synthesizedPackets();
+
+        /* Status only, robot program running at 12.35 V */
+        QVERIFY (protocol.interpretRobotPacket (packets.at (0)));
+        QCOMPARE (protocol.robotPacketIndex (packets.at (0)), 0x0f00);
+        QCOMPARE (config->voltage(), 12.35);
+        QVERIFY (config->isRobotCodeRunning());
+        QVERIFY (!config->isEmergencyStopped());
+
+        /* The robot asks for the date and time */
+        QVERIFY (protocol.interpretRobotPacket (packets.at (1)));
+        QCOMPARE (config->voltage(), 12.3);
+
+        /* Every extended section is read, not only the first one */
+        QVERIFY (protocol.interpretRobotPacket (packets.at (2)));
+        QCOMPARE (protocol.robotPacketIndex (packets.at (2)), 0x0f02);
+        QCOMPARE (config->diskUsage(), 42);
+        QCOMPARE (config->cpuUsage(), 23);
+        QCOMPARE (config->ramUsage(), 51);
+        QCOMPARE (config->canUsage(), 24);
+    }
+
+    void checkTruncatedSection() {
+        DS_Config* config = DS_Config::getInstance();
+        QByteArray packet = synthesizedPackets().at (2);
+
+        /* Truncated sections are ignored */
+        config->updateCanUsage (0);
+        packet.chop (1);
+        QVERIFY (protocol.interpretRobotPacket (packet));
+        QCOMPARE (config->canUsage(), 0);
+        QCOMPARE (config->ramUsage(), 51);
+    }
+
+    void benchmarkRobotStatus() {
+        QList<QByteArray> packets = synthesizedPackets();
+        QBENCHMARK {
+            foreach (const QByteArray& packet, packets)
+                protocol.interpretRobotPacket (packet);
+        }
+    }
+
+    void benchmarkRobotPacket() {
+        QBENCHMARK {
+            protocol.generateRobotPacket();
+        }
+    }
+
+  private:
+    /**
+     * Returns consecutive status packets of a roboRIO running a robot
+     * program (in teleoperated, enabled), written by hand following the
+     * documented layout of the 2015 protocol.
+     *
+     * \note These packets are not recorded data: they use the same offsets
+     *       as the decoder, so they cannot catch an offset bug
+     *
+     * Layout:
+     *
+     *   - Index, general tag, control, status, voltage (1/256 V), request
+     *   - Extended sections: size (without itself), tag and data
+     *
+     * The last packet carries the joystick outputs, the disk, CPU (two
+     * cores), RAM and CAN metrics (24.0% bus utilization, sent as a
+     * big-endian float, followed by the bus-off, TX full and error counts)
+     */
+    static QList<QByteArray> synthesizedPackets() {
+        QList<QByteArray> packets;
+        packets.append (QByteArray::fromHex ("0f000104300c5a00"));
+        packets.append (QByteArray::fromHex ("0f010104300c4d01"));
+        packets.append (QByteArray::fromHex (
+                            "0f020104300c4d00"
+                            "09010000000000000000"
+                            "05040000002a"
+                            "2205020000000000000000000017000000000000"
+                            "000000000000000000000000000000"
+                            "09060000003300000000"
+                            "0f0e41c0000000000000000000030000"));
+        return packets;
+    }
+
+    FRC_2015 protocol;
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_LINK_STATISTICS
+#define TEST_LINK_STATISTICS
+
+#include <QtTest>
+#include <Utilities/LinkStatistics.h>
+
+//==============================================================================
+// LINK STATISTICS TEST
+//==============================================================================
+
+class Test_LinkStatistics : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void checkHistogram() {
+        typedef LinkStatistics::Histogram Histogram;
+
+        /* Every value falls between the bounds of its bucket */
+        for (qint64 value = 0; value < 1 << 26; value += 1 + value / 64) {
+            int bucket = Histogram::bucket (value);
+            QVERIFY (Histogram::lowerBound (bucket) <= value);
+            QVERIFY (Histogram::lowerBound (bucket + 1) > value);
+        }
+
+        /* Percentiles are within the precision of the buckets */
+        Histogram histogram;
+        for (int i = 1; i <= 1000; ++i)
+            histogram.record (i * 1000);
+
+        QCOMPARE (histogram.count(), 1000LL);
+        QCOMPARE (histogram.maximum(), 1000000LL);
+        QVERIFY (qAbs (histogram.percentile (50) - 500000) < 500000 / 16);
+        QVERIFY (qAbs (histogram.percentile (99) - 990000) < 990000 / 16);
+    }
+
+    void checkRoundTrip() {
+        LinkStatistics link;
+
+        /* 50 Hz stream, answered after 3 or 5 ms */
+        for (int i = 0; i < 100; ++i) {
+            link.registerSent (i, i * 20000);
+            link.registerReceived (i, i * 20000 + (i % 2 ? 5000 : 3000));
+        }
+
+        LinkStatistics::Summary summary = link.summary();
+        QCOMPARE (summary.sent, 100LL);
+        QCOMPARE (summary.received, 100LL);
+        QCOMPARE (summary.lost, 0LL);
+        QCOMPARE (summary.bursts, 0LL);
+        QCOMPARE (summary.rttMax, 5.0);
+        QVERIFY (summary.rtt >= 2.9 && summary.rtt <= 5.1);
+        QVERIFY (summary.jitter > 1.5 && summary.jitter <= 2.0);
+    }
+
+    void checkLossBursts() {
+        LinkStatistics link;
+
+        /* Packets 10-12 and 50 are lost */
+        for (int i = 0; i < 100; ++i) {
+            link.registerSent (i, i * 20000);
+            if ((i < 10 || i > 12) && i != 50)
+                link.registerReceived (i, i * 20000 + 3000);
+        }
+
+        LinkStatistics::Summary summary = link.summary();
+        QCOMPARE (summary.lost, 4LL);
+        QCOMPARE (summary.bursts, 2LL);
+        QCOMPARE (summary.maxBurst, 3LL);
+        QCOMPARE (summary.reordered, 0LL);
+    }
+
+    void checkReordering() {
+        LinkStatistics link;
+        for (int i = 0; i < 4; ++i)
+            link.registerSent (i, i * 20000);
+
+        /* Packet 1 arrives after packet 2, packet 3 arrives twice */
+        link.registerReceived (0, 63000);
+        link.registerReceived (2, 63500);
+        link.registerReceived (1, 64000);
+        link.registerReceived (3, 64500);
+        link.registerReceived (3, 65000);
+
+        LinkStatistics::Summary summary = link.summary();
+        QCOMPARE (summary.received, 4LL);
+        QCOMPARE (summary.lost, 0LL);
+        QCOMPARE (summary.reordered, 1LL);
+        QCOMPARE (summary.duplicated, 1LL);
+    }
+
+    void checkIndexWrapAround() {
+        LinkStatistics link;
+
+        /* The 16-bit packet index wraps around during the stream */
+        for (int i = 65000; i < 66000; ++i) {
+            link.registerSent (i & 0xffff, i * 20000LL);
+            link.registerReceived (i & 0xffff, i * 20000LL + 3000);
+        }
+
+        /* Indexes that were not sent yet or that are too old are ignored */
+        link.registerReceived (1000, 0);
+        link.registerReceived (64000, 0);
+
+        LinkStatistics::Summary summary = link.summary();
+        QCOMPARE (summary.received, 1000LL);
+        QCOMPARE (summary.lost, 0LL);
+        QCOMPARE (summary.duplicated, 0LL);
+        QCOMPARE (summary.rttMax, 3.0);
+    }
+};
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_LOOKUP
+#define TEST_LOOKUP
+
+#include <QtTest>
+#include <qMDNS.h>
+#include <Utilities/Lookup.h>
+
+//==============================================================================
+// LOOKUP CACHE TEST
+//==============================================================================
+
+class Test_Lookup : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void checkNormalize() {
+        QCOMPARE (Lookup::normalize ("roboRIO-3794-FRC"),
+                  QString ("roborio-3794-frc.local"));
+        QCOMPARE (Lookup::normalize (" roboRIO-3794-FRC.local. "),
+                  QString ("roborio-3794-frc.local"));
+        QCOMPARE (Lookup::normalize ("Example.com"), QString ("example.com"));
+        QCOMPARE (Lookup::normalize (""), QString (""));
+    }
+
+    void checkCacheHit() {
+        Lookup lookup;
+        QSignalSpy spy (&lookup,
+                        SIGNAL (lookupFinished (QString, QHostAddress)));
+
+        /* Simulate a mDNS response, valid for one second */
+        QHostInfo info;
+        info.setHostName ("roboRIO-3794-FRC.local");
+        info.setAddresses (QList<QHostAddress>()
+                           << QHostAddress ("10.37.94.2"));
+        QMetaObject::invokeMethod (&lookup, "onRecordFound",
+                                   Q_ARG (QHostInfo, info),
+                                   Q_ARG (quint32, 1));
+
+        /* The lookup is answered by the cache, with any spelling of the name */
+        spy.clear();
+        lookup.lookup ("ROBORIO-3794-FRC.local.");
+        QCOMPARE (spy.count(), 1);
+        QCOMPARE (spy.at (0).at (1).value<QHostAddress>(),
+                  QHostAddress ("10.37.94.2"));
+        QCOMPARE (lookup.hits(), 1);
+        QCOMPARE (lookup.misses(), 0);
+
+        /* The record expires after its TTL */
+        QTest::qWait (1100);
+        lookup.lookup ("roboRIO-3794-FRC.local");
+        QCOMPARE (lookup.misses(), 1);
+    }
+
+    void checkNegativeCache() {
+        Lookup lookup;
+        QSignalSpy spy (&lookup,
+                        SIGNAL (lookupFinished (QString, QHostAddress)));
+
+        /* The second lookup is not sent, since the first one is unanswered */
+        lookup.lookup ("missing-host.local");
+        lookup.lookup ("missing-host.local");
+        QCOMPARE (lookup.misses(), 1);
+        QCOMPARE (lookup.hits(), 1);
+        QCOMPARE (spy.count(), 0);
+    }
+
+    void checkCacheLimit() {
+        Lookup lookup;
+
+        /* Many hosts answer before any of their records expire */
+        for (int i = 0; i < 100; ++i) {
+            QHostInfo info;
+            info.setHostName (QString ("host-%1.local").arg (i));
+            info.setAddresses (QList<QHostAddress>()
+                               << QHostAddress ("10.0.0.2"));
+            QMetaObject::invokeMethod (&lookup, "onRecordFound",
+                                       Q_ARG (QHostInfo, info),
+                                       Q_ARG (quint32, 1000 - i));
+        }
+
+        /* The entries that expire the soonest make room for the new ones */
+        QCOMPARE (lookup.cacheSize(), 32);
+        lookup.lookup ("host-0.local");
+        lookup.lookup ("host-99.local");
+        QCOMPARE (lookup.hits(), 2);
+        lookup.lookup ("host-98.local");
+        QCOMPARE (lookup.misses(), 1);
+    }
+};
+
+//==============================================================================
+// MDNS RECORD CACHE TEST
+//==============================================================================
+
+class Test_RecordCache : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        qRegisterMetaType<QHostInfo>();
+    }
+
+    void checkCachedLookup() {
+        qMDNS* mdns = qMDNS::getInstance();
+        QSignalSpy spy (mdns, SIGNAL (recordFound (QHostInfo, quint32)));
+
+        /* Feed a response for cachetest.local (10.0.0.2, TTL = 120 s) */
+        readResponse (120);
+        QCOMPARE (spy.count(), 1);
+        QCOMPARE (spy.at (0).at (1).toUInt(), 120u);
+
+        /* The lookup is answered from the cache, before returning */
+        spy.clear();
+        mdns->lookup ("CacheTest");
+        QCOMPARE (spy.count(), 1);
+
+        QHostInfo info = spy.at (0).at (0).value<QHostInfo>();
+        QCOMPARE (info.addresses().count(), 1);
+        QCOMPARE (info.addresses().first(), QHostAddress ("10.0.0.2"));
+        QVERIFY (spy.at (0).at (1).toUInt() <= 120u);
+    }
+
+    void checkGoodbye() {
+        qMDNS* mdns = qMDNS::getInstance();
+        QSignalSpy spy (mdns, SIGNAL (recordFound (QHostInfo, quint32)));
+
+        /* A TTL of zero removes the record from the cache */
+        readResponse (0);
+        spy.clear();
+        mdns->lookup ("cachetest.local");
+        QCOMPARE (spy.count(), 0);
+    }
+
+  private:
+    void readResponse (quint32 ttl) {
+        QByteArray data;
+        data.append ("\x00\x00\x84\x00\x00\x00\x00\x01\x00\x00\x00\x00", 12);
+        data.append ("\x09" "cachetest" "\x05" "local", 16);
+        data.append ((char) 0);
+        data.append ("\x00\x01\x80\x01", 4);
+        data.append ((char) ((ttl >> 24) & 0xff));
+        data.append ((char) ((ttl >> 16) & 0xff));
+        data.append ((char) ((ttl >> 8) & 0xff));
+        data.append ((char) (ttl & 0xff));
+        data.append ("\x00\x04\x0a\x00\x00\x02", 6);
+
+        QMetaObject::invokeMethod (qMDNS::getInstance(), "readResponse",
+                                   Q_ARG (QByteArray, data));
+    }
+};
+
+#endif
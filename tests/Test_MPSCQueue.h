@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_MPSC_QUEUE
+#define TEST_MPSC_QUEUE
+
+#include <QtTest>
+#include <QThread>
+#include <Utilities/MPSCQueue.h>
+
+//==============================================================================
+// MPSC QUEUE TEST
+//==============================================================================
+
+/* Every message holds its producer and its position in the producer stream */
+struct TestMessage {
+    int producer;
+    int sequence;
+};
+
+class Test_MPSCQueueProducer : public QThread {
+  public:
+    Test_MPSCQueueProducer (MPSCQueue<TestMessage>* queue, int id, int count) {
+        m_id = id;
+        m_queue = queue;
+        m_count = count;
+    }
+
+  protected:
+    void run() {
+        for (int i = 0; i < m_count; ++i) {
+            TestMessage message;
+            message.producer = m_id;
+            message.sequence = i;
+            m_queue->push (message);
+        }
+    }
+
+  private:
+    int m_id;
+    int m_count;
+    MPSCQueue<TestMessage>* m_queue;
+};
+
+class Test_MPSCQueue : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void checkFIFO() {
+        MPSCQueue<int> queue;
+        int value = 0;
+
+        QVERIFY (!queue.pop (&value));
+
+        queue.push (1);
+        queue.push (2);
+        queue.push (3);
+
+        for (int i = 1; i <= 3; ++i) {
+            QVERIFY (queue.pop (&value));
+            QCOMPARE (value, i);
+        }
+
+        QVERIFY (!queue.pop (&value));
+    }
+
+    void checkProducers() {
+        const int producers = 4;
+        const int messages = 50000;
+
+        MPSCQueue<TestMessage> queue;
+        QList<Test_MPSCQueueProducer*> threads;
+        for (int i = 0; i < producers; ++i)
+            threads.append (new Test_MPSCQueueProducer (&queue, i, messages));
+
+        foreach (Test_MPSCQueueProducer* thread, threads)
+            thread->start();
+
+        /* Every message is received once and in the order of its producer */
+        int received = 0;
+        bool ordered = true;
+        QVector<int> last (producers, -1);
+        while (received < producers * messages) {
+            TestMessage message;
+            if (!queue.pop (&message))
+                continue;
+
+            ordered &= (message.sequence == last [message.producer] + 1);
+            last [message.producer] = message.sequence;
+            ++received;
+        }
+
+        foreach (Test_MPSCQueueProducer* thread, threads)
+            thread->wait();
+
+        qDeleteAll (threads);
+
+        TestMessage message;
+        QVERIFY (ordered);
+        QVERIFY (!queue.pop (&message));
+    }
+};
+
+#endif
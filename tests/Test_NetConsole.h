@@ -65,6 +65,7 @@ class Test_NetConsoleReceiver : public QObject {
         netconsole.setInputPort (port);
         connect (&netconsole, &NetConsole::newMessage, [ = ] (const QString & msg) {
             received = msg;
+            messages.append (msg);
         });
 
         sender.writeDatagram (message.toUtf8(), QHostAddress::Broadcast, port);
@@ -75,9 +76,23 @@ class Test_NetConsoleReceiver : public QObject {
         QCOMPARE (received, message);
     }
 
+    void verifySeparateMessages() {
+        QStringList burst;
+        burst << "First" << "Second" << "Third";
+
+        /* Each datagram must be its own message, even if read together */
+        messages.clear();
+        foreach (const QString& msg, burst)
+            sender.writeDatagram (msg.toUtf8(), QHostAddress::Broadcast, 6666);
+
+        QTest::qWait (100);
+        QCOMPARE (messages, burst);
+    }
+
   private:
     QString message;
     QString received;
+    QStringList messages;
     QUdpSocket sender;
     NetConsole netconsole;
 };
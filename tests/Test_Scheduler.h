@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_SCHEDULER
+#define TEST_SCHEDULER
+
+#include <QtTest>
+#include <Core/Scheduler.h>
+
+//==============================================================================
+// SCHEDULER TEST
+//==============================================================================
+
+/**
+ * Scheduler driven by a fake clock, so that the tests do not depend on the
+ * load of the computer that runs them
+ */
+class FakeClockScheduler : public Scheduler {
+  public:
+    FakeClockScheduler() {
+        time = 0;
+    }
+
+    /**
+     * Moves the clock to the given time (in milliseconds) and fires the
+     * streams that are due, as the timer of the scheduler would do
+     */
+    void advance (qreal msecs) {
+        time = qRound64 (msecs * 1000000);
+        onTimeout();
+    }
+
+    qint64 time;
+
+  protected:
+    virtual qint64 nsecsElapsed() const {
+        return time;
+    }
+};
+
+class Test_Scheduler : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        fired = 0;
+        scheduler.setFrequency (0, 50);
+        connect (&scheduler, &Scheduler::triggered, [ = ] (int stream) {
+            if (stream == 0)
+                ++fired;
+        });
+    }
+
+    void checkRate() {
+        fired = 0;
+        scheduler.time = 0;
+        scheduler.start();
+        for (int i = 0; i <= 500; ++i)
+            scheduler.advance (i);
+        scheduler.stop();
+
+        /* 25 slots in 500 ms, plus the one fired when starting */
+        QCOMPARE (fired, 26);
+    }
+
+    void checkDrift() {
+        fired = 0;
+        scheduler.time = 0;
+        scheduler.resetJitter();
+        scheduler.start();
+
+        /* Every slot is fired 3 ms late, the lateness must not add up */
+        for (int i = 0; i < 50; ++i)
+            scheduler.advance (i * 20 + 3);
+        scheduler.stop();
+
+        QCOMPARE (fired, 50);
+        QCOMPARE (scheduler.jitter (0).missed, qint64 (0));
+        QCOMPARE (scheduler.jitter (0).maximum, 3.0);
+    }
+
+    void checkSkipPolicy() {
+        fired = 0;
+        scheduler.time = 0;
+        scheduler.setPolicy (0, Scheduler::kSkip);
+        scheduler.resetJitter();
+        scheduler.start();
+        scheduler.advance (0);
+
+        /* Block the event loop for five whole periods */
+        fired = 0;
+        scheduler.advance (110);
+        scheduler.stop();
+
+        QCOMPARE (fired, 1);
+        QCOMPARE (scheduler.jitter (0).missed, qint64 (4));
+    }
+
+    void checkCatchUpPolicy() {
+        fired = 0;
+        scheduler.time = 0;
+        scheduler.setPolicy (0, Scheduler::kCatchUp);
+        scheduler.resetJitter();
+        scheduler.start();
+        scheduler.advance (0);
+
+        /* Block the event loop for five whole periods */
+        fired = 0;
+        scheduler.advance (110);
+        scheduler.stop();
+
+        QCOMPARE (fired, 5);
+        QCOMPARE (scheduler.jitter (0).maximum, 90.0);
+    }
+
+    void checkBatches() {
+        int started = 0;
+        int finished = 0;
+        int outside = 0;
+
+        FakeClockScheduler batched;
+        batched.setFrequency (0, 50);
+        batched.setFrequency (1, 50);
+
+        connect (&batched, &Scheduler::batchStarted, [&]() { ++started; });
+        connect (&batched, &Scheduler::batchFinished, [&]() { ++finished; });
+        connect (&batched, &Scheduler::triggered, [&] (int) {
+            if (started == finished)
+                ++outside;
+        });
+
+        batched.start();
+        for (int i = 0; i <= 100; ++i)
+            batched.advance (i);
+        batched.stop();
+
+        /* Both streams fall due together, so they share every batch */
+        QCOMPARE (started, 6);
+        QCOMPARE (outside, 0);
+        QCOMPARE (started, finished);
+    }
+
+    void checkRealClock() {
+        int count = 0;
+        Scheduler real;
+        real.setFrequency (0, 50);
+        connect (&real, &Scheduler::triggered, [&] (int) { ++count; });
+
+        QElapsedTimer clock;
+        clock.start();
+        real.start();
+        QTest::qWait (500);
+        real.stop();
+
+        /* A loaded computer may delay or drop slots, but never add them */
+        QVERIFY (count > 0);
+        QVERIFY (count <= clock.elapsed() / 20 + 1);
+    }
+
+  private:
+    int fired;
+    FakeClockScheduler scheduler;
+};
+
+#endif
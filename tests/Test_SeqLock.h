@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_SEQ_LOCK
+#define TEST_SEQ_LOCK
+
+#include <QtTest>
+#include <QThread>
+#include <Utilities/SeqLock.h>
+
+//==============================================================================
+// SEQLOCK TEST
+//==============================================================================
+
+/* Every value of a snapshot is equal to the snapshot number */
+struct TestSnapshot {
+    qint64 values [8];
+};
+
+class Test_SeqLockWriter : public QThread {
+  public:
+    Test_SeqLockWriter (SeqLock<TestSnapshot>* lock, int snapshots) {
+        m_lock = lock;
+        m_snapshots = snapshots;
+    }
+
+  protected:
+    void run() {
+        TestSnapshot snapshot;
+        for (int i = 1; i <= m_snapshots; ++i) {
+            for (int j = 0; j < 8; ++j)
+                snapshot.values [j] = i;
+
+            m_lock->store (snapshot);
+        }
+    }
+
+  private:
+    int m_snapshots;
+    SeqLock<TestSnapshot>* m_lock;
+};
+
+class Test_SeqLock : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void checkLoadStore() {
+        SeqLock<int> lock;
+        QCOMPARE (lock.load(), 0);
+        QCOMPARE (lock.version(), 1U);
+
+        lock.store (42);
+        QCOMPARE (lock.load(), 42);
+        QCOMPARE (lock.version(), 2U);
+    }
+
+    void checkConsistency() {
+        const int snapshots = 200000;
+
+        SeqLock<TestSnapshot> lock;
+        Test_SeqLockWriter writer (&lock, snapshots);
+
+        qint64 last = 0;
+        bool torn = false;
+        bool backwards = false;
+
+        writer.start();
+        while (last < snapshots && !torn) {
+            TestSnapshot snapshot = lock.load();
+            for (int j = 1; j < 8; ++j)
+                torn |= (snapshot.values [j] != snapshot.values [0]);
+
+            backwards |= (snapshot.values [0] < last);
+            last = snapshot.values [0];
+        }
+
+        writer.wait();
+
+        QVERIFY (!torn);
+        QVERIFY (!backwards);
+    }
+};
+
+#endif
@@ -161,4 +161,205 @@ class Test_SocketsSenderTCP : public QObject {
     QByteArray testData;
 };
 
+//==============================================================================
+// BATCHED SENDER TESTS
+//==============================================================================
+
+class Test_SocketsBatch : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        int fmsPort = 1190;
+        int radPort = 1200;
+        int robPort = 1210;
+
+        /* The FMS & radio senders are connected, the robot one is not */
+        sockets.setConnectedSendersEnabled (true);
+        sockets.setFMSInputPort (0);
+        sockets.setRadioInputPort (0);
+        sockets.setRobotInputPort (0);
+        sockets.setFMSOutputPort (fmsPort);
+        sockets.setRadioOutputPort (radPort);
+        sockets.setRobotOutputPort (robPort);
+        sockets.setFMSAddress (QHostAddress (QHostAddress::LocalHost));
+        sockets.setRadioAddress (QHostAddress (QHostAddress::LocalHost));
+        sockets.setRobotAddress (QString (""));
+
+        fmsReceiver.bind (DS_LISTENER, fmsPort, DS_BIND_MODE);
+        radReceiver.bind (DS_LISTENER, radPort, DS_BIND_MODE);
+        robReceiver.bind (DS_LISTENER, robPort, DS_BIND_MODE);
+
+        connect (&fmsReceiver, &QUdpSocket::readyRead, [ = ]() {
+            while (fmsReceiver.hasPendingDatagrams())
+                fmsData.append (readDatagram (&fmsReceiver));
+        });
+
+        connect (&radReceiver, &QUdpSocket::readyRead, [ = ]() {
+            while (radReceiver.hasPendingDatagrams())
+                radData.append (readDatagram (&radReceiver));
+        });
+
+        connect (&robReceiver, &QUdpSocket::readyRead, [ = ]() {
+            while (robReceiver.hasPendingDatagrams())
+                robData.append (readDatagram (&robReceiver));
+        });
+
+        sockets.beginBatch();
+        sockets.sendToFMS ("FMS 1");
+        sockets.sendToRobot ("Robot");
+        sockets.sendToRadio ("Radio");
+        sockets.sendToFMS ("FMS 2");
+        sockets.endBatch();
+
+        QTest::qWait (100);
+    }
+
+    void checkFMS() {
+        QCOMPARE (fmsData, QList<QByteArray>() << "FMS 1" << "FMS 2");
+    }
+
+    void checkRadio() {
+        QCOMPARE (radData, QList<QByteArray>() << "Radio");
+    }
+
+    void checkRobot() {
+        QCOMPARE (robData, QList<QByteArray>() << "Robot");
+    }
+
+    void checkStatistics() {
+        QVERIFY (sockets.sendStatistics().datagrams >= 4);
+    }
+
+  private:
+    QByteArray readDatagram (QUdpSocket* socket) {
+        QByteArray data;
+        data.resize (socket->pendingDatagramSize());
+        socket->readDatagram (data.data(), data.size());
+        return data;
+    }
+
+    Sockets sockets;
+    QUdpSocket fmsReceiver;
+    QUdpSocket radReceiver;
+    QUdpSocket robReceiver;
+
+    QList<QByteArray> fmsData;
+    QList<QByteArray> radData;
+    QList<QByteArray> robData;
+};
+
+//==============================================================================
+// RECEIVER BURST TESTS
+//==============================================================================
+
+class Test_SocketsReceiver : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        int port = 1220;
+
+        sockets.setRobotSocketType (DS::kSocketTypeUDP);
+        sockets.setRobotInputPort (port);
+        sockets.setRobotAddress (QHostAddress (QHostAddress::LocalHost));
+
+        connect (&sockets, &Sockets::robotPacketReceived,
+        [ = ] (const QByteArray & data) {
+            received.append (data);
+        });
+
+        for (int i = 0; i < 5; ++i)
+            sent.append (QByteArray ("Packet ") + QByteArray::number (i));
+
+        /* Send the datagrams back-to-back, before the receiver is notified */
+        foreach (const QByteArray& data, sent)
+            sender.writeDatagram (data, QHostAddress::LocalHost, port);
+
+        QTest::qWait (100);
+    }
+
+    void checkBurst() {
+        QCOMPARE (received, sent);
+    }
+
+  private:
+    Sockets sockets;
+    QUdpSocket sender;
+    QList<QByteArray> sent;
+    QList<QByteArray> received;
+};
+
+//==============================================================================
+// ROBOT DISCOVERY TESTS
+//==============================================================================
+
+class Test_SocketsDiscovery : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        inputPort = 1170;
+        outputPort = 1180;
+        testData = QByteArray ("Discovery");
+
+        sockets.setRobotSocketType (DS::kSocketTypeUDP);
+        sockets.setRobotInputPort (inputPort);
+        sockets.setRobotOutputPort (outputPort);
+        sockets.setRobotAddress (QString (""));
+
+        robot.bind (DS_LISTENER, outputPort, DS_BIND_MODE);
+        connect (&robot, &QUdpSocket::readyRead, [ = ]() {
+            robotData = DS::readSocket (&robot);
+        });
+
+        /* Act like a protocol that only accepts the test data */
+        connect (&sockets, &Sockets::robotPacketReceived,
+        [ = ] (const QByteArray & data) {
+            if (data == testData)
+                sockets.lockRobotAddress();
+        });
+    }
+
+    void checkRace() {
+        /* The local computer is one of the raced addresses */
+        sockets.sendToRobot (testData);
+        QTest::qWait (100);
+
+        QCOMPARE (robotData, testData);
+        QCOMPARE (sockets.robotDiscoveryTime(), qint64 (-1));
+    }
+
+    void checkInvalidPacket() {
+        /* Packets rejected by the protocol do not decide the address */
+        robot.writeDatagram ("Invalid", QHostAddress::LocalHost, inputPort);
+        QTest::qWait (100);
+
+        QCOMPARE (sockets.robotDiscoveryTime(), qint64 (-1));
+    }
+
+    void checkLock() {
+        /* The first valid answer decides the robot address */
+        robot.writeDatagram (testData, QHostAddress::LocalHost, inputPort);
+        QTest::qWait (100);
+
+        QVERIFY (sockets.robotDiscoveryTime() >= 0);
+        QCOMPARE (sockets.robotAddress(),
+                  QHostAddress (QHostAddress::LocalHost));
+    }
+
+    void checkRestart() {
+        sockets.restartRobotDiscovery();
+        QCOMPARE (sockets.robotDiscoveryTime(), qint64 (-1));
+    }
+
+  private:
+    int inputPort;
+    int outputPort;
+    Sockets sockets;
+    QUdpSocket robot;
+    QByteArray robotData;
+    QByteArray testData;
+};
+
 #endif
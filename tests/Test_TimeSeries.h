@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_TIME_SERIES
+#define TEST_TIME_SERIES
+
+#include <QtTest>
+#include <Utilities/TimeSeries.h>
+
+//==============================================================================
+// TIME SERIES TEST
+//==============================================================================
+
+class Test_TimeSeries : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void checkRawWindow() {
+        TimeSeries series (4, 4, 4);
+        for (int i = 0; i < 10; ++i)
+            series.append (i * 10, i);
+
+        /* Only the newest samples are kept */
+        QVector<TimeSeries::Bucket> raw = series.buckets (TimeSeries::kRaw);
+        QCOMPARE (raw.count(), 4);
+        QCOMPARE (raw.first().time, 60LL);
+        QCOMPARE (raw.last().max, 9.0);
+    }
+
+    void checkSeconds() {
+        TimeSeries series;
+        series.append (100, 12);
+        series.append (500, 6);
+        series.append (900, 12);
+        series.append (1200, 10);
+
+        QVector<TimeSeries::Bucket> seconds;
+        seconds = series.buckets (TimeSeries::kSeconds);
+
+        QCOMPARE (seconds.count(), 2);
+        QCOMPARE (seconds.at (0).time, 0LL);
+        QCOMPARE (seconds.at (0).min, 6.0);
+        QCOMPARE (seconds.at (0).max, 12.0);
+        QCOMPARE (seconds.at (0).average(), 10.0);
+        QCOMPARE (seconds.at (1).time, 1000LL);
+        QCOMPARE (seconds.at (1).count, 1);
+    }
+
+    void checkConstantMemory() {
+        TimeSeries series (8, 8, 8);
+
+        /* Three hours of samples at 50 Hz */
+        for (qint64 time = 0; time < 3 * 3600 * 1000; time += 20)
+            series.append (time, time % 1000);
+
+        QCOMPARE (series.count (TimeSeries::kRaw), 8);
+        QCOMPARE (series.count (TimeSeries::kSeconds), 8);
+        QCOMPARE (series.count (TimeSeries::kMinutes), 8);
+
+        /* The newest minute holds every sample of that minute */
+        TimeSeries::Bucket last = series.buckets (TimeSeries::kMinutes).last();
+        QCOMPARE (last.time, (qint64) (3 * 3600 - 60) * 1000);
+        QCOMPARE (last.count, 3000);
+        QCOMPARE (last.min, 0.0);
+        QCOMPARE (last.max, 980.0);
+    }
+};
+
+#endif
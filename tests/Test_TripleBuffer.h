@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_TRIPLE_BUFFER
+#define TEST_TRIPLE_BUFFER
+
+#include <QtTest>
+#include <QThread>
+#include <Utilities/TripleBuffer.h>
+
+//==============================================================================
+// TRIPLE BUFFER TEST
+//==============================================================================
+
+/* Every value of a frame is equal to the frame number */
+struct TestFrame {
+    int values [64];
+};
+
+class Test_TripleBufferProducer : public QThread {
+  public:
+    Test_TripleBufferProducer (TripleBuffer<TestFrame>* buffer, int frames) {
+        m_buffer = buffer;
+        m_frames = frames;
+    }
+
+  protected:
+    void run() {
+        for (int i = 1; i <= m_frames; ++i) {
+            TestFrame& frame = m_buffer->back();
+            for (int j = 0; j < 64; ++j)
+                frame.values [j] = i;
+
+            m_buffer->publish();
+        }
+    }
+
+  private:
+    int m_frames;
+    TripleBuffer<TestFrame>* m_buffer;
+};
+
+class Test_TripleBuffer : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void checkEmpty() {
+        TripleBuffer<int> buffer;
+        QVERIFY (!buffer.update());
+    }
+
+    void checkLatestFrame() {
+        TripleBuffer<int> buffer;
+
+        buffer.back() = 1;
+        buffer.publish();
+        buffer.back() = 2;
+        buffer.publish();
+
+        /* Only the newest frame is obtained */
+        QVERIFY (buffer.update());
+        QCOMPARE (buffer.front(), 2);
+        QVERIFY (!buffer.update());
+        QCOMPARE (buffer.front(), 2);
+    }
+
+    void checkConsistency() {
+        const int frames = 200000;
+
+        TripleBuffer<TestFrame> buffer;
+        Test_TripleBufferProducer producer (&buffer, frames);
+
+        int last = 0;
+        bool torn = false;
+        bool backwards = false;
+
+        producer.start();
+        while (last < frames && !torn) {
+            if (!buffer.update())
+                continue;
+
+            const TestFrame& frame = buffer.front();
+            for (int j = 1; j < 64; ++j)
+                torn |= (frame.values [j] != frame.values [0]);
+
+            backwards |= (frame.values [0] < last);
+            last = frame.values [0];
+        }
+
+        producer.wait();
+
+        QVERIFY (!torn);
+        QVERIFY (!backwards);
+    }
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * This file is part of the LibDS, which is released under the MIT license.
+ * For more information, please read the LICENSE file in the root directory
+ * of this project.
+ */
+
+#ifndef TEST_VOLTAGE_CODEC
+#define TEST_VOLTAGE_CODEC
+
+#include <QtTest>
+#include <Utilities/VoltageCodec.h>
+
+//==============================================================================
+// VOLTAGE CODEC TEST
+//==============================================================================
+
+class Test_VoltageCodec : public QObject {
+    Q_OBJECT
+
+  private slots:
+    void initTestCase() {
+        /* Robot packet used by the benchmarks, reports 12.43 V */
+        packet.fill (0x00, 1024);
+        packet [1] = 0x12;
+        packet [2] = 0x43;
+    }
+
+    void checkBCD() {
+        QCOMPARE (VoltageCodec::decodeBCD (0x12, 0x43), (quint16) 1243);
+
+        /* Compare every byte pair with a digit by digit decoder */
+        for (int word = 0; word <= 0xffff; ++word) {
+            quint8 integer = word >> 8;
+            quint8 decimal = word & 0xff;
+
+            if (VoltageCodec::decodeBCD (integer, decimal)
+                    != referenceBCD (integer, decimal))
+                QFAIL (qPrintable (QString::number (word, 16)));
+        }
+    }
+
+    void checkFixedPoint() {
+        QCOMPARE (VoltageCodec::decodeFixedPoint (12, 0x80), (quint16) 1250);
+
+        /* Compare every byte pair with the rounded floating point value */
+        for (int word = 0; word <= 0xffff; ++word) {
+            quint16 expected = qRound (word * 100 / 256.0);
+
+            if (VoltageCodec::decodeFixedPoint (word >> 8, word & 0xff)
+                    != expected)
+                QFAIL (qPrintable (QString::number (word, 16)));
+        }
+    }
+
+    void checkVolts() {
+        for (int cv = 0; cv <= VoltageCodec::MAX_CENTIVOLTS; ++cv) {
+            quint16 centivolts = cv;
+            qreal volts = VoltageCodec::toVolts (centivolts);
+
+            if (VoltageCodec::fromVolts (volts) != centivolts)
+                QFAIL (qPrintable (QString::number (cv)));
+        }
+
+        QCOMPARE (VoltageCodec::fromVolts (-1), (quint16) 0);
+        QCOMPARE (VoltageCodec::fromVolts (12.434), (quint16) 1243);
+        QCOMPARE (VoltageCodec::fromVolts (1000), (quint16) 25599);
+    }
+
+    void benchmarkBCD() {
+        QBENCHMARK {
+            quint32 sum = 0;
+            for (int word = 0; word <= 0xffff; ++word)
+                sum += VoltageCodec::decodeBCD (word >> 8, word & 0xff);
+
+            result = sum;
+        }
+    }
+
+    void benchmarkFixedPoint() {
+        QBENCHMARK {
+            quint32 sum = 0;
+            for (int word = 0; word <= 0xffff; ++word)
+                sum += VoltageCodec::decodeFixedPoint (word >> 8, word & 0xff);
+
+            result = sum;
+        }
+    }
+
+    void benchmarkPacketBCD() {
+        QBENCHMARK {
+            result = VoltageCodec::decodeBCD (packet.at (1), packet.at (2));
+        }
+    }
+
+    void benchmarkLegacyPacketBCD() {
+        QBENCHMARK {
+            result = legacyBCD (packet) * 100;
+        }
+    }
+
+  private:
+    /**
+     * Decodes each BCD digit separately
+     */
+    static quint16 referenceBCD (quint8 integer, quint8 decimal) {
+        int digits [4] = {
+            integer >> 4, integer & 0x0f, decimal >> 4, decimal & 0x0f
+        };
+
+        for (int i = 0; i < 4; ++i)
+            if (digits [i] > 9)
+                return 0;
+
+        return digits [0] * 1000 + digits [1] * 100
+               + digits [2] * 10 + digits [3];
+    }
+
+    /**
+     * Algorithm used by the previous implementation of the FRC 2014 protocol
+     */
+    static qreal legacyBCD (const QByteArray& data) {
+        QString voltage;
+        QByteArray hex = data.toHex();
+        voltage.append (hex.at (2));
+        voltage.append (hex.at (3));
+        voltage.append (".");
+        voltage.append (hex.at (4));
+        voltage.append (hex.at (5));
+
+        return voltage.toDouble();
+    }
+
+    QByteArray packet;
+    volatile quint32 result;
+};
+
+#endif
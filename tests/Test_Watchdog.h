@@ -11,9 +11,130 @@
 
 #include <QtTest>
 #include <Core/Watchdog.h>
+#include <Core/WatchdogManager.h>
+
+//==============================================================================
+// FAKE CLOCK
+//==============================================================================
+
+/*
+ * Watchdog manager driven by a fake clock, so that the tests do not depend
+ * on the timing of the event loop. Each call to advance() moves the clock to
+ * the given time (in milliseconds) and checks the due deadlines.
+ */
+class FakeClockManager : public WatchdogManager {
+  public:
+    FakeClockManager() {
+        time = 0;
+    }
+
+    void advance (qint64 msecs) {
+        time = msecs;
+        onTimeout();
+    }
+
+    virtual qint64 elapsed() const {
+        return time;
+    }
+
+    qint64 time;
+};
+
+//==============================================================================
+// WATCHDOG TEST
+//==============================================================================
 
 class Test_Watchdog : public QObject {
     Q_OBJECT
+
+  private slots:
+    void checkExpiration() {
+        FakeClockManager manager;
+        Watchdog* watchdog = new Watchdog (&manager);
+        QSignalSpy spy (watchdog, SIGNAL (expired()));
+        watchdog->setExpirationTime (50);
+
+        manager.advance (49);
+        QCOMPARE (spy.count(), 0);
+        manager.advance (50);
+        QCOMPARE (spy.count(), 1);
+
+        /* The watchdog keeps expiring while it is not fed */
+        manager.advance (99);
+        QCOMPARE (spy.count(), 1);
+        manager.advance (100);
+        QCOMPARE (spy.count(), 2);
+    }
+
+    void checkFeeding() {
+        FakeClockManager manager;
+        Watchdog* watchdog = new Watchdog (&manager);
+        QSignalSpy spy (watchdog, SIGNAL (expired()));
+        watchdog->setExpirationTime (50);
+
+        for (int i = 1; i <= 10; ++i) {
+            manager.advance (i * 20);
+            watchdog->reset();
+        }
+
+        QCOMPARE (spy.count(), 0);
+
+        /* The watchdog expires once it is no longer fed */
+        manager.advance (249);
+        QCOMPARE (spy.count(), 0);
+        manager.advance (250);
+        QCOMPARE (spy.count(), 1);
+    }
+
+    void checkShorterExpiration() {
+        FakeClockManager manager;
+        Watchdog* watchdog = new Watchdog (&manager);
+        QSignalSpy spy (watchdog, SIGNAL (expired()));
+
+        /* The new deadline is earlier than the one in the heap */
+        watchdog->setExpirationTime (1000);
+        watchdog->setExpirationTime (20);
+        QCOMPARE (manager.count(), 1);
+
+        manager.advance (20);
+        QCOMPARE (spy.count(), 1);
+    }
+
+    void checkManyWatchdogs() {
+        FakeClockManager manager;
+        QList<Watchdog*> watchdogs;
+        for (int i = 0; i < 100; ++i) {
+            watchdogs.append (new Watchdog (&manager));
+            watchdogs.last()->setExpirationTime (50);
+        }
+
+        /* Only the odd watchdogs are fed */
+        QSignalSpy even (watchdogs.at (0), SIGNAL (expired()));
+        QSignalSpy odd (watchdogs.at (1), SIGNAL (expired()));
+        for (int i = 1; i <= 4; ++i) {
+            manager.advance (i * 20);
+            for (int j = 1; j < watchdogs.count(); j += 2)
+                watchdogs.at (j)->reset();
+        }
+
+        QCOMPARE (even.count(), 1);
+        QCOMPARE (odd.count(), 0);
+        QCOMPARE (manager.count(), 100);
+
+        delete watchdogs.takeFirst();
+        QCOMPARE (manager.count(), 99);
+    }
+
+    void checkRealClock() {
+        WatchdogManager manager;
+        Watchdog* watchdog = new Watchdog (&manager);
+        QSignalSpy spy (watchdog, SIGNAL (expired()));
+
+        /* A loaded computer may delay the timer, so only wait for it */
+        watchdog->setExpirationTime (20);
+        QVERIFY (spy.wait (1000));
+        QVERIFY (spy.count() >= 1);
+    }
 };
 
 #endif
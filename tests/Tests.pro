@@ -31,9 +31,20 @@ SOURCES += \
     $$PWD/main.cpp
 
 HEADERS += \
+    $$PWD/Test_BinaryLog.h \
     $$PWD/Test_CRC32.h \
+    $$PWD/Test_DNS.h \
     $$PWD/Test_DriverStation.h \
     $$PWD/Test_DS_Config.h \
+    $$PWD/Test_FRC_2015.h \
+    $$PWD/Test_LinkStatistics.h \
+    $$PWD/Test_Lookup.h \
+    $$PWD/Test_MPSCQueue.h \
     $$PWD/Test_NetConsole.h \
+    $$PWD/Test_Scheduler.h \
+    $$PWD/Test_SeqLock.h \
     $$PWD/Test_Sockets.h \
+    $$PWD/Test_TimeSeries.h \
+    $$PWD/Test_TripleBuffer.h \
+    $$PWD/Test_VoltageCodec.h \
     $$PWD/Test_Watchdog.h
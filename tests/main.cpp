@@ -7,23 +7,49 @@
  */
 
 #include "Test_CRC32.h"
+#include "Test_DNS.h"
+#include "Test_BinaryLog.h"
+#include "Test_FRC_2015.h"
+#include "Test_Lookup.h"
 #include "Test_Sockets.h"
+#include "Test_SeqLock.h"
+#include "Test_Scheduler.h"
 #include "Test_Watchdog.h"
+#include "Test_MPSCQueue.h"
 #include "Test_DS_Config.h"
+#include "Test_TimeSeries.h"
+#include "Test_LinkStatistics.h"
 #include "Test_NetConsole.h"
+#include "Test_TripleBuffer.h"
+#include "Test_VoltageCodec.h"
 #include "Test_DriverStation.h"
 
 int main (int argc, char* argv[]) {
     QApplication app (argc, argv);
 
     QTest::qExec (new Test_CRC32, argc, argv);
+    QTest::qExec (new Test_BinaryLog, argc, argv);
     QTest::qExec (new Test_Watchdog, argc, argv);
+    QTest::qExec (new Test_Scheduler, argc, argv);
+    QTest::qExec (new Test_TripleBuffer, argc, argv);
+    QTest::qExec (new Test_SeqLock, argc, argv);
+    QTest::qExec (new Test_MPSCQueue, argc, argv);
+    QTest::qExec (new Test_TimeSeries, argc, argv);
+    QTest::qExec (new Test_LinkStatistics, argc, argv);
+    QTest::qExec (new Test_VoltageCodec, argc, argv);
+    QTest::qExec (new Test_Lookup, argc, argv);
+    QTest::qExec (new Test_RecordCache, argc, argv);
+    QTest::qExec (new Test_DNS, argc, argv);
     QTest::qExec (new Test_DS_Config, argc, argv);
     QTest::qExec (new Test_DriverStation, argc, argv);
     QTest::qExec (new Test_SocketsSenderUDP, argc, argv);
     QTest::qExec (new Test_SocketsSenderTCP, argc, argv);
+    QTest::qExec (new Test_SocketsBatch, argc, argv);
+    QTest::qExec (new Test_SocketsReceiver, argc, argv);
+    QTest::qExec (new Test_SocketsDiscovery, argc, argv);
     QTest::qExec (new Test_NetConsoleSender, argc, argv);
     QTest::qExec (new Test_NetConsoleReceiver, argc, argv);
+    QTest::qExec (new Test_FRC_2015, argc, argv);
 
     QTimer::singleShot (2000, Qt::PreciseTimer, qApp, SLOT (quit()));
 